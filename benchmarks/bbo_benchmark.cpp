@@ -0,0 +1,101 @@
+#include "strategy/trade_engine.h"
+
+static constexpr size_t loop_count = 10000;
+
+// 用于防止编译器优化掉被测量的读取
+volatile Qty qty_sink = 0;
+
+// 原 MarketOrderBook::updateBBO() 中的实现：遍历价格层级的全部订单累加数量
+Qty walkLevelQty(const Trading::MarketOrdersAtPrice *orders_at_price) {
+  auto qty = orders_at_price->first_mkt_order_->qty_;
+  for (auto order = orders_at_price->first_mkt_order_->next_order_; order != orders_at_price->first_mkt_order_; order = order->next_order_)
+    qty += order->qty_;
+  return qty;
+}
+
+// 比较遍历订单链表与读取增量维护的总数量两种方式获取单个价格层级数量的开销
+void benchmarkLevelQty(size_t depth) {
+  std::vector<Trading::MarketOrder> orders(depth);
+  Trading::MarketOrdersAtPrice orders_at_price(Side::BUY, 100, &orders[0], nullptr, nullptr);
+  for (size_t i = 0; i < depth; ++i) {
+    orders[i] = Trading::MarketOrder(i, Side::BUY, 100, 1 + rand() % 100, i, &orders[(i + depth - 1) % depth], &orders[(i + 1) % depth]);
+    orders_at_price.total_qty_ += orders[i].qty_;
+    ++orders_at_price.num_orders_;
+  }
+
+  size_t walk_rdtsc = 0, aggregate_rdtsc = 0;
+  for (size_t i = 0; i < loop_count; ++i) {
+    auto start = Common::rdtsc();
+    qty_sink = walkLevelQty(&orders_at_price);
+    walk_rdtsc += (Common::rdtsc() - start);
+
+    start = Common::rdtsc();
+    qty_sink = orders_at_price.total_qty_;
+    aggregate_rdtsc += (Common::rdtsc() - start);
+  }
+
+  ASSERT(walkLevelQty(&orders_at_price) == orders_at_price.total_qty_, "价格层级总数量不一致");
+
+  std::cout << "DEPTH " << depth << " WALK LEVEL QTY " << (walk_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::cout << "DEPTH " << depth << " AGGREGATE LEVEL QTY " << (aggregate_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+}
+
+// 在最优买价层级排队 depth 个订单，测量修改其中一个订单的数量到BBO刷新完成的开销
+void benchmarkTickToBBO(Trading::MarketOrderBook *book, size_t depth) {
+  const TickerId ticker_id = 0;
+  const Exchange::MEMarketUpdate clear{Exchange::MarketUpdateType::CLEAR, OrderId_INVALID, ticker_id};
+  book->onMarketUpdate(&clear);
+
+  Qty total_qty = 0, first_qty = 0;
+  for (OrderId order_id = 0; order_id < depth; ++order_id) {
+    const Exchange::MEMarketUpdate add{Exchange::MarketUpdateType::ADD, order_id, ticker_id, Side::BUY, 100,
+                                       static_cast<Qty>(1 + rand() % 100), static_cast<Priority>(order_id + 1)};
+    book->onMarketUpdate(&add);
+    total_qty += add.qty_;
+    if (!order_id)
+      first_qty = add.qty_;
+  }
+  const Exchange::MEMarketUpdate ask{Exchange::MarketUpdateType::ADD, depth, ticker_id, Side::SELL, 101, 10, 1};
+  book->onMarketUpdate(&ask);
+
+  // 反复修改最优买价层级队首订单的数量
+  Qty last_qty = first_qty;
+  size_t total_rdtsc = 0;
+  for (size_t i = 0; i < loop_count; ++i) {
+    const Exchange::MEMarketUpdate modify{Exchange::MarketUpdateType::MODIFY, 0, ticker_id, Side::BUY, 100,
+                                          static_cast<Qty>(1 + i % 100), 1};
+    const auto start = Common::rdtsc();
+    book->onMarketUpdate(&modify);
+    total_rdtsc += (Common::rdtsc() - start);
+    last_qty = modify.qty_;
+  }
+
+  const auto bbo = book->getBBO();
+  book->toString(false, true);  // 校验增量维护的价格层级总数量和订单数
+  ASSERT(bbo->bid_price_ == 100 && bbo->bid_qty_ == total_qty - first_qty + last_qty && bbo->ask_qty_ == 10, "BBO不正确：" + bbo->toString());
+
+  std::cout << "DEPTH " << depth << " TICK-TO-BBO " << (total_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+}
+
+int main(int, char **) {
+  srand(0);
+
+  Common::BinLogger logger("bbo_benchmark.log");
+
+  // 订单簿的更新回调需要交易引擎，使用不带交易算法的交易引擎
+  Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
+  Exchange::ClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
+  Exchange::MEMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
+  Common::TradeEngineCfgHashMap ticker_cfg;
+  auto trade_engine = new Trading::TradeEngine(0, AlgoType::RANDOM, ticker_cfg, &client_requests, &client_responses, &market_updates);
+
+  auto book = new Trading::MarketOrderBook(0, &logger);
+  book->setTradeEngine(trade_engine);
+
+  for (size_t depth: {1, 10, 100, 1000, 10000}) {
+    benchmarkLevelQty(depth);
+    benchmarkTickToBBO(book, depth);
+  }
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,74 @@
+#include "common/logging.h"
+#include "common/time_utils.h"
+
+static constexpr size_t loop_count = 1000000;
+
+// 用于防止编译器优化掉被测量的调用
+volatile Common::Nanos nanos_sink = 0;
+
+// 每次取时间戳的平均时钟周期数
+template<typename F>
+size_t benchmarkClock(F &&now) {
+  const auto start = Common::rdtsc();
+  for (size_t i = 0; i < loop_count; ++i)
+    nanos_sink = now();
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  return (total_rdtsc / loop_count);
+}
+
+// 热路径上带时间戳的典型日志行每次调用的平均时钟周期数
+template<typename F>
+size_t benchmarkLogging(Common::Logger *logger, F &&timestamp) {
+  constexpr size_t log_count = 100000;
+  size_t total_rdtsc = 0;
+  for (size_t i = 0; i < log_count; ++i) {
+    const auto start = Common::rdtsc();
+    logger->log("%:% %() % 订单 ticker:% 价格:%\n", __FILE__, __LINE__, __FUNCTION__, timestamp(), static_cast<int>(i % 8), static_cast<long>(i));
+    total_rdtsc += (Common::rdtsc() - start);
+  }
+
+  return (total_rdtsc / log_count);
+}
+
+/// 程序入口：比较格式化时间字符串、系统时钟和校准后的TSC时钟取时间戳的开销，并测量TSC时钟相对CLOCK_REALTIME的偏差
+int main(int, char **) {
+  using namespace std::literals::chrono_literals;
+
+  std::string time_str;
+  std::cout << "getCurrentTimeStr() " << benchmarkClock([&time_str]() { return static_cast<Common::Nanos>(Common::getCurrentTimeStr(&time_str).size()); })
+            << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::cout << "getCurrentNanos() " << benchmarkClock([]() { return Common::getCurrentNanos(); }) << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::cout << "getCurrentTscNanos() " << benchmarkClock([]() { return Common::getCurrentTscNanos(); }) << " CLOCK CYCLES PER OPERATION." << std::endl;
+
+  // 跨越多个重新校准周期，每10ms比较一次TSC时钟与前后两次读取CLOCK_REALTIME的中点
+  Common::Nanos max_error = 0;
+  for (size_t i = 0; i < 500; ++i) {
+    std::this_thread::sleep_for(10ms);
+    const auto realtime_before = Common::getCurrentNanos();
+    const auto tsc_nanos = Common::getCurrentTscNanos();
+    const auto realtime_after = Common::getCurrentNanos();
+    const auto error = std::abs(tsc_nanos - (realtime_before + realtime_after) / 2);
+    ASSERT(error < Common::NANOS_TO_MILLIS, "TSC时钟与CLOCK_REALTIME相差过大：" + std::to_string(error) + "ns");
+    max_error = std::max(max_error, error);
+  }
+  std::cout << "TSC CLOCK " << Common::tscClock().nanosPerTick() << " NANOS PER TICK, MAX DEVIATION FROM CLOCK_REALTIME OVER 5S "
+            << max_error << "ns." << std::endl;
+
+  // 两种时间戳各使用一个新的日志器，使队列的首次访问开销相同
+  size_t str_cycles = 0, raw_cycles = 0;
+  {
+    Common::Logger logger("clock_benchmark_time_str.log");
+    str_cycles = benchmarkLogging(&logger, [&time_str]() -> const std::string & { return Common::getCurrentTimeStr(&time_str); });
+    std::this_thread::sleep_for(1s);
+  }
+  {
+    Common::Logger logger("clock_benchmark_log_time.log");
+    raw_cycles = benchmarkLogging(&logger, []() { return Common::getCurrentLogTime(); });
+    std::this_thread::sleep_for(1s);
+  }
+  std::cout << "LOG WITH getCurrentTimeStr() " << str_cycles << " CLOCK CYCLES PER OPERATION. LOG WITH getCurrentLogTime() "
+            << raw_cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
+
+  exit(EXIT_SUCCESS);
+}
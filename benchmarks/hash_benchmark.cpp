@@ -3,8 +3,17 @@
 
 static constexpr size_t loop_count = 100000;
 
+// 发布订单簿操作产生的客户端响应和市场更新并直接丢弃，避免队列被写满（不计入测量）
+void drainQueues(Exchange::MatchingEngine *matching_engine, Exchange::ClientResponseLFQueue *client_responses,
+                 Exchange::MEMarketUpdateBroadcastQueue::Reader *market_updates) {
+  matching_engine->publishPending();
+  client_responses->commitRead(client_responses->getReadable().size());
+  market_updates->commitRead(market_updates->getReadable().size());
+}
+
 template<typename T>
-size_t benchmarkHashMap(T *order_book, const std::vector<Exchange::MEClientRequest>& client_requests) {
+size_t benchmarkHashMap(T *order_book, const std::vector<Exchange::MEClientRequest>& client_requests, Exchange::MatchingEngine *matching_engine,
+                        Exchange::ClientResponseLFQueue *client_responses, Exchange::MEMarketUpdateBroadcastQueue::Reader *market_updates) {
   size_t total_rdtsc = 0;
 
   for (size_t i = 0; i < loop_count; ++i) {
@@ -28,6 +37,7 @@ size_t benchmarkHashMap(T *order_book, const std::vector<Exchange::MEClientReque
       default:
         break;
     }
+    drainQueues(matching_engine, client_responses, market_updates);
   }
 
   return (total_rdtsc / (loop_count * 2));
@@ -36,10 +46,11 @@ size_t benchmarkHashMap(T *order_book, const std::vector<Exchange::MEClientReque
 int main(int, char **) {
   srand(0);
 
-  Common::Logger logger("hash_benchmark.log");
+  Common::BinLogger logger("hash_benchmark.log");
   Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
   Exchange::ClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
-  Exchange::MEMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
+  Exchange::MEMarketUpdateBroadcastQueue market_updates(ME_MAX_MARKET_UPDATES);
+  auto market_updates_reader = market_updates.addReader();
   auto matching_engine = new Exchange::MatchingEngine(&client_requests, &client_responses, &market_updates);
 
   Common::OrderId order_id = 1000;
@@ -62,13 +73,13 @@ int main(int, char **) {
 
   {
     auto me_order_book = new Exchange::MEOrderBook(0, &logger, matching_engine);
-    const auto cycles = benchmarkHashMap(me_order_book, client_requests_vec);
+    const auto cycles = benchmarkHashMap(me_order_book, client_requests_vec, matching_engine, &client_responses, market_updates_reader);
     std::cout << "ARRAY HASHMAP " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
   }
 
   {
     auto me_order_book = new Exchange::UnorderedMapMEOrderBook(0, &logger, matching_engine);
-    const auto cycles = benchmarkHashMap(me_order_book, client_requests_vec);
+    const auto cycles = benchmarkHashMap(me_order_book, client_requests_vec, matching_engine, &client_responses, market_updates_reader);
     std::cout << "UNORDERED-MAP HASHMAP " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
   }
 
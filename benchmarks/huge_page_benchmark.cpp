@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+#include "common/huge_page_allocator.h"
+#include "common/perf_utils.h"
+
+static constexpr size_t num_elems = 32 * 1024 * 1024;  // 256 MiB，远大于 TLB 以 4 KiB 页能覆盖的范围
+static constexpr size_t chase_count = 10000000;
+
+// 用于防止编译器优化掉被测量的访问
+volatile uint64_t index_sink = 0;
+
+// 当前进程由透明大页支持的匿名内存（KiB），读取失败时为 0
+size_t anonHugePagesKb() {
+  std::ifstream smaps("/proc/self/smaps_rollup");
+  std::string key;
+  size_t kb = 0;
+  while (smaps >> key) {
+    if (key == "AnonHugePages:") {
+      smaps >> kb;
+      break;
+    }
+  }
+  return kb;
+}
+
+// 沿随机排列构成的单个环依次访问，每次访问都依赖上一次读到的下标，测量每次随机访问的平均时钟周期数
+size_t benchmarkChase(const uint64_t *next) {
+  uint64_t index = 0;
+  const auto start = Common::rdtsc();
+  for (size_t i = 0; i < chase_count; ++i)
+    index = next[index];
+  const auto total_rdtsc = Common::rdtsc() - start;
+  index_sink = index;
+
+  return (total_rdtsc / chase_count);
+}
+
+/// 程序入口：比较普通页和大页（MAP_HUGETLB，不可用时退回透明大页）支持的大数组上的随机访问
+int main(int, char **) {
+  srand(0);
+
+  // Sattolo 算法生成只有一个环的随机排列，使访问遍历整个数组
+  std::vector<uint64_t> next(num_elems);
+  std::iota(next.begin(), next.end(), 0);
+  for (size_t i = num_elems - 1; i > 0; --i)
+    std::swap(next[i], next[static_cast<size_t>(rand()) % i]);
+
+  const auto bytes = num_elems * sizeof(uint64_t);
+  for (const auto preferred_mode: {Common::HugePageMode::NORMAL, Common::HugePageMode::HUGETLB}) {
+    Common::HugePageMode mode;
+    auto region = static_cast<uint64_t *>(Common::allocateHugePages(bytes, preferred_mode, &mode));
+    const auto huge_kb_before = anonHugePagesKb();
+    std::copy(next.begin(), next.end(), region);
+    const auto huge_kb = anonHugePagesKb() - huge_kb_before;
+
+    // 校验访问确实遍历了整个环
+    uint64_t index = 0;
+    for (size_t i = 0; i < num_elems; ++i)
+      index = region[index];
+    ASSERT(index == 0, "随机排列不是单个环");
+
+    std::cout << "REQUESTED:" << Common::hugePageModeToString(preferred_mode) << " GOT:" << Common::hugePageModeToString(mode)
+              << " ANON-HUGE-PAGES:" << huge_kb << "KB RANDOM ACCESS " << benchmarkChase(region) << " CLOCK CYCLES PER OPERATION." << std::endl;
+
+    Common::deallocateHugePages(region, bytes);
+  }
+
+  exit(EXIT_SUCCESS);
+}
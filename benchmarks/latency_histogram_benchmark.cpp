@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <random>
+
+#include "common/logging.h"
+#include "common/latency_histogram.h"
+
+static constexpr size_t loop_count = 1000000;
+
+// 对数正态分布的延迟样本（中位数约1000，长尾到数十万），接近热路径测量的分布
+std::vector<uint64_t> generateSamples() {
+  std::mt19937_64 rng(1);
+  std::lognormal_distribution<double> latency(std::log(1000.0), 1.0);
+  std::vector<uint64_t> samples(loop_count);
+  for (auto &sample : samples)
+    sample = static_cast<uint64_t>(latency(rng));
+  return samples;
+}
+
+// 直接记录一个样本的平均时钟周期数
+size_t benchmarkRecord(Common::LatencyHistogram *histogram, const std::vector<uint64_t> &samples) {
+  const auto start = Common::rdtsc();
+  for (const auto sample : samples)
+    histogram->record(sample);
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  return (total_rdtsc / samples.size());
+}
+
+// 经由 START_MEASURE / END_MEASURE 测量一段空代码的平均时钟周期数，包括写日志行和记入直方图
+size_t benchmarkEndMeasure(Common::Logger &logger) {
+  constexpr size_t measure_count = 100000;
+  size_t total_rdtsc = 0;
+  for (size_t i = 0; i < measure_count; ++i) {
+    const auto start = Common::rdtsc();
+    START_MEASURE(Benchmark_empty);
+    END_MEASURE(Benchmark_empty, logger);
+    total_rdtsc += (Common::rdtsc() - start);
+  }
+
+  return (total_rdtsc / measure_count);
+}
+
+// 在两个标记之间交替调用 TTT_MEASURE 的平均时钟周期数，包括取时间戳、写日志行和记入跳转直方图
+size_t benchmarkTttMeasure(Common::Logger &logger) {
+  constexpr size_t measure_count = 100000;
+  size_t total_rdtsc = 0;
+  for (size_t i = 0; i < measure_count; ++i) {
+    const auto start = Common::rdtsc();
+    TTT_MEASURE(Benchmark_first, logger);
+    TTT_MEASURE(Benchmark_second, logger);
+    total_rdtsc += (Common::rdtsc() - start);
+  }
+
+  return (total_rdtsc / (measure_count * 2));
+}
+
+/// 程序入口：测量延迟直方图记录样本的开销，并校验其分位数与排序后精确分位数的相对误差
+int main(int, char **) {
+  const auto samples = generateSamples();
+
+  Common::LatencyHistogram histogram;
+  std::cout << "LatencyHistogram::record() " << benchmarkRecord(&histogram, samples) << " CLOCK CYCLES PER SAMPLE." << std::endl;
+
+  // 直方图分位数取所在桶的最大值，不小于精确值，且超出不多于精确值的 1/SUB_BUCKET_COUNT
+  Common::LatencyHistogramSnapshot snapshot;
+  snapshot.add(histogram);
+  auto sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  ASSERT(snapshot.count() == sorted.size() && snapshot.max() == sorted.back(), "直方图样本数或最大值错误。");
+  for (const auto fraction : {0.5, 0.9, 0.99, 0.999, 0.9999, 1.0}) {
+    const auto exact = sorted[static_cast<size_t>(std::ceil(fraction * sorted.size())) - 1];
+    const auto estimate = snapshot.percentile(fraction);
+    ASSERT(estimate >= exact && estimate - exact <= exact / Common::LATENCY_HISTOGRAM_SUB_BUCKET_COUNT,
+           "分位数 " + std::to_string(fraction) + " 精确值:" + std::to_string(exact) + " 直方图:" + std::to_string(estimate));
+    std::cout << "p" << fraction * 100 << " EXACT " << exact << " HISTOGRAM " << estimate << std::endl;
+  }
+
+  Common::Logger logger("latency_histogram_benchmark.log");
+  std::cout << "END_MEASURE " << benchmarkEndMeasure(logger) << " CLOCK CYCLES PER MEASUREMENT." << std::endl;
+  std::cout << "TTT_MEASURE " << benchmarkTttMeasure(logger) << " CLOCK CYCLES PER MEASUREMENT." << std::endl;
+
+  Common::latencyHistograms().dump(std::cout);
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,262 @@
+#include "common/lf_queue.h"
+#include "common/broadcast_queue.h"
+#include "common/thread_utils.h"
+#include "common/perf_utils.h"
+
+static constexpr size_t ping_pong_count = 100000;
+static constexpr size_t stream_count = 10000000;
+static constexpr size_t batch_size = 64;
+
+// 只有一个可用核心时，两个线程无法同时运行，等待时让出核心而不是忙等
+bool yield_when_waiting = false;
+
+inline auto waitPause() noexcept {
+  if (yield_when_waiting)
+    std::this_thread::yield();
+  else
+    _mm_pause();
+}
+
+// 原 LFQueue 的实现：生产者和消费者在每个元素上都对共享的 num_elements_ 执行原子加减，每次读写都加载对方的索引
+template<typename T>
+class CountedLFQueue final {
+public:
+  explicit CountedLFQueue(std::size_t num_elems) :
+      store_(num_elems, T()), mask_(num_elems - 1) {
+  }
+
+  auto tryGetNextToWriteTo() noexcept -> T * {
+    const auto current_write = next_write_index_.load(std::memory_order_relaxed);
+    const auto current_read = next_read_index_.load(std::memory_order_acquire);
+    return (((current_write + 1) & mask_) != (current_read & mask_) ? &store_[current_write & mask_] : nullptr);
+  }
+
+  auto updateWriteIndex() noexcept {
+    next_write_index_.store(next_write_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    num_elements_.fetch_add(1, std::memory_order_release);
+  }
+
+  auto getNextToRead() const noexcept -> const T * {
+    const auto current_read_index = next_read_index_.load(std::memory_order_relaxed);
+    return (num_elements_.load(std::memory_order_acquire) ? &store_[current_read_index & mask_] : nullptr);
+  }
+
+  auto updateReadIndex() noexcept {
+    next_read_index_.store(next_read_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    num_elements_.fetch_sub(1, std::memory_order_release);
+  }
+
+private:
+  std::vector<T> store_;
+  const std::size_t mask_;
+
+  alignas(64) std::atomic<std::size_t> next_write_index_ = {0};
+  alignas(64) std::atomic<std::size_t> next_read_index_ = {0};
+  alignas(64) std::atomic<std::size_t> num_elements_ = {0};
+};
+
+// 读取队列中的下一个元素，队列为空时等待
+template<typename QueueT>
+auto readNext(QueueT *queue) noexcept {
+  const uint64_t *value;
+  while (!(value = queue->getNextToRead()))
+    waitPause();
+  const auto result = *value;
+  queue->updateReadIndex();
+  return result;
+}
+
+// 写入一个元素，队列已满时等待
+template<typename QueueT>
+auto writeNext(QueueT *queue, uint64_t value) noexcept {
+  uint64_t *slot;
+  while (!(slot = queue->tryGetNextToWriteTo()))
+    waitPause();
+  *slot = value;
+  queue->updateWriteIndex();
+}
+
+// 回应线程：将 ping 队列中收到的每个值写回 pong 队列
+template<typename QueueT>
+void pongLoop(QueueT *ping, QueueT *pong) {
+  for (size_t i = 0; i < ping_pong_count; ++i)
+    writeNext(pong, readNext(ping));
+}
+
+// 当前线程与 pong_core 上的回应线程通过两个队列来回传递一个值，测量一次往返的时钟周期数
+template<typename QueueT>
+size_t benchmarkPingPong(int pong_core) {
+  QueueT ping(1024), pong(1024);
+  auto pong_thread = Common::createAndStartThread(pong_core, "lf_queue_benchmark_pong", pongLoop<QueueT>, &ping, &pong);
+
+  const auto start = Common::rdtsc();
+  for (uint64_t i = 0; i < ping_pong_count; ++i) {
+    writeNext(&ping, i);
+    ASSERT(readNext(&pong) == i, "往返的值不一致：" + std::to_string(i));
+  }
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  pong_thread->join();
+  delete pong_thread;
+
+  return (total_rdtsc / ping_pong_count);
+}
+
+// 生产者线程：按顺序写入 stream_count 个值
+template<typename QueueT>
+void produceLoop(QueueT *queue) {
+  for (uint64_t i = 0; i < stream_count; ++i)
+    writeNext(queue, i);
+}
+
+// producer_core 上的生产者线程持续写入，当前线程持续读取，测量每个元素的平均时钟周期数
+template<typename QueueT>
+size_t benchmarkStream(int producer_core) {
+  QueueT queue(1024);
+  auto producer_thread = Common::createAndStartThread(producer_core, "lf_queue_benchmark_producer", produceLoop<QueueT>, &queue);
+
+  const auto start = Common::rdtsc();
+  for (uint64_t i = 0; i < stream_count; ++i)
+    ASSERT(readNext(&queue) == i, "读取的值乱序：" + std::to_string(i));
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  producer_thread->join();
+  delete producer_thread;
+
+  return (total_rdtsc / stream_count);
+}
+
+// 批量生产者线程：每次申请 batch_size 个连续槽位，写满后一次发布
+void produceBatchLoop(Common::LFQueue<uint64_t> *queue) {
+  for (uint64_t i = 0; i < stream_count; i += batch_size) {
+    const auto num_elems = std::min<uint64_t>(batch_size, stream_count - i);
+    auto slots = queue->tryClaimWrite(num_elems);
+    while (slots.size() < num_elems) {
+      waitPause();
+      slots = queue->tryClaimWrite(num_elems);
+    }
+    for (size_t j = 0; j < num_elems; ++j)
+      slots[j] = i + j;
+    queue->publishWrite(num_elems);
+  }
+}
+
+// 与 benchmarkStream 相同，但生产者批量发布，当前线程每次读取全部已发布的元素后一次归还槽位
+size_t benchmarkBatchStream(int producer_core) {
+  Common::LFQueue<uint64_t> queue(1024);
+  auto producer_thread = Common::createAndStartThread(producer_core, "lf_queue_benchmark_batch_producer", produceBatchLoop, &queue);
+
+  const auto start = Common::rdtsc();
+  for (uint64_t i = 0; i < stream_count;) {
+    const auto values = queue.getReadable();
+    if (values.empty()) {
+      waitPause();
+      continue;
+    }
+    for (size_t j = 0; j < values.size(); ++j, ++i) {
+      if (UNLIKELY(values[j] != i))
+        FATAL("读取的值乱序：" + std::to_string(i));
+    }
+    queue.commitRead(values.size());
+  }
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  producer_thread->join();
+  delete producer_thread;
+
+  return (total_rdtsc / stream_count);
+}
+
+// 转发线程：像原市场数据发布器一样读取第一个队列，再把每个值拷贝到第二个队列
+void forwardLoop(Common::LFQueue<uint64_t> *input, Common::LFQueue<uint64_t> *output) {
+  for (uint64_t i = 0; i < stream_count; ++i)
+    writeNext(output, readNext(input));
+}
+
+// 生产者写入第一个队列，转发线程拷贝到第二个队列，当前线程读取第二个队列，测量两个消费者都读到每个元素的平均时钟周期数
+size_t benchmarkForwardCopy(int other_core) {
+  Common::LFQueue<uint64_t> input(1024), output(1024);
+  auto producer_thread = Common::createAndStartThread(other_core, "lf_queue_benchmark_producer", produceLoop<Common::LFQueue<uint64_t>>, &input);
+  auto forward_thread = Common::createAndStartThread(other_core, "lf_queue_benchmark_forward", forwardLoop, &input, &output);
+
+  const auto start = Common::rdtsc();
+  for (uint64_t i = 0; i < stream_count; ++i) {
+    if (UNLIKELY(readNext(&output) != i))
+      FATAL("读取的值乱序：" + std::to_string(i));
+  }
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  producer_thread->join();
+  forward_thread->join();
+  delete producer_thread;
+  delete forward_thread;
+
+  return (total_rdtsc / stream_count);
+}
+
+// 广播队列的生产者线程：每个值只写入一次
+void produceBroadcastLoop(Common::BroadcastQueue<uint64_t> *queue) {
+  for (uint64_t i = 0; i < stream_count; ++i) {
+    uint64_t *slot;
+    while (!(slot = queue->tryGetNextToWriteTo()))
+      waitPause();
+    *slot = i;
+    queue->updateWriteIndex();
+  }
+}
+
+// 广播队列的读取线程：按顺序读取全部值
+void readBroadcastLoop(Common::BroadcastQueue<uint64_t>::Reader *reader) {
+  for (uint64_t i = 0; i < stream_count; ++i) {
+    if (UNLIKELY(readNext(reader) != i))
+      FATAL("读取的值乱序：" + std::to_string(i));
+  }
+}
+
+// 生产者写入广播队列一次，另一个线程和当前线程各自按独立的读取位置读取，测量两个消费者都读到每个元素的平均时钟周期数
+size_t benchmarkBroadcast(int other_core) {
+  Common::BroadcastQueue<uint64_t> queue(1024);
+  auto reader = queue.addReader(), other_reader = queue.addReader();
+  auto reader_thread = Common::createAndStartThread(other_core, "lf_queue_benchmark_reader", readBroadcastLoop, other_reader);
+  auto producer_thread = Common::createAndStartThread(other_core, "lf_queue_benchmark_producer", produceBroadcastLoop, &queue);
+
+  const auto start = Common::rdtsc();
+  readBroadcastLoop(reader);
+  reader_thread->join();
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  producer_thread->join();
+  delete producer_thread;
+  delete reader_thread;
+
+  return (total_rdtsc / stream_count);
+}
+
+/// 程序入口：./lf_queue_benchmark [核心1 核心2]，默认使用核心0和1，只有一个可用核心时不绑定核心
+int main(int argc, char **argv) {
+  const bool multi_core = (std::thread::hardware_concurrency() > 1);
+  const int main_core = (argc > 2 ? atoi(argv[1]) : (multi_core ? 0 : -1));
+  const int other_core = (argc > 2 ? atoi(argv[2]) : (multi_core ? 1 : -1));
+  yield_when_waiting = !multi_core;
+  if (main_core >= 0)
+    ASSERT(Common::setThreadCore(main_core), "无法绑定核心：" + std::to_string(main_core));
+
+  std::cout << "CORES " << main_core << " " << other_core << (multi_core ? "" : " (SINGLE CORE, WAITING THREADS YIELD)") << std::endl;
+
+  std::cout << "COUNTED LFQUEUE PING-PONG " << benchmarkPingPong<CountedLFQueue<uint64_t>>(other_core)
+            << " CLOCK CYCLES PER ROUND TRIP." << std::endl;
+  std::cout << "CACHED-INDEX LFQUEUE PING-PONG " << benchmarkPingPong<Common::LFQueue<uint64_t>>(other_core)
+            << " CLOCK CYCLES PER ROUND TRIP." << std::endl;
+
+  std::cout << "COUNTED LFQUEUE STREAM " << benchmarkStream<CountedLFQueue<uint64_t>>(other_core)
+            << " CLOCK CYCLES PER ELEMENT." << std::endl;
+  std::cout << "CACHED-INDEX LFQUEUE STREAM " << benchmarkStream<Common::LFQueue<uint64_t>>(other_core)
+            << " CLOCK CYCLES PER ELEMENT." << std::endl;
+  std::cout << "CACHED-INDEX LFQUEUE BATCH STREAM (" << batch_size << " PER CLAIM) " << benchmarkBatchStream(other_core)
+            << " CLOCK CYCLES PER ELEMENT." << std::endl;
+
+  std::cout << "FORWARD-COPY TWO CONSUMERS STREAM " << benchmarkForwardCopy(other_core) << " CLOCK CYCLES PER ELEMENT." << std::endl;
+  std::cout << "BROADCAST QUEUE TWO READERS STREAM " << benchmarkBroadcast(other_core) << " CLOCK CYCLES PER ELEMENT." << std::endl;
+
+  exit(EXIT_SUCCESS);
+}
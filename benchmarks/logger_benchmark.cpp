@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <iterator>
+
 #include "common/logging.h"
 #include "common/opt_logging.h"
+#include "common/bin_logging.h"
+#include "common/types.h"
 
 std::string random_string(size_t length) {
   auto randchar = []() -> char {
@@ -29,22 +34,94 @@ size_t benchmarkLogging(T *logger) {
   return (total_rdtsc / loop_count);
 }
 
-int main(int, char **) {
+// 模拟系统中典型的日志行：较长的格式串和多个整数、字符、浮点数参数
+template<typename T>
+size_t benchmarkTypicalLogging(T *logger) {
+  constexpr size_t loop_count = 100000;
+  const std::string time_str = "12:34:56.123456789";
+  size_t total_rdtsc = 0;
+  for (size_t i = 0; i < loop_count; ++i) {
+    const auto price = static_cast<long>(rand() % 10000);
+    const auto qty = static_cast<unsigned>(rand() % 1000);
+    const auto start = Common::rdtsc();
+    logger->log("%:% %() % 订单 ticker:% 方向:% 价格:% 数量:% 均价:%\n", __FILE__, __LINE__, __FUNCTION__, time_str,
+                static_cast<int>(i % 8), (i % 2 ? 'B' : 'S'), price, qty, price * 1.25);
+    total_rdtsc += (Common::rdtsc() - start);
+  }
+
+  return (total_rdtsc / loop_count);
+}
+
+// 带 toString() 对象参数的日志行：二进制记录日志器按值拷贝对象、由后台线程转换为字符串，其他日志器在调用处转换
+template<typename T>
+size_t benchmarkObjectLogging(T *logger) {
+  constexpr size_t loop_count = 100000;
+  size_t total_rdtsc = 0;
+  for (size_t i = 0; i < loop_count; ++i) {
+    const Common::RiskCfg risk_cfg{static_cast<Common::Qty>(rand() % 1000), static_cast<Common::Qty>(rand() % 10000), -(rand() % 100000) * 0.5};
+    const auto start = Common::rdtsc();
+    if constexpr (std::is_same_v<T, Common::BinLogger>) {
+      logger->log("策略:% %\n", static_cast<int>(i % 4), risk_cfg);
+    } else {
+      logger->log("策略:% %\n", static_cast<int>(i % 4), risk_cfg.toString());
+    }
+    total_rdtsc += (Common::rdtsc() - start);
+  }
+
+  return (total_rdtsc / loop_count);
+}
+
+// 三种负载使用相同的随机数序列，使每个日志器写出的内容完全相同
+template<typename T>
+void benchmarkLogger(T *logger, const std::string &name) {
   using namespace std::literals::chrono_literals;
 
+  srand(0);
+  const auto cycles = benchmarkLogging(logger);
+  const auto typical_cycles = benchmarkTypicalLogging(logger);
+  const auto object_cycles = benchmarkObjectLogging(logger);
+  std::cout << name << " " << cycles << " CLOCK CYCLES PER OPERATION. TYPICAL LINE " << typical_cycles
+            << " CLOCK CYCLES PER OPERATION. OBJECT LINE " << object_cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::this_thread::sleep_for(10s);
+}
+
+std::string readFile(const std::string &file_name) {
+  std::ifstream file(file_name, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+int main(int, char **) {
   {
     Common::Logger logger("logger_benchmark_original.log");
-    const auto cycles = benchmarkLogging(&logger);
-    std::cout << "ORIGINAL LOGGER " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
-    std::this_thread::sleep_for(10s);
+    benchmarkLogger(&logger, "ORIGINAL LOGGER");
   }
 
   {
     OptCommon::OptLogger opt_logger("logger_benchmark_optimized.log");
-    const auto cycles = benchmarkLogging(&opt_logger);
-    std::cout << "OPTIMIZED LOGGER " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
-    std::this_thread::sleep_for(10s);
+    benchmarkLogger(&opt_logger, "OPTIMIZED LOGGER");
+  }
+
+  {
+    Common::BinLogger bin_logger("logger_benchmark_bin_text.log", Common::BinLogMode::TEXT);
+    benchmarkLogger(&bin_logger, "BINARY RECORD LOGGER (TEXT OUTPUT)");
+  }
+
+  {
+    Common::BinLogger bin_logger("logger_benchmark_bin_binary.log", Common::BinLogMode::BINARY);
+    benchmarkLogger(&bin_logger, "BINARY RECORD LOGGER (BINARY OUTPUT)");
+  }
+
+  // 校验两种输出模式与原日志器写出的文本逐字节相同
+  {
+    std::ifstream binary_log("logger_benchmark_bin_binary.log", std::ios::binary);
+    std::ofstream decoded_log("logger_benchmark_bin_decoded.log", std::ios::binary);
+    const auto num_entries = Common::decodeBinLog(binary_log, decoded_log);
+    ASSERT(num_entries == 300000, "二进制日志解码出的记录数不正确：" + std::to_string(num_entries));
   }
+  const auto original = readFile("logger_benchmark_original.log");
+  ASSERT(readFile("logger_benchmark_bin_text.log") == original, "二进制记录日志器的文本输出与原日志器不一致");
+  ASSERT(readFile("logger_benchmark_bin_decoded.log") == original, "二进制日志解码后与原日志器的输出不一致");
+  std::cout << "BINARY RECORD LOGGER OUTPUT MATCHES ORIGINAL LOGGER (" << original.size() << " BYTES)." << std::endl;
 
   exit(EXIT_SUCCESS);
 }
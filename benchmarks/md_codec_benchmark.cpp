@@ -0,0 +1,116 @@
+#include "matcher/matching_engine.h"
+#include "market_data/compact_market_update.h"
+
+static constexpr size_t loop_count = 100000;
+
+// 比较两个市场更新的所有字段
+bool sameMarketUpdate(const Exchange::MEMarketUpdate &lhs, const Exchange::MEMarketUpdate &rhs) {
+  return lhs.type_ == rhs.type_ && lhs.order_id_ == rhs.order_id_ && lhs.ticker_id_ == rhs.ticker_id_ && lhs.side_ == rhs.side_ &&
+         lhs.price_ == rhs.price_ && lhs.qty_ == rhs.qty_ && lhs.priority_ == rhs.priority_;
+}
+
+int main(int, char **) {
+  srand(0);
+
+  // 用撮合引擎订单簿处理随机订单请求，生成真实的增量市场更新序列
+  Common::BinLogger logger("md_codec_benchmark.log");
+  Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
+  Exchange::ClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
+  Exchange::MEMarketUpdateBroadcastQueue market_updates(ME_MAX_MARKET_UPDATES);
+  auto market_updates_reader = market_updates.addReader();
+  auto matching_engine = new Exchange::MatchingEngine(&client_requests, &client_responses, &market_updates);
+  auto me_order_book = new Exchange::MEOrderBook(0, &logger, matching_engine);
+
+  std::vector<Exchange::MEMarketUpdate> updates;
+  std::vector<Exchange::MEClientRequest> client_requests_vec;
+  Common::OrderId order_id = 1000;
+  Price base_price = (rand() % 100) + 100;
+  while (updates.size() < loop_count) {
+    const Price price = base_price + (rand() % 10) + 1;
+    const Qty qty = 1 + (rand() % 100) + 1;
+    const Side side = (rand() % 2 ? Common::Side::BUY : Common::Side::SELL);
+
+    Exchange::MEClientRequest new_request{Exchange::ClientRequestType::NEW, 0, 0, order_id++, side, price, qty};
+    me_order_book->add(new_request.client_id_, new_request.order_id_, new_request.ticker_id_, new_request.side_, new_request.price_, new_request.qty_);
+    client_requests_vec.push_back(new_request);
+
+    const auto &cxl_request = client_requests_vec[rand() % client_requests_vec.size()];
+    me_order_book->cancel(cxl_request.client_id_, cxl_request.order_id_, cxl_request.ticker_id_);
+    matching_engine->publishPending();
+
+    for (auto market_update = market_updates_reader->getNextToRead(); market_update; market_update = market_updates_reader->getNextToRead()) {
+      updates.push_back(*market_update);
+      market_updates_reader->updateReadIndex();
+    }
+    while (client_responses.getNextToRead())
+      client_responses.updateReadIndex();
+  }
+  updates.resize(loop_count);
+
+  std::vector<char> buffer(loop_count * sizeof(Exchange::MDPMarketUpdate) + Exchange::COMPACT_MD_MAX_PACKET_SIZE);
+
+  // 定长格式：与 MarketDataPublisher 一样逐条拷贝序列号和市场更新
+  {
+    size_t encode_rdtsc = 0, decode_rdtsc = 0, size = 0;
+
+    for (size_t i = 0; i < loop_count; ++i) {
+      const auto start = Common::rdtsc();
+      const size_t seq_num = i + 1;
+      memcpy(buffer.data() + size, &seq_num, sizeof(seq_num));
+      memcpy(buffer.data() + size + sizeof(seq_num), &updates[i], sizeof(Exchange::MEMarketUpdate));
+      size += sizeof(Exchange::MDPMarketUpdate);
+      encode_rdtsc += (Common::rdtsc() - start);
+    }
+
+    Exchange::MDPMarketUpdate decoded;
+    for (size_t i = 0; i < loop_count; ++i) {
+      const auto start = Common::rdtsc();
+      memcpy(&decoded, buffer.data() + i * sizeof(Exchange::MDPMarketUpdate), sizeof(Exchange::MDPMarketUpdate));
+      decode_rdtsc += (Common::rdtsc() - start);
+      ASSERT(decoded.seq_num_ == i + 1 && sameMarketUpdate(decoded.me_market_update_, updates[i]), "定长格式往返不一致：" + decoded.toString());
+    }
+
+    std::cout << "FIXED ENCODE " << (encode_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+    std::cout << "FIXED DECODE " << (decode_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+    std::cout << "FIXED " << (static_cast<double>(size) / loop_count) << " BYTES PER UPDATE." << std::endl;
+  }
+
+  // 紧凑格式：每个包最多 COMPACT_MD_MAX_UPDATES_PER_PACKET 个市场更新
+  {
+    size_t encode_rdtsc = 0, decode_rdtsc = 0, size = 0;
+
+    auto encoder = new Exchange::CompactMarketUpdateEncoder();
+    encoder->reset(1);
+    for (size_t i = 0; i < loop_count; ++i) {
+      const auto start = Common::rdtsc();
+      encoder->add(updates[i]);
+      if (encoder->full() || i + 1 == loop_count) {
+        const auto packet_size = encoder->finish();
+        memcpy(buffer.data() + size, encoder->data(), packet_size);
+        size += packet_size;
+        encoder->reset(i + 2);
+      }
+      encode_rdtsc += (Common::rdtsc() - start);
+    }
+
+    std::vector<Exchange::MDPMarketUpdate> decoded(loop_count);
+    size_t num_decoded = 0;
+    const auto start = Common::rdtsc();
+    const auto consumed = Exchange::decodeCompactPackets(buffer.data(), size, [&](const Exchange::MDPMarketUpdate &update) {
+      decoded[num_decoded++] = update;
+    });
+    decode_rdtsc += (Common::rdtsc() - start);
+
+    ASSERT(consumed == size && num_decoded == loop_count, "紧凑格式解码数量不一致：" + std::to_string(num_decoded));
+    for (size_t i = 0; i < loop_count; ++i) {
+      ASSERT(decoded[i].seq_num_ == i + 1 && sameMarketUpdate(decoded[i].me_market_update_, updates[i]),
+             "紧凑格式往返不一致：" + decoded[i].toString() + " 原始：" + updates[i].toString());
+    }
+
+    std::cout << "COMPACT ENCODE " << (encode_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+    std::cout << "COMPACT DECODE " << (decode_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+    std::cout << "COMPACT " << (static_cast<double>(size) / loop_count) << " BYTES PER UPDATE." << std::endl;
+  }
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,143 @@
+#include "common/mpsc_queue.h"
+#include "common/lf_queue.h"
+#include "common/thread_utils.h"
+#include "common/perf_utils.h"
+
+static constexpr size_t total_count = 2 * 1024 * 1024;
+static constexpr size_t producer_shift = 40;  // 元素的高位为生产者编号，低位为该生产者内的序号
+
+// 只有一个可用核心时，多个线程无法同时运行，等待时让出核心而不是忙等
+bool yield_when_waiting = false;
+
+// 全部生产者线程启动后同时开始写入
+std::atomic<bool> start_producers = {false};
+
+inline auto waitPause() noexcept {
+  if (yield_when_waiting)
+    std::this_thread::yield();
+  else
+    _mm_pause();
+}
+
+// 写入一个元素，队列已满时等待
+template<typename QueueT>
+auto writeNext(QueueT *queue, uint64_t value) noexcept {
+  uint64_t *slot;
+  while (!(slot = queue->tryGetNextToWriteTo()))
+    waitPause();
+  *slot = value;
+  if constexpr (std::is_same_v<QueueT, Common::MPSCQueue<uint64_t>>)
+    queue->updateWriteIndex(slot);
+  else
+    queue->updateWriteIndex();
+}
+
+// 生产者线程：等待开始信号后按顺序写入 count 个带生产者编号的值
+template<typename QueueT>
+void produceLoop(QueueT *queue, size_t producer, size_t count) {
+  while (!start_producers.load(std::memory_order_acquire))
+    waitPause();
+  for (uint64_t i = 0; i < count; ++i)
+    writeNext(queue, (static_cast<uint64_t>(producer) << producer_shift) | i);
+}
+
+// 校验每个生产者的值按写入顺序到达
+inline auto checkValue(std::vector<uint64_t> *next_seqs, uint64_t value) noexcept {
+  auto &next_seq = (*next_seqs)[value >> producer_shift];
+  if (UNLIKELY((value & ((1ULL << producer_shift) - 1)) != next_seq))
+    FATAL("生产者 " + std::to_string(value >> producer_shift) + " 的值乱序：" + std::to_string(value & ((1ULL << producer_shift) - 1)));
+  ++next_seq;
+}
+
+// 启动 num_producers 个生产者线程并发出开始信号，返回开始时的时钟周期数
+template<typename QueueT>
+auto startProducers(std::vector<QueueT *> &queues, size_t num_producers, std::vector<std::thread *> *threads) {
+  for (size_t producer = 0; producer < num_producers; ++producer)
+    threads->push_back(Common::createAndStartThread(-1, "mpsc_queue_benchmark_producer_" + std::to_string(producer), produceLoop<QueueT>,
+                                                    queues[producer % queues.size()], producer, total_count / num_producers));
+  const auto start = Common::rdtsc();
+  start_producers.store(true, std::memory_order_release);
+  return start;
+}
+
+auto joinProducers(std::vector<std::thread *> *threads) {
+  for (auto thread: *threads) {
+    thread->join();
+    delete thread;
+  }
+  threads->clear();
+  start_producers.store(false, std::memory_order_release);
+}
+
+// 全部生产者写入同一个多生产者队列，当前线程作为唯一的消费者读取，测量每个元素的平均时钟周期数
+size_t benchmarkMPSC(size_t num_producers) {
+  Common::MPSCQueue<uint64_t> queue(1024);
+  std::vector<Common::MPSCQueue<uint64_t> *> queues{&queue};
+  std::vector<std::thread *> threads;
+  std::vector<uint64_t> next_seqs(num_producers, 0);
+
+  const auto count = (total_count / num_producers) * num_producers;
+  const auto start = startProducers(queues, num_producers, &threads);
+  for (size_t i = 0; i < count;) {
+    const auto value = queue.getNextToRead();
+    if (!value) {
+      waitPause();
+      continue;
+    }
+    checkValue(&next_seqs, *value);
+    queue.updateReadIndex();
+    ++i;
+  }
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  joinProducers(&threads);
+  ASSERT(queue.size() == 0, "队列中仍有元素：" + std::to_string(queue.size()));
+
+  return (total_rdtsc / count);
+}
+
+// 每个生产者一个单生产者单消费者队列，当前线程轮询全部队列，测量每个元素的平均时钟周期数
+size_t benchmarkQueuePerProducer(size_t num_producers) {
+  std::vector<Common::LFQueue<uint64_t> *> queues;
+  for (size_t producer = 0; producer < num_producers; ++producer)
+    queues.push_back(new Common::LFQueue<uint64_t>(1024));
+  std::vector<std::thread *> threads;
+  std::vector<uint64_t> next_seqs(num_producers, 0);
+
+  const auto count = (total_count / num_producers) * num_producers;
+  const auto start = startProducers(queues, num_producers, &threads);
+  for (size_t i = 0; i < count;) {
+    bool read = false;
+    for (auto queue: queues) {
+      for (auto value = queue->getNextToRead(); value; value = queue->getNextToRead()) {
+        checkValue(&next_seqs, *value);
+        queue->updateReadIndex();
+        ++i;
+        read = true;
+      }
+    }
+    if (!read)
+      waitPause();
+  }
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  joinProducers(&threads);
+  for (auto queue: queues)
+    delete queue;
+
+  return (total_rdtsc / count);
+}
+
+/// 程序入口：./mpsc_queue_benchmark，生产者线程不绑定核心，只有一个可用核心时等待的线程让出核心
+int main(int, char **) {
+  yield_when_waiting = (std::thread::hardware_concurrency() <= 1);
+
+  for (const size_t num_producers: {2, 4, 8, 16}) {
+    std::cout << "MPSC QUEUE " << num_producers << " PRODUCERS " << benchmarkMPSC(num_producers)
+              << " CLOCK CYCLES PER ELEMENT." << std::endl;
+    std::cout << "SPSC QUEUE PER PRODUCER " << num_producers << " PRODUCERS " << benchmarkQueuePerProducer(num_producers)
+              << " CLOCK CYCLES PER ELEMENT." << std::endl;
+  }
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "common/perf_counters.h"
+#include "common/perf_utils.h"
+
+static constexpr size_t num_elems = 8 * 1024 * 1024;  // 64 MiB，远大于末级缓存
+static constexpr size_t accesses_per_sample = 4096;
+static constexpr size_t sample_count = 1000;
+
+// 用于防止编译器优化掉被测量的访问
+volatile uint64_t value_sink = 0;
+
+// 每次读取当前线程全部计数器的平均时钟周期数
+size_t benchmarkRead(const Common::PerfCounterGroup &group) {
+  constexpr size_t read_count = 100000;
+  uint64_t sum = 0;
+  const auto start = Common::rdtsc();
+  for (size_t i = 0; i < read_count; ++i)
+    sum += group.read().values_[0];
+  const auto total_rdtsc = Common::rdtsc() - start;
+  value_sink = sum;
+
+  return (total_rdtsc / read_count);
+}
+
+// 以与 START_MEASURE / END_MEASURE 相同的方式在每个样本前后读取计数器，将差值记入 TAG 的统计
+template<typename F>
+void measure(const std::string &tag, F &&sample) {
+  auto &group = Common::threadPerfCounters();
+  auto stats = Common::perfCounters().stats(tag);
+  for (size_t i = 0; i < sample_count; ++i) {
+    const auto before = group.read();
+    sample(i);
+    stats->record(group.read() - before);
+  }
+}
+
+/// 程序入口：测量读取硬件计数器的开销，并在顺序访问、随机访问和不可预测分支三种负载上按标签汇总计数器
+int main(int, char **) {
+  srand(0);
+
+  auto &group = Common::threadPerfCounters();
+  std::cout << "HARDWARE COUNTERS " << (group.isAvailable(Common::PerfCounter::CYCLES) ? "AVAILABLE" : "NOT AVAILABLE")
+            << ", READ WITH " << (group.usesRdpmc() ? "rdpmc" : "read()") << " " << benchmarkRead(group)
+            << " CLOCK CYCLES PER READ OF ALL COUNTERS." << std::endl;
+
+  // Sattolo 算法生成只有一个环的随机排列，使随机访问遍历整个数组
+  std::vector<uint64_t> next(num_elems);
+  std::iota(next.begin(), next.end(), 0);
+  for (size_t i = num_elems - 1; i > 0; --i)
+    std::swap(next[i], next[static_cast<size_t>(rand()) % i]);
+
+  std::vector<uint8_t> bits(accesses_per_sample * sample_count);
+  for (auto &bit : bits)
+    bit = rand() % 2;
+
+  measure("Benchmark_sequential", [&next](size_t i) {
+    uint64_t sum = 0;
+    for (size_t j = 0; j < accesses_per_sample; ++j)
+      sum += next[(i * accesses_per_sample + j) % num_elems];
+    value_sink = sum;
+  });
+
+  uint64_t index = 0;
+  measure("Benchmark_random", [&next, &index](size_t) {
+    for (size_t j = 0; j < accesses_per_sample; ++j)
+      index = next[index];
+    value_sink = index;
+  });
+
+  measure("Benchmark_unpredictable_branch", [&bits](size_t i) {
+    uint64_t sum = 0;
+    for (size_t j = 0; j < accesses_per_sample; ++j) {
+      if (bits[i * accesses_per_sample + j])
+        sum += j;
+      else
+        sum ^= j;
+    }
+    value_sink = sum;
+  });
+
+  // 计数器可用时，每个样本都执行了数千条指令
+  if (group.isAvailable(Common::PerfCounter::INSTRUCTIONS)) {
+    const auto counters = group.read();
+    ASSERT(counters.values_[static_cast<size_t>(Common::PerfCounter::INSTRUCTIONS)] > sample_count * accesses_per_sample,
+           "指令计数过小：" + std::to_string(counters.values_[static_cast<size_t>(Common::PerfCounter::INSTRUCTIONS)]));
+  }
+
+  Common::perfCounters().dump(std::cout);
+
+  exit(EXIT_SUCCESS);
+}
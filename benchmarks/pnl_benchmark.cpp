@@ -0,0 +1,130 @@
+#include "strategy/position_keeper.h"
+
+static constexpr size_t loop_count = 1000000;
+
+// 用于防止编译器优化掉被测量的盈亏计算
+volatile bool changed_sink = false;
+volatile int64_t pnl_sink = 0;
+
+// 原 PositionInfo 中以 double 累计开仓金额和盈亏的实现（去掉日志），每次成交和盘口变化都要除以持仓量
+struct DoublePositionInfo {
+  int32_t position_ = 0;
+  double real_pnl_ = 0, unreal_pnl_ = 0, total_pnl_ = 0;
+  std::array<double, sideToIndex(Side::MAX) + 1> open_vwap_ = {};
+
+  auto addFill(const Exchange::MEClientResponse *client_response) noexcept {
+    const auto old_position = position_;
+    const auto side_index = sideToIndex(client_response->side_);
+    const auto opp_side_index = sideToIndex(client_response->side_ == Side::BUY ? Side::SELL : Side::BUY);
+    const auto side_value = sideToValue(client_response->side_);
+    position_ += client_response->exec_qty_ * side_value;
+
+    if (old_position * sideToValue(client_response->side_) >= 0) {
+      open_vwap_[side_index] += (client_response->price_ * client_response->exec_qty_);
+    } else {
+      const auto opp_side_vwap = open_vwap_[opp_side_index] / std::abs(old_position);
+      open_vwap_[opp_side_index] = opp_side_vwap * std::abs(position_);
+      real_pnl_ += std::min(static_cast<int32_t>(client_response->exec_qty_), std::abs(old_position)) *
+                   (opp_side_vwap - client_response->price_) * sideToValue(client_response->side_);
+      if (static_cast<int64_t>(position_) * old_position < 0) {  // 与 PositionInfo 相同，避免大持仓时 int32 相乘溢出
+        open_vwap_[side_index] = (client_response->price_ * std::abs(position_));
+        open_vwap_[opp_side_index] = 0;
+      }
+    }
+
+    if (!position_) {
+      open_vwap_[sideToIndex(Side::BUY)] = open_vwap_[sideToIndex(Side::SELL)] = 0;
+      unreal_pnl_ = 0;
+    } else {
+      if (position_ > 0)
+        unreal_pnl_ = (client_response->price_ - open_vwap_[sideToIndex(Side::BUY)] / std::abs(position_)) * std::abs(position_);
+      else
+        unreal_pnl_ = (open_vwap_[sideToIndex(Side::SELL)] / std::abs(position_) - client_response->price_) * std::abs(position_);
+    }
+
+    total_pnl_ = unreal_pnl_ + real_pnl_;
+  }
+
+  auto updateBBO(const Trading::BBO *bbo) noexcept {
+    const auto mid_price = (bbo->bid_price_ + bbo->ask_price_) * 0.5;
+    if (position_ > 0)
+      unreal_pnl_ = (mid_price - open_vwap_[sideToIndex(Side::BUY)] / std::abs(position_)) * std::abs(position_);
+    else
+      unreal_pnl_ = (open_vwap_[sideToIndex(Side::SELL)] / std::abs(position_) - mid_price) * std::abs(position_);
+
+    const auto old_total_pnl = total_pnl_;
+    total_pnl_ = unreal_pnl_ + real_pnl_;
+    return (total_pnl_ != old_total_pnl);
+  }
+};
+
+int main(int, char **) {
+  srand(0);
+
+  Common::BinLogger logger("pnl_benchmark.log");
+  Common::BinLogger::setEnabled(false);  // 只比较盈亏计算，不写出每次成交的日志
+
+  // 预先生成随机成交和盘口，成交价和盘口围绕一个缓慢漂移的价格波动
+  std::vector<Exchange::MEClientResponse> fills(loop_count);
+  std::vector<Trading::BBO> bbos(loop_count);
+  Price price = 1000;
+  for (size_t i = 0; i < loop_count; ++i) {
+    price = std::max<Price>(price + (rand() % 3) - 1, 10);
+    fills[i] = {Exchange::ClientResponseType::FILLED, 1, 0, i, i, (rand() % 2 ? Side::BUY : Side::SELL),
+                price + (rand() % 5) - 2, static_cast<Qty>(1 + rand() % 100), 0};
+    bbos[i].bid_price_ = price - 1 - rand() % 2;
+    bbos[i].ask_price_ = price + 1 + rand() % 2;
+  }
+
+  // 每次成交之后盘口变化一次，校验定点数的总盈亏始终精确，并比较两种实现累计的误差
+  Trading::PositionInfo fixed_position;
+  DoublePositionInfo double_position;
+  int64_t cash = 0;  // 以整数精确累计的现金流，精确的总盈亏为 现金流 + 持仓×中间价
+  for (size_t i = 0; i < loop_count; ++i) {
+    fixed_position.addFill(&fills[i], &logger);
+    double_position.addFill(&fills[i]);
+    cash -= sideToValue(fills[i].side_) * fills[i].price_ * static_cast<int64_t>(fills[i].exec_qty_);
+    if (!fixed_position.position_)
+      continue;
+
+    const auto bbo = &bbos[i];
+    fixed_position.updateBBO(bbo);
+    double_position.updateBBO(bbo);
+
+    // 定点数的总盈亏不依赖开仓成本的分摊方式，必须与精确值完全相等
+    const auto exact_total_pnl = (cash * 2 + fixed_position.position_ * (bbo->bid_price_ + bbo->ask_price_)) * (Trading::PNL_SCALE / 2);
+    ASSERT(fixed_position.fixedTotalPnl() == exact_total_pnl,
+           "定点数总盈亏不精确：" + std::to_string(fixed_position.fixedTotalPnl()) + " != " + std::to_string(exact_total_pnl));
+  }
+  ASSERT(fixed_position.position_ == double_position.position_ && fixed_position.position_, "持仓不一致");
+
+  const auto exact_total_pnl = static_cast<double>(fixed_position.fixedTotalPnl()) / Trading::PNL_SCALE;
+  std::cout << "TOTAL PNL AFTER " << loop_count << " FILLS EXACT:" << std::fixed << exact_total_pnl
+            << " FIXED-POINT ERROR:" << (fixed_position.totalPnl() - exact_total_pnl)
+            << " DOUBLE ERROR:" << (double_position.total_pnl_ - exact_total_pnl) << std::defaultfloat << std::endl;
+
+  // 保持最终持仓，连续处理全部盘口变化，测量每次盘口变化重新计算未实现盈亏和总盈亏的平均开销
+  auto start = Common::rdtsc();
+  for (const auto &bbo: bbos)
+    changed_sink = double_position.updateBBO(&bbo);
+  const auto double_rdtsc = Common::rdtsc() - start;
+
+  // 定点数实现只在读取时计算盈亏：分别测量只更新盘口，以及每次盘口变化后都读取总盈亏（如每个tick都执行风险检查）的开销
+  start = Common::rdtsc();
+  for (const auto &bbo: bbos)
+    fixed_position.updateBBO(&bbo);
+  const auto lazy_rdtsc = Common::rdtsc() - start;
+
+  start = Common::rdtsc();
+  for (const auto &bbo: bbos) {
+    fixed_position.updateBBO(&bbo);
+    pnl_sink = fixed_position.fixedTotalPnl();
+  }
+  const auto lazy_read_rdtsc = Common::rdtsc() - start;
+
+  std::cout << "DOUBLE UPDATE-BBO PNL " << (double_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::cout << "FIXED-POINT LAZY UPDATE-BBO PNL " << (lazy_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::cout << "FIXED-POINT LAZY UPDATE-BBO PNL WITH READ " << (lazy_read_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,182 @@
+#include <map>
+
+#include "market_data/market_data_recovery.h"
+
+static constexpr size_t num_snapshot_orders = 20000;
+static constexpr size_t num_incrementals = 10000;
+
+// 原 MarketDataConsumer 中基于 std::map 的恢复实现，每条消息后重新扫描全部已排队消息
+// 省略了扫描循环中逐条消息的日志，否则日志开销会掩盖数据结构本身的差异
+class MapMarketDataRecovery {
+public:
+  MapMarketDataRecovery(Exchange::MEMarketUpdateLFQueue *market_updates, BinLogger *logger)
+      : incoming_md_updates_(market_updates), logger_(logger) {
+  }
+
+  auto queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate *request) -> bool {
+    if (is_snapshot) {
+      if (snapshot_queued_msgs_.find(request->seq_num_) != snapshot_queued_msgs_.end())
+        snapshot_queued_msgs_.clear();
+      snapshot_queued_msgs_[request->seq_num_] = request->me_market_update_;
+    } else {
+      incremental_queued_msgs_[request->seq_num_] = request->me_market_update_;
+    }
+
+    logger_->log("%:% %() % size snapshot:% incremental:% % => %\n", __FILE__, __LINE__, __FUNCTION__,
+                 Common::getCurrentLogTime(), snapshot_queued_msgs_.size(), incremental_queued_msgs_.size(), request->seq_num_, request->toString());
+
+    return checkSnapshotSync();
+  }
+
+  size_t next_exp_inc_seq_num_ = 0;
+
+private:
+  auto checkSnapshotSync() -> bool {
+    if (snapshot_queued_msgs_.empty())
+      return false;
+
+    if (snapshot_queued_msgs_.begin()->second.type_ != Exchange::MarketUpdateType::SNAPSHOT_START) {
+      snapshot_queued_msgs_.clear();
+      return false;
+    }
+
+    std::vector<Exchange::MEMarketUpdate> final_events;
+
+    size_t next_snapshot_seq = 0;
+    for (auto &snapshot_itr: snapshot_queued_msgs_) {
+      if (snapshot_itr.first != next_snapshot_seq) {
+        snapshot_queued_msgs_.clear();
+        return false;
+      }
+      if (snapshot_itr.second.type_ != Exchange::MarketUpdateType::SNAPSHOT_START &&
+          snapshot_itr.second.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
+        final_events.push_back(snapshot_itr.second);
+      ++next_snapshot_seq;
+    }
+
+    const auto &last_snapshot_msg = snapshot_queued_msgs_.rbegin()->second;
+    if (last_snapshot_msg.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
+      return false;
+
+    next_exp_inc_seq_num_ = last_snapshot_msg.order_id_ + 1;
+    for (auto inc_itr = incremental_queued_msgs_.begin(); inc_itr != incremental_queued_msgs_.end(); ++inc_itr) {
+      if (inc_itr->first < next_exp_inc_seq_num_)
+        continue;
+      if (inc_itr->first != next_exp_inc_seq_num_) {
+        snapshot_queued_msgs_.clear();
+        return false;
+      }
+      if (inc_itr->second.type_ != Exchange::MarketUpdateType::SNAPSHOT_START &&
+          inc_itr->second.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
+        final_events.push_back(inc_itr->second);
+      ++next_exp_inc_seq_num_;
+    }
+
+    for (const auto &itr: final_events) {
+      auto next_write = incoming_md_updates_->getNextToWriteTo();
+      *next_write = itr;
+      incoming_md_updates_->updateWriteIndex();
+    }
+
+    snapshot_queued_msgs_.clear();
+    incremental_queued_msgs_.clear();
+    return true;
+  }
+
+  Exchange::MEMarketUpdateLFQueue *incoming_md_updates_ = nullptr;
+  BinLogger *logger_ = nullptr;
+
+  std::map<size_t, Exchange::MEMarketUpdate> snapshot_queued_msgs_, incremental_queued_msgs_;
+};
+
+// 按到达顺序回放消息直到恢复完成，返回每条消息的平均时钟周期数
+template<typename T>
+size_t benchmarkRecovery(T *recovery, const std::vector<std::pair<bool, Exchange::MDPMarketUpdate>> &messages) {
+  size_t total_rdtsc = 0, num_messages = 0;
+  for (const auto &message: messages) {
+    const auto start = Common::rdtsc();
+    const auto recovered = recovery->queueMessage(message.first, &message.second);
+    total_rdtsc += (Common::rdtsc() - start);
+    ++num_messages;
+    if (recovered)
+      break;
+  }
+  return (total_rdtsc / num_messages);
+}
+
+auto drain(Exchange::MEMarketUpdateLFQueue *market_updates) {
+  std::vector<Exchange::MEMarketUpdate> events;
+  for (auto market_update = market_updates->getNextToRead(); market_update; market_update = market_updates->getNextToRead()) {
+    events.push_back(*market_update);
+    market_updates->updateReadIndex();
+  }
+  return events;
+}
+
+int main(int, char **) {
+  srand(0);
+
+  Common::BinLogger logger("recovery_benchmark.log");
+
+  // 快照对应的最后一个增量序列号，增量积压从其之前开始，部分增量已被快照包含
+  const size_t last_inc_seq_num = 1000000;
+  const size_t first_inc_seq_num = last_inc_seq_num - num_incrementals / 10;
+
+  auto make_update = [](Exchange::MarketUpdateType type, OrderId order_id) {
+    return Exchange::MEMarketUpdate{type, order_id, static_cast<TickerId>(rand() % ME_MAX_TICKERS),
+                                    (rand() % 2 ? Side::BUY : Side::SELL), static_cast<Price>(100 + rand() % 100),
+                                    static_cast<Qty>(1 + rand() % 100), static_cast<Priority>(1 + rand() % 10)};
+  };
+
+  std::vector<Exchange::MDPMarketUpdate> snapshot, incrementals;
+  snapshot.push_back({0, {Exchange::MarketUpdateType::SNAPSHOT_START, last_inc_seq_num}});
+  for (size_t i = 0; i < num_snapshot_orders; ++i)
+    snapshot.push_back({snapshot.size(), make_update(Exchange::MarketUpdateType::ADD, i)});
+  snapshot.push_back({snapshot.size(), {Exchange::MarketUpdateType::SNAPSHOT_END, last_inc_seq_num}});
+  for (size_t i = 0; i < num_incrementals; ++i)
+    incrementals.push_back({first_inc_seq_num + i, make_update(Exchange::MarketUpdateType::ADD, num_snapshot_orders + i)});
+
+  // 增量流与快照流交错到达，增量流中偶有相邻消息乱序
+  std::vector<std::pair<bool, Exchange::MDPMarketUpdate>> messages;
+  for (size_t i = 0, j = 0; i < snapshot.size() || j < incrementals.size();) {
+    if (i < snapshot.size() && (j == incrementals.size() || rand() % 3)) {
+      messages.push_back({true, snapshot[i++]});
+    } else {
+      if (j + 1 < incrementals.size() && rand() % 100 == 0) {
+        messages.push_back({false, incrementals[j + 1]});
+        messages.push_back({false, incrementals[j]});
+        j += 2;
+      } else {
+        messages.push_back({false, incrementals[j++]});
+      }
+    }
+  }
+
+  Exchange::MEMarketUpdateLFQueue map_market_updates(ME_MAX_MARKET_UPDATES), ring_market_updates(ME_MAX_MARKET_UPDATES);
+
+  size_t map_next_exp = 0, ring_next_exp = 0;
+  {
+    auto recovery = new MapMarketDataRecovery(&map_market_updates, &logger);
+    const auto cycles = benchmarkRecovery(recovery, messages);
+    map_next_exp = recovery->next_exp_inc_seq_num_;
+    std::cout << "STD::MAP RECOVERY " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
+  }
+
+  {
+    auto recovery = new Trading::MarketDataRecovery(&ring_market_updates, &logger);
+    recovery->reset();
+    const auto cycles = benchmarkRecovery(recovery, messages);
+    ring_next_exp = recovery->nextExpIncSeqNum();
+    std::cout << "SEQ-RING RECOVERY " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
+  }
+
+  // 两种实现恢复出的事件序列和下一个期望序列号必须一致
+  const auto map_events = drain(&map_market_updates), ring_events = drain(&ring_market_updates);
+  ASSERT(map_next_exp == ring_next_exp, "下一个期望序列号不一致 map:" + std::to_string(map_next_exp) + " ring:" + std::to_string(ring_next_exp));
+  ASSERT(map_events.size() == ring_events.size() && !map_events.empty(),
+         "恢复事件数不一致 map:" + std::to_string(map_events.size()) + " ring:" + std::to_string(ring_events.size()));
+  for (size_t i = 0; i < map_events.size(); ++i)
+    ASSERT(!memcmp(&map_events[i], &ring_events[i], sizeof(Exchange::MEMarketUpdate)), "恢复事件不一致：" + ring_events[i].toString());
+
+  exit(EXIT_SUCCESS);
+}
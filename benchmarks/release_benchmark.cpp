@@ -1,9 +1,62 @@
+#include <algorithm>
+
 #include "common/mem_pool.h"
-#include "common/opt_mem_pool.h"
 #include "common/perf_utils.h"
 
 #include "exchange/market_data/market_update.h"
 
+static constexpr size_t churn_pool_size = 256 * 1024;
+static constexpr size_t churn_count = 1000000;
+
+// 原 MemPool 的实现：每次分配后从上次的位置线性扫描下一个空闲块，池接近占满时扫描距离随占用率增长
+template<typename T>
+class ScanMemPool final {
+public:
+  explicit ScanMemPool(std::size_t num_elems) :
+      store_(num_elems, {T(), true}) {
+  }
+
+  template<typename... Args>
+  T *allocate(Args... args) noexcept {
+    auto obj_block = &(store_[next_free_index_]);
+    T *ret = &(obj_block->object_);
+    ret = new(ret) T(args...);
+    obj_block->is_free_ = false;
+
+    updateNextFreeIndex();
+
+    return ret;
+  }
+
+  auto deallocate(const T *elem) noexcept {
+    const auto elem_index = (reinterpret_cast<const ObjectBlock *>(elem) - &store_[0]);
+    store_[elem_index].is_free_ = true;
+  }
+
+private:
+  auto updateNextFreeIndex() noexcept {
+    const auto initial_free_index = next_free_index_;
+    while (!store_[next_free_index_].is_free_) {
+      ++next_free_index_;
+      if (UNLIKELY(next_free_index_ == store_.size())) {
+        next_free_index_ = 0;
+      }
+      if (UNLIKELY(initial_free_index == next_free_index_)) {
+        FATAL("Memory Pool out of space.");
+      }
+    }
+  }
+
+  struct ObjectBlock {
+    T object_;
+    bool is_free_ = true;
+  };
+
+  std::vector<ObjectBlock> store_;
+
+  size_t next_free_index_ = 0;
+};
+
 template<typename T>
 size_t benchmarkMemPool(T *mem_pool) {
   constexpr size_t loop_count = 100000;
@@ -26,17 +79,63 @@ size_t benchmarkMemPool(T *mem_pool) {
   return (total_rdtsc / (loop_count * allocated_objs.size()));
 }
 
+// 模拟大量挂单的订单簿：先按 occupancy 占满内存池，再反复释放一个随机的存活对象并分配一个新对象，
+// 使空闲块随机分散在整个池中，返回每对释放和分配的平均时钟周期数
+template<typename T>
+size_t benchmarkChurn(T *mem_pool, double occupancy, const std::vector<size_t> &victims) {
+  std::vector<Exchange::MDPMarketUpdate *> live_objs(static_cast<size_t>(churn_pool_size * occupancy));
+  for (size_t i = 0; i < live_objs.size(); ++i) {
+    live_objs[i] = mem_pool->allocate();
+    live_objs[i]->seq_num_ = i;
+  }
+
+  const auto start = Common::rdtsc();
+  for (size_t i = 0; i < churn_count; ++i) {
+    auto &obj = live_objs[victims[i] % live_objs.size()];
+    mem_pool->deallocate(obj);
+    obj = mem_pool->allocate();
+    obj->seq_num_ = i;
+  }
+  const auto total_rdtsc = Common::rdtsc() - start;
+
+  // 存活对象的地址必须互不相同，即没有块被重复分配
+  std::sort(live_objs.begin(), live_objs.end());
+  ASSERT(std::adjacent_find(live_objs.begin(), live_objs.end()) == live_objs.end(), "内存池重复分配了同一个块");
+
+  return (total_rdtsc / churn_count);
+}
+
 int main(int, char **) {
+  {
+    ScanMemPool<Exchange::MDPMarketUpdate> scan_mem_pool(512);
+    const auto cycles = benchmarkMemPool(&scan_mem_pool);
+    std::cout << "SCAN MEMPOOL " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
+  }
+
   {
     Common::MemPool<Exchange::MDPMarketUpdate> mem_pool(512);
     const auto cycles = benchmarkMemPool(&mem_pool);
-    std::cout << "ORIGINAL MEMPOOL " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
+    std::cout << "FREE-LIST MEMPOOL " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
   }
 
-  {
-    OptCommon::OptMemPool<Exchange::MDPMarketUpdate> opt_mem_pool(512);
-    const auto cycles = benchmarkMemPool(&opt_mem_pool);
-    std::cout << "OPTIMIZED MEMPOOL " << cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
+  // 预先生成随机释放的对象，使两种内存池处理完全相同的释放和分配序列
+  srand(0);
+  std::vector<size_t> victims(churn_count);
+  for (auto &victim: victims)
+    victim = static_cast<size_t>(rand());
+
+  for (const auto occupancy: {0.5, 0.9, 0.99}) {
+    {
+      ScanMemPool<Exchange::MDPMarketUpdate> scan_mem_pool(churn_pool_size);
+      std::cout << "SCAN MEMPOOL CHURN AT " << occupancy * 100 << "% OCCUPANCY "
+                << benchmarkChurn(&scan_mem_pool, occupancy, victims) << " CLOCK CYCLES PER DEALLOCATE+ALLOCATE." << std::endl;
+    }
+
+    {
+      Common::MemPool<Exchange::MDPMarketUpdate> mem_pool(churn_pool_size);
+      std::cout << "FREE-LIST MEMPOOL CHURN AT " << occupancy * 100 << "% OCCUPANCY "
+                << benchmarkChurn(&mem_pool, occupancy, victims) << " CLOCK CYCLES PER DEALLOCATE+ALLOCATE." << std::endl;
+    }
   }
 
   exit(EXIT_SUCCESS);
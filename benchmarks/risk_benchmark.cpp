@@ -0,0 +1,149 @@
+#include "strategy/risk_manager.h"
+
+static constexpr size_t loop_count = 100000;
+
+// 用于防止编译器优化掉被测量的风险检查
+volatile Trading::RiskCheckResult result_sink = Trading::RiskCheckResult::INVALID;
+
+// 不做增量维护时的组合名义金额检查：每次检查都遍历全部股票重新汇总持仓和在途订单的名义金额
+Trading::RiskCheckResult checkByRecompute(const Trading::RiskManager *risk_manager, const PortfolioRiskCfg &portfolio_risk_cfg,
+                                          TickerId ticker_id, Side side, Price price, Qty qty) {
+  double gross_notional = 0, net_notional = 0;
+  for (TickerId i = 0; i < ME_MAX_TICKERS; ++i) {
+    const auto risk_info = risk_manager->getRiskInfo(i);
+    gross_notional += std::abs(risk_info->position_notional_) +
+                      risk_info->working_notional_[sideToIndex(Side::BUY)] + risk_info->working_notional_[sideToIndex(Side::SELL)];
+    net_notional += risk_info->position_notional_ +
+                    risk_info->working_notional_[sideToIndex(Side::BUY)] - risk_info->working_notional_[sideToIndex(Side::SELL)];
+  }
+  return risk_manager->getRiskInfo(ticker_id)->checkPreTradeRisk(side, price, qty, gross_notional, net_notional, portfolio_risk_cfg);
+}
+
+// 校验增量维护的组合名义金额与重新汇总的结果一致
+void checkAggregates(const Trading::RiskManager *risk_manager) {
+  double gross_notional = 0, net_notional = 0;
+  for (TickerId i = 0; i < ME_MAX_TICKERS; ++i) {
+    const auto risk_info = risk_manager->getRiskInfo(i);
+    gross_notional += std::abs(risk_info->position_notional_) +
+                      risk_info->working_notional_[sideToIndex(Side::BUY)] + risk_info->working_notional_[sideToIndex(Side::SELL)];
+    net_notional += risk_info->position_notional_ +
+                    risk_info->working_notional_[sideToIndex(Side::BUY)] - risk_info->working_notional_[sideToIndex(Side::SELL)];
+  }
+  ASSERT(gross_notional == risk_manager->grossNotional() && net_notional == risk_manager->netNotional(),
+         "组合名义金额不一致 gross:" + std::to_string(risk_manager->grossNotional()) + " net:" + std::to_string(risk_manager->netNotional()));
+}
+
+// 校验在途订单计入持仓检查，以及组合总名义金额和净名义金额的限制
+void checkLimits(Common::BinLogger *logger) {
+  Trading::PositionKeeper position_keeper(logger);
+  TradeEngineCfgHashMap ticker_cfg;
+  for (auto &cfg: ticker_cfg)
+    cfg = {10, 0, {100, 300, -1000000}};
+  const PortfolioRiskCfg portfolio_risk_cfg{100000, 50000};
+  Trading::RiskManager risk_manager(logger, &position_keeper, ticker_cfg, portfolio_risk_cfg);
+
+  // 持仓为0时，同方向的在途订单使最坏情况下的持仓超过限制
+  ASSERT(risk_manager.checkPreTradeRisk(0, Side::BUY, 100, 100) == Trading::RiskCheckResult::ALLOWED, "订单应通过风险检查");
+  risk_manager.addWorkingQty(0, Side::BUY, 100, 100);
+  risk_manager.addWorkingQty(0, Side::BUY, 99, 100);
+  risk_manager.addWorkingQty(0, Side::BUY, 98, 100);
+  ASSERT(risk_manager.checkPreTradeRisk(0, Side::BUY, 97, 100) == Trading::RiskCheckResult::POSITION_TOO_LARGE, "在途订单应计入持仓检查");
+  ASSERT(risk_manager.checkPreTradeRisk(0, Side::SELL, 101, 100) == Trading::RiskCheckResult::ALLOWED, "反方向的在途订单不应计入持仓检查");
+
+  // 成交使在途敞口转为持仓，持仓加上剩余的在途订单仍受持仓限制
+  const Exchange::MEClientResponse fill{Exchange::ClientResponseType::FILLED, 1, 0, 1, 1, Side::BUY, 100, 100, 0};
+  position_keeper.addFill(&fill);
+  risk_manager.onFill(0, 100);
+  risk_manager.removeWorkingQty(0, Side::BUY, 100, 100);
+  ASSERT(risk_manager.getRiskInfo(0)->working_qty_[sideToIndex(Side::BUY)] == 200, "在途数量不正确");
+  ASSERT(risk_manager.checkPreTradeRisk(0, Side::BUY, 97, 100) == Trading::RiskCheckResult::POSITION_TOO_LARGE, "成交后持仓加在途订单应超过限制");
+  checkAggregates(&risk_manager);
+
+  // 终止剩余的在途订单后允许再次下单
+  risk_manager.removeWorkingQty(0, Side::BUY, 99, 100);
+  risk_manager.removeWorkingQty(0, Side::BUY, 98, 100);
+  ASSERT(risk_manager.checkPreTradeRisk(0, Side::BUY, 97, 100) == Trading::RiskCheckResult::ALLOWED, "订单应通过风险检查");
+
+  // 总名义金额 = 10000（持仓） + 在途买卖订单，净名义金额中买卖方向相互抵消
+  risk_manager.addWorkingQty(1, Side::SELL, 200, 200);  // gross 50000 net -30000
+  risk_manager.addWorkingQty(2, Side::BUY, 200, 200);   // gross 90000 net 10000
+  checkAggregates(&risk_manager);
+  ASSERT(risk_manager.grossNotional() == 90000 && risk_manager.netNotional() == 10000, "组合名义金额不正确");
+  ASSERT(risk_manager.checkPreTradeRisk(3, Side::SELL, 100, 100) == Trading::RiskCheckResult::ALLOWED, "订单应通过风险检查");
+  ASSERT(risk_manager.checkPreTradeRisk(3, Side::SELL, 200, 100) == Trading::RiskCheckResult::GROSS_NOTIONAL_TOO_LARGE, "应超过组合总名义金额限制");
+
+  risk_manager.removeWorkingQty(1, Side::SELL, 200, 200);  // gross 50000 net 50000
+  ASSERT(risk_manager.checkPreTradeRisk(3, Side::BUY, 10, 10) == Trading::RiskCheckResult::NET_NOTIONAL_TOO_LARGE, "应超过组合净名义金额限制");
+  ASSERT(risk_manager.checkPreTradeRisk(3, Side::SELL, 10, 10) == Trading::RiskCheckResult::ALLOWED, "减少净敞口的订单应通过风险检查");
+  checkAggregates(&risk_manager);
+}
+
+int main(int, char **) {
+  srand(0);
+
+  Common::BinLogger logger("risk_benchmark.log");
+
+  checkLimits(&logger);
+
+  Trading::PositionKeeper position_keeper(&logger);
+  TradeEngineCfgHashMap ticker_cfg;
+  for (auto &cfg: ticker_cfg)
+    cfg = {10, 0, {1000, 1000000, -1000000000}};
+  const PortfolioRiskCfg portfolio_risk_cfg{1e12, 1e12};
+  Trading::RiskManager risk_manager(&logger, &position_keeper, ticker_cfg, portfolio_risk_cfg);
+
+  // 预先生成随机订单，使测量只包含风险检查和增量更新本身
+  struct Order {
+    TickerId ticker_id_;
+    Side side_;
+    Price price_;
+    Qty qty_;
+  };
+  std::vector<Order> orders(loop_count);
+  for (auto &order: orders)
+    order = {static_cast<TickerId>(rand() % ME_MAX_TICKERS), (rand() % 2 ? Side::BUY : Side::SELL),
+             static_cast<Price>(100 + rand() % 100), static_cast<Qty>(1 + rand() % 100)};
+
+  // 每个股票保持若干在途订单和持仓
+  for (size_t i = 0; i < 64; ++i)
+    risk_manager.addWorkingQty(orders[i].ticker_id_, orders[i].side_, orders[i].price_, orders[i].qty_);
+  for (TickerId i = 0; i < ME_MAX_TICKERS; ++i) {
+    const Exchange::MEClientResponse fill{Exchange::ClientResponseType::FILLED, 1, i, 1, 1, Side::BUY, 150, 10, 0};
+    position_keeper.addFill(&fill);
+    risk_manager.onFill(i, fill.price_);
+  }
+  checkAggregates(&risk_manager);
+
+  size_t check_rdtsc = 0, recompute_rdtsc = 0, update_rdtsc = 0, fill_rdtsc = 0;
+  for (const auto &order: orders) {
+    auto start = Common::rdtsc();
+    result_sink = risk_manager.checkPreTradeRisk(order.ticker_id_, order.side_, order.price_, order.qty_);
+    check_rdtsc += (Common::rdtsc() - start);
+
+    start = Common::rdtsc();
+    result_sink = checkByRecompute(&risk_manager, portfolio_risk_cfg, order.ticker_id_, order.side_, order.price_, order.qty_);
+    recompute_rdtsc += (Common::rdtsc() - start);
+
+    ASSERT(risk_manager.checkPreTradeRisk(order.ticker_id_, order.side_, order.price_, order.qty_) ==
+           checkByRecompute(&risk_manager, portfolio_risk_cfg, order.ticker_id_, order.side_, order.price_, order.qty_),
+           "增量维护与重新汇总的风险检查结果不一致");
+
+    // 发送新订单和订单终止各一次增量更新
+    start = Common::rdtsc();
+    risk_manager.addWorkingQty(order.ticker_id_, order.side_, order.price_, order.qty_);
+    risk_manager.removeWorkingQty(order.ticker_id_, order.side_, order.price_, order.qty_);
+    update_rdtsc += (Common::rdtsc() - start);
+
+    start = Common::rdtsc();
+    risk_manager.onFill(order.ticker_id_, order.price_);
+    fill_rdtsc += (Common::rdtsc() - start);
+  }
+  checkAggregates(&risk_manager);
+
+  std::cout << "INCREMENTAL PRE-TRADE RISK CHECK " << (check_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::cout << "RECOMPUTE PRE-TRADE RISK CHECK " << (recompute_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::cout << "WORKING ORDER ADD+REMOVE " << (update_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+  std::cout << "POSITION NOTIONAL UPDATE " << (fill_rdtsc / loop_count) << " CLOCK CYCLES PER OPERATION." << std::endl;
+
+  exit(EXIT_SUCCESS);
+}
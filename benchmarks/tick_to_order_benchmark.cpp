@@ -0,0 +1,108 @@
+#include "strategy/trade_engine.h"
+
+static constexpr size_t loop_count = 50000;
+static constexpr size_t fill_interval = 10;
+
+// 模拟交易所对交易引擎发出的请求立即确认：新订单返回 ACCEPTED，撤单返回 CANCELED
+// 每 fill_interval 个新订单有一个随后全部成交，使成交回报经策略实例更新持仓和风险管理器
+template<typename AlgoT>
+void respondToRequests(Trading::TradeEngine *trade_engine, Exchange::ClientRequestLFQueue *client_requests, size_t *num_new_orders) {
+  for (auto request = client_requests->getNextToRead(); request; request = client_requests->getNextToRead()) {
+    const auto is_new = (request->type_ == Exchange::ClientRequestType::NEW);
+    const Exchange::MEClientResponse response{(is_new ? Exchange::ClientResponseType::ACCEPTED : Exchange::ClientResponseType::CANCELED),
+                                              request->client_id_, request->ticker_id_, request->order_id_, request->order_id_,
+                                              request->side_, request->price_, 0, request->qty_};
+    trade_engine->processClientResponse<AlgoT>(&response);
+
+    if (is_new && ++*num_new_orders % fill_interval == 0) {
+      const Exchange::MEClientResponse fill{Exchange::ClientResponseType::FILLED, request->client_id_, request->ticker_id_,
+                                            request->order_id_, request->order_id_, request->side_, request->price_, request->qty_, 0};
+      trade_engine->processClientResponse<AlgoT>(&fill);
+    }
+    client_requests->updateReadIndex();
+  }
+}
+
+// 买一价在两个价位之间来回变化，每个 tick 都会使做市算法移动其买单（撤单或下新单）
+// 经由与生产环境相同的路径（交易引擎 -> 策略实例 -> 交易算法）测量从收到市场数据更新到订单请求写入订单网关队列的时钟周期数
+// AlgoT 为策略实例调用交易算法的方式：MarketMaker 编译期绑定，void 每个策略实例运行期选择，DynamicAlgo 经由函数包装器
+template<typename AlgoT>
+size_t benchmarkTickToOrder(size_t num_strategies, size_t *num_orders, Qty *volume) {
+  Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
+  Exchange::ClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
+  Exchange::MEMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
+
+  // 做市算法每次报1股，阈值为0时始终跟随买一价
+  Common::TradeEngineCfgHashMap ticker_cfg;
+  ticker_cfg.at(0) = {1, 0, {100, 1000000, -1000000000}};
+  const std::vector<Common::StrategyCfg> strategy_cfgs(num_strategies, Common::StrategyCfg{AlgoType::MAKER, ticker_cfg, {}});
+  auto trade_engine = new Trading::TradeEngine(1, strategy_cfgs, &client_requests, &client_responses, &market_updates);
+
+  // 初始盘口 99 X 101
+  size_t num_new_orders = 0;
+  for (const auto &market_update: {Exchange::MEMarketUpdate{Exchange::MarketUpdateType::ADD, 1, 0, Side::BUY, 99, 10, 1},
+                                   Exchange::MEMarketUpdate{Exchange::MarketUpdateType::ADD, 2, 0, Side::SELL, 101, 10, 2}}) {
+    trade_engine->processMarketUpdate<AlgoT>(&market_update);
+    respondToRequests<AlgoT>(trade_engine, &client_requests, &num_new_orders);
+  }
+
+  size_t total_rdtsc = 0;
+  for (size_t i = 0; i < loop_count; ++i) {
+    const Exchange::MEMarketUpdate market_update{(i % 2 ? Exchange::MarketUpdateType::CANCEL : Exchange::MarketUpdateType::ADD),
+                                                 3, 0, Side::BUY, 100, 10, 3};
+
+    const auto start = Common::rdtsc();
+    trade_engine->processMarketUpdate<AlgoT>(&market_update);
+    total_rdtsc += (Common::rdtsc() - start);
+
+    *num_orders += client_requests.size();
+    respondToRequests<AlgoT>(trade_engine, &client_requests, &num_new_orders);
+  }
+
+  for (size_t i = 0; i < num_strategies; ++i)
+    *volume += trade_engine->strategy(i)->positionKeeper()->getPositionInfo(0)->volume_;
+
+  delete trade_engine;
+
+  return (total_rdtsc / loop_count);
+}
+
+static constexpr size_t num_rounds = 5;
+
+// 运行一种调用方式的测量，并检查每个策略实例对每个 tick 都发出订单请求，成交回报经策略实例计入持仓管理器
+// 返回各轮中最少的时钟周期数，避免首轮的缺页和缓存预热等一次性开销
+template<typename AlgoT>
+size_t runBenchmark(size_t num_strategies, size_t *num_orders) {
+  size_t min_cycles = std::numeric_limits<size_t>::max();
+  for (size_t round = 0; round < num_rounds; ++round) {
+    size_t round_orders = 0;
+    Qty volume = 0;
+    min_cycles = std::min(min_cycles, benchmarkTickToOrder<AlgoT>(num_strategies, &round_orders, &volume));
+    ASSERT(round_orders >= loop_count * num_strategies && volume > 0,
+           "订单请求数或成交量不符合预期 orders:" + std::to_string(round_orders) + " volume:" + std::to_string(volume));
+    *num_orders = round_orders;
+  }
+  return min_cycles;
+}
+
+int main(int argc, char **) {
+  // 默认关闭日志，只比较分发路径本身；任意参数时开启日志，测量包含记录日志的完整路径
+  Common::BinLogger::setEnabled(argc > 1);
+
+  for (const size_t num_strategies: {1, 4}) {
+    size_t static_orders = 0, selected_orders = 0, dynamic_orders = 0;
+    const auto static_cycles = runBenchmark<Trading::MarketMaker>(num_strategies, &static_orders);
+    const auto selected_cycles = runBenchmark<void>(num_strategies, &selected_orders);
+    const auto dynamic_cycles = runBenchmark<Trading::DynamicAlgo>(num_strategies, &dynamic_orders);
+
+    std::cout << num_strategies << " MAKER STRATEGIES TICK-TO-ORDER STATIC " << static_cycles << " RUNTIME-SELECTED " << selected_cycles
+              << " STD::FUNCTION " << dynamic_cycles << " CLOCK CYCLES PER OPERATION." << std::endl;
+
+    // 三种调用方式驱动的是同一个交易算法，发出的订单请求数必须相同
+    ASSERT(static_orders == selected_orders && static_orders == dynamic_orders,
+           "不同调用方式的订单请求数不一致 static:" + std::to_string(static_orders) + " selected:" + std::to_string(selected_orders) +
+           " dynamic:" + std::to_string(dynamic_orders));
+  }
+
+  exit(EXIT_SUCCESS);
+}
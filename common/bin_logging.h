@@ -0,0 +1,596 @@
+#pragma once
+
+#include <new>
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+
+#include "macros.h"
+#include "lf_queue.h"
+#include "thread_utils.h"
+#include "time_utils.h"
+
+namespace Common {
+  /// Number of chunks in the lock free queue of records to be logged.
+  constexpr size_t BIN_LOG_QUEUE_SIZE = 1024 * 1024;
+
+  /// Type of an argument recorded by BinLogger, scalars are recorded as their raw bytes after integral promotion.
+  enum class BinLogType : uint8_t {
+    CHAR = 0,
+    INTEGER = 1,
+    LONG_INTEGER = 2,
+    LONG_LONG_INTEGER = 3,
+    UNSIGNED_INTEGER = 4,
+    UNSIGNED_LONG_INTEGER = 5,
+    UNSIGNED_LONG_LONG_INTEGER = 6,
+    FLOAT = 7,
+    DOUBLE = 8,
+    STRING = 9, /// uint32_t length followed by the characters, without a terminating null.
+    TIMESTAMP = 10, /// LogTime, formatted like getCurrentTimeStr().
+    OBJECT = 11, /// BinLogObjectFormatter followed by the raw bytes of a BinLogObject, only in the queue and never in a binary log file.
+    MAX = 12 /// Terminates the argument type list of a format.
+  };
+
+  /// Object with a toString() member which BinLogger copies into the record as raw bytes and converts on the background thread.
+  /// Types whose toString() follows pointers into structures the logging thread keeps modifying opt out with a
+  /// BIN_LOG_AS_STRING member and are converted on the logging thread instead.
+  template<typename T>
+  concept BinLogObject = std::is_class_v<T> && std::is_trivially_copyable_v<T> && requires(const T &value) { value.toString(); } &&
+                         !requires { T::BIN_LOG_AS_STRING; };
+
+  /// Type an argument of type T is recorded as, resolved at compile time.
+  template<typename T>
+  consteval auto binLogTypeOf() noexcept -> BinLogType {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, char>) {
+      return BinLogType::CHAR;
+    } else if constexpr (std::is_same_v<U, int>) {
+      return BinLogType::INTEGER;
+    } else if constexpr (std::is_same_v<U, long>) {
+      return BinLogType::LONG_INTEGER;
+    } else if constexpr (std::is_same_v<U, long long>) {
+      return BinLogType::LONG_LONG_INTEGER;
+    } else if constexpr (std::is_same_v<U, unsigned>) {
+      return BinLogType::UNSIGNED_INTEGER;
+    } else if constexpr (std::is_same_v<U, unsigned long>) {
+      return BinLogType::UNSIGNED_LONG_INTEGER;
+    } else if constexpr (std::is_same_v<U, unsigned long long>) {
+      return BinLogType::UNSIGNED_LONG_LONG_INTEGER;
+    } else if constexpr (std::is_same_v<U, float>) {
+      return BinLogType::FLOAT;
+    } else if constexpr (std::is_same_v<U, double>) {
+      return BinLogType::DOUBLE;
+    } else if constexpr (std::is_same_v<U, std::string> || std::is_same_v<U, const char *> || std::is_same_v<U, char *>) {
+      return BinLogType::STRING;
+    } else if constexpr (std::is_same_v<U, LogTime>) {
+      return BinLogType::TIMESTAMP;
+    } else if constexpr (BinLogObject<U>) {
+      return BinLogType::OBJECT;
+    } else if constexpr (std::is_integral_v<U>) {
+      return binLogTypeOf<decltype(+std::declval<U>())>(); // bool, short and the other small integers, as pushed by Logger.
+    } else {
+      static_assert(sizeof(U) == 0, "Unsupported BinLogger argument type.");
+    }
+  }
+
+  /// Argument types of a format, terminated by BinLogType::MAX. The address identifies the argument list.
+  template<typename... A>
+  inline constexpr BinLogType BIN_LOG_ARG_TYPES[] = {binLogTypeOf<A>()..., BinLogType::MAX};
+
+  /// The BinLogType::MAX terminating an argument type list.
+  inline auto binLogArgTypesEnd(const BinLogType *arg_types) noexcept {
+    while (*arg_types != BinLogType::MAX) {
+      ++arg_types;
+    }
+    return arg_types;
+  }
+
+  /// Not constexpr, so that calling it from BinLogFormat's constructor fails compilation.
+  inline void binLogFormatArgumentCountMismatch() noexcept {
+  }
+
+  /// Format string of a BinLogger::log() call with arguments of types A.
+  /// Constructed at compile time from a string literal, which is checked to have one % (%% is an escaped %) per argument.
+  /// The literal's address identifies the format at run time, so the format is never parsed on the logging thread.
+  template<typename... A>
+  class BinLogFormat {
+  public:
+    template<size_t N>
+    consteval BinLogFormat(const char (&format)[N]) : format_(format) {
+      size_t num_args = 0;
+      for (size_t i = 0; i + 1 < N; ++i) {
+        if (format[i] == '%') {
+          if (format[i + 1] == '%') {
+            ++i;
+          } else {
+            ++num_args;
+          }
+        }
+      }
+      if (num_args != sizeof...(A)) {
+        binLogFormatArgumentCountMismatch();
+      }
+    }
+
+    const char *format_ = nullptr;
+  };
+
+  /// Unit of space in BinLogger's queue, a record occupies one or more consecutive chunks.
+  struct alignas(64) BinLogChunk {
+    char data_[64];
+  };
+
+  /// Header at the start of each record in BinLogger's queue, the raw argument bytes follow immediately after.
+  struct BinLogRecordHeader {
+    const char *format_ = nullptr; /// nullptr for padding which skips the chunks up to the end of the queue.
+    const BinLogType *arg_types_ = nullptr;
+    uint32_t size_ = 0; /// Size of the record including this header.
+    uint32_t reserved_ = 0;
+  };
+
+  /// Magic number and format version at the start of every binary log file.
+  constexpr uint32_t BinLogFileMagic = 0x474f4c42; // "BLOG" when read as little-endian bytes.
+  constexpr uint16_t BinLogFileVersion = 3;
+
+  /// These structures are written to disk as-is, so pack them to eliminate system dependent padding.
+#pragma pack(push, 1)
+
+  /// Header at the start of a binary log file.
+  struct BinLogFileHeader {
+    uint32_t magic_ = BinLogFileMagic;
+    uint16_t version_ = BinLogFileVersion;
+    uint16_t reserved_ = 0;
+  };
+
+  enum class BinLogFileRecordType : uint8_t {
+    FORMAT = 0, /// Defines format_id_: the argument types terminated by BinLogType::MAX, then the format string.
+    ENTRY = 1 /// One log() call: the raw argument bytes of a format defined earlier in the file.
+  };
+
+  /// Length-prefix preceding each record in a binary log file, the payload of length_ bytes follows immediately after.
+  struct BinLogFileRecordHeader {
+    uint32_t length_ = 0;
+    uint32_t format_id_ = 0;
+    BinLogFileRecordType type_ = BinLogFileRecordType::ENTRY;
+  };
+
+#pragma pack(pop)
+
+  template<typename T>
+  inline auto formatBinLogScalar(std::ostream &os, const char *args) noexcept {
+    T value;
+    memcpy(&value, args, sizeof(value));
+    os << value;
+    return args + sizeof(value);
+  }
+
+  /// Converts the raw bytes of an object recorded as BinLogType::OBJECT at args to os, returns the start of the next argument.
+  typedef const char *(*BinLogObjectFormatter)(std::ostream &os, const char *args);
+
+  template<typename T>
+  inline auto formatBinLogObject(std::ostream &os, const char *args) -> const char * {
+    // The record only guarantees the alignment of its header, copy the object out before calling its toString().
+    alignas(T) char object[sizeof(T)];
+    memcpy(object, args, sizeof(T));
+    os << std::launder(reinterpret_cast<const T *>(object))->toString();
+    return args + sizeof(T);
+  }
+
+  /// Write the argument at args of the given type to os the same way Logger would, returns the start of the next argument.
+  inline auto formatBinLogArg(std::ostream &os, BinLogType type, const char *args) noexcept -> const char * {
+    switch (type) {
+      case BinLogType::CHAR:
+        os << *args;
+        return args + 1;
+      case BinLogType::INTEGER:
+        return formatBinLogScalar<int>(os, args);
+      case BinLogType::LONG_INTEGER:
+        return formatBinLogScalar<long>(os, args);
+      case BinLogType::LONG_LONG_INTEGER:
+        return formatBinLogScalar<long long>(os, args);
+      case BinLogType::UNSIGNED_INTEGER:
+        return formatBinLogScalar<unsigned>(os, args);
+      case BinLogType::UNSIGNED_LONG_INTEGER:
+        return formatBinLogScalar<unsigned long>(os, args);
+      case BinLogType::UNSIGNED_LONG_LONG_INTEGER:
+        return formatBinLogScalar<unsigned long long>(os, args);
+      case BinLogType::FLOAT:
+        return formatBinLogScalar<float>(os, args);
+      case BinLogType::DOUBLE:
+        return formatBinLogScalar<double>(os, args);
+      case BinLogType::STRING: {
+        uint32_t length;
+        memcpy(&length, args, sizeof(length));
+        os.write(args + sizeof(length), length);
+        return args + sizeof(length) + length;
+      }
+      case BinLogType::TIMESTAMP: {
+        LogTime value;
+        memcpy(&value, args, sizeof(value));
+        char time_str[TIME_STR_SIZE];
+        os << formatTimeStr(value.nanos_, time_str);
+        return args + sizeof(value);
+      }
+      case BinLogType::OBJECT: {
+        BinLogObjectFormatter formatter;
+        memcpy(&formatter, args, sizeof(formatter));
+        return formatter(os, args + sizeof(formatter));
+      }
+      case BinLogType::MAX:
+        break;
+    }
+
+    FATAL("Unknown BinLogType:" + std::to_string(static_cast<int>(type)));
+    return args;
+  }
+
+  /// Start of the argument after the one at args of the given type without formatting it, for any type other than BinLogType::OBJECT
+  /// whose size only its formatter knows.
+  inline auto nextBinLogArg(BinLogType type, const char *args) noexcept -> const char * {
+    switch (type) {
+      case BinLogType::CHAR:
+        return args + 1;
+      case BinLogType::INTEGER:
+      case BinLogType::UNSIGNED_INTEGER:
+        return args + sizeof(int);
+      case BinLogType::LONG_INTEGER:
+      case BinLogType::UNSIGNED_LONG_INTEGER:
+        return args + sizeof(long);
+      case BinLogType::LONG_LONG_INTEGER:
+      case BinLogType::UNSIGNED_LONG_LONG_INTEGER:
+        return args + sizeof(long long);
+      case BinLogType::FLOAT:
+        return args + sizeof(float);
+      case BinLogType::DOUBLE:
+        return args + sizeof(double);
+      case BinLogType::STRING: {
+        uint32_t length;
+        memcpy(&length, args, sizeof(length));
+        return args + sizeof(length) + length;
+      }
+      case BinLogType::TIMESTAMP:
+        return args + sizeof(LogTime);
+      case BinLogType::OBJECT:
+      case BinLogType::MAX:
+        break;
+    }
+
+    FATAL("Cannot skip BinLogType:" + std::to_string(static_cast<int>(type)));
+    return args;
+  }
+
+  /// Expand a format with its recorded arguments to os, substituting % with the next argument and %% with %.
+  inline auto formatBinLogRecord(std::ostream &os, const char *format, const BinLogType *arg_types, const char *args) noexcept {
+    auto literal = format;
+    for (auto s = format; *s; ++s) {
+      if (*s == '%') {
+        os.write(literal, s - literal);
+        if (*(s + 1) == '%') {
+          ++s;
+          literal = s;
+        } else {
+          args = formatBinLogArg(os, *arg_types++, args);
+          literal = s + 1;
+        }
+      }
+    }
+    os << literal;
+  }
+
+  /// Expand a binary log file written by BinLogger to text, returns the number of log() calls decoded.
+  inline auto decodeBinLog(std::istream &in, std::ostream &out) -> size_t {
+    BinLogFileHeader file_header;
+    in.read(reinterpret_cast<char *>(&file_header), sizeof(file_header));
+    ASSERT(in && file_header.magic_ == BinLogFileMagic, "Not a binary log file.");
+    ASSERT(file_header.version_ == BinLogFileVersion, "Unsupported binary log file version:" + std::to_string(file_header.version_));
+
+    std::vector<std::pair<std::vector<BinLogType>, std::string>> formats;
+    std::vector<char> payload;
+    size_t num_entries = 0;
+    for (BinLogFileRecordHeader record; in.read(reinterpret_cast<char *>(&record), sizeof(record));) {
+      payload.resize(record.length_ + 1);
+      in.read(payload.data(), record.length_);
+      ASSERT(static_cast<size_t>(in.gcount()) == record.length_, "Truncated binary log record of " + std::to_string(record.length_) + " bytes.");
+      payload[record.length_] = '\0';
+
+      if (record.type_ == BinLogFileRecordType::FORMAT) {
+        ASSERT(record.format_id_ == formats.size(), "Unexpected format id:" + std::to_string(record.format_id_));
+        const auto types_end = std::find(payload.begin(), payload.end(), static_cast<char>(BinLogType::MAX));
+        ASSERT(types_end != payload.end(), "Unterminated argument types of format id:" + std::to_string(record.format_id_));
+        std::vector<BinLogType> arg_types;
+        for (auto type = payload.begin(); type != types_end + 1; ++type) {
+          arg_types.push_back(static_cast<BinLogType>(*type));
+          // An object's formatter is an address in the process which wrote the file, BinLogger writes objects as strings.
+          ASSERT(arg_types.back() < BinLogType::OBJECT || arg_types.back() == BinLogType::MAX,
+                 "Invalid argument type:" + std::to_string(*type) + " in format id:" + std::to_string(record.format_id_));
+        }
+        formats.emplace_back(std::move(arg_types), std::string(types_end + 1, payload.end() - 1));
+      } else {
+        ASSERT(record.format_id_ < formats.size(), "Entry of undefined format id:" + std::to_string(record.format_id_));
+        const auto &format = formats[record.format_id_];
+        formatBinLogRecord(out, format.second.c_str(), format.first.data(), payload.data());
+        ++num_entries;
+      }
+    }
+
+    return num_entries;
+  }
+
+  /// How BinLogger writes its records to the output log file.
+  enum class BinLogMode : uint8_t {
+    TEXT = 0, /// Formatted by the background thread into the same text Logger writes.
+    BINARY = 1 /// Raw arguments and format ids, each format written once, expanded offline by decodeBinLog(). Objects are written as strings.
+  };
+
+  /// Logger with the same log() calls as Logger which records each call as one variable-length record in the queue:
+  /// the address of the format string and of its argument types, both known at compile time, followed by the raw
+  /// argument bytes. The format is only parsed and the arguments formatted by the background thread, or not at all
+  /// in BINARY mode.
+  class BinLogger final {
+  public:
+    /// Consumes from the lock free queue of records and writes them to the output log file.
+    auto flushQueue() noexcept {
+      while (running_) {
+
+        for (auto readable = queue_.getReadable(); !readable.empty(); readable = queue_.getReadable()) {
+          // Records are published whole, so every record starting in the readable chunks is complete.
+          size_t num_chunks = 0;
+          while (num_chunks < readable.size()) {
+            const auto record = reinterpret_cast<const BinLogRecordHeader *>(readable[num_chunks].data_);
+            if (LIKELY(record->format_)) {
+              writeRecord(record);
+            }
+            num_chunks += chunksOf(record->size_);
+          }
+          queue_.commitRead(num_chunks);
+        }
+        file_.flush();
+
+        using namespace std::literals::chrono_literals;
+        std::this_thread::sleep_for(10ms);
+      }
+    }
+
+    explicit BinLogger(const std::string &file_name, BinLogMode mode = BinLogMode::TEXT)
+        : file_name_(file_name), mode_(mode), queue_(BIN_LOG_QUEUE_SIZE) {
+      file_.open(file_name, std::ios::binary);
+      ASSERT(file_.is_open(), "Could not open log file:" + file_name);
+      if (mode_ == BinLogMode::BINARY) {
+        const BinLogFileHeader file_header;
+        file_.write(reinterpret_cast<const char *>(&file_header), sizeof(file_header));
+      }
+      logger_thread_ = createAndStartThread(-1, "Common/BinLogger " + file_name_, [this]() { flushQueue(); });
+      ASSERT(logger_thread_ != nullptr, "Failed to start BinLogger thread.");
+    }
+
+    ~BinLogger() {
+      std::string time_str;
+      std::cerr << Common::getCurrentTimeStr(&time_str) << " Flushing and closing BinLogger for " << file_name_ << std::endl;
+
+      while (queue_.size()) {
+        using namespace std::literals::chrono_literals;
+        std::this_thread::sleep_for(1s);
+      }
+      running_ = false;
+      logger_thread_->join();
+
+      file_.close();
+      std::cerr << Common::getCurrentTimeStr(&time_str) << " BinLogger for " << file_name_ << " exiting." << std::endl;
+    }
+
+    /// Write one record with the format and the raw bytes of the arguments to the lock free queue.
+    /// A format whose number of % does not match the number of arguments fails to compile.
+    /// Objects with a toString() member, passed by reference or pointer, are copied by value if they are a BinLogObject and
+    /// converted by the background thread, other objects are recorded as their string, converted only when enabled.
+    template<typename... A>
+    auto log(BinLogFormat<std::type_identity_t<A>...> format, const A &... args) noexcept {
+      if (UNLIKELY(!enabled_.load(std::memory_order_relaxed)))
+        return;
+
+      logRecord(format.format_, loggable(args)...);
+    }
+
+    /// Enable or disable log() on all binary loggers in the process, enabled by default.
+    /// Offline tools such as the backtester disable logging since writing the log would dominate their run time.
+    static auto setEnabled(bool enabled) noexcept {
+      enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    /// Deleted default, copy & move constructors and assignment-operators.
+    BinLogger() = delete;
+
+    BinLogger(const BinLogger &) = delete;
+
+    BinLogger(const BinLogger &&) = delete;
+
+    BinLogger &operator=(const BinLogger &) = delete;
+
+    BinLogger &operator=(const BinLogger &&) = delete;
+
+  private:
+    /// The argument itself, the object a pointer to a BinLogObject points to, or the string of any other object or pointer to
+    /// an object with a toString() member.
+    template<typename T>
+    static auto loggable(const T &value) noexcept -> decltype(auto) {
+      if constexpr (BinLogObject<T>) {
+        return (value);
+      } else if constexpr (requires { value.toString(); }) {
+        return value.toString();
+      } else if constexpr (std::is_pointer_v<T> && BinLogObject<std::remove_cv_t<std::remove_pointer_t<T>>>) {
+        return (*value);
+      } else if constexpr (std::is_pointer_v<T> && requires { value->toString(); }) {
+        return value->toString();
+      } else {
+        return (value);
+      }
+    }
+
+    template<typename... A>
+    auto logRecord(const char *format, const A &... args) noexcept {
+      const std::array<size_t, sizeof...(A) + 1> arg_sizes = {argSize(args)..., 0};
+      size_t size = sizeof(BinLogRecordHeader);
+      for (const auto arg_size: arg_sizes) {
+        size += arg_size;
+      }
+
+      // A record is always contiguous in the queue, one which would wrap around is preceded by padding up to the end of the queue.
+      const auto num_chunks = chunksOf(size);
+      auto span = queue_.claimWrite(num_chunks);
+      if (UNLIKELY(span.contiguous() < num_chunks)) {
+        const auto num_padding_chunks = span.contiguous();
+        new(span[0].data_) BinLogRecordHeader{nullptr, nullptr, static_cast<uint32_t>(num_padding_chunks * sizeof(BinLogChunk)), 0};
+        queue_.publishWrite(num_padding_chunks);
+        span = queue_.claimWrite(num_chunks);
+      }
+
+      auto dest = span[0].data_;
+      new(dest) BinLogRecordHeader{format, BIN_LOG_ARG_TYPES<A...>, static_cast<uint32_t>(size), 0};
+      dest += sizeof(BinLogRecordHeader);
+      size_t arg_index = 0;
+      (writeArg(&dest, args, arg_sizes[arg_index++]), ...);
+
+      queue_.publishWrite(num_chunks);
+    }
+
+    static constexpr auto chunksOf(size_t size) noexcept -> size_t {
+      return (size + sizeof(BinLogChunk) - 1) / sizeof(BinLogChunk);
+    }
+
+    static auto stringLength(const std::string &value) noexcept {
+      return value.size();
+    }
+
+    static auto stringLength(const char *value) noexcept {
+      return strlen(value);
+    }
+
+    static auto stringData(const std::string &value) noexcept {
+      return value.data();
+    }
+
+    static auto stringData(const char *value) noexcept {
+      return value;
+    }
+
+    /// Number of bytes the argument takes in a record.
+    template<typename T>
+    static auto argSize(const T &value) noexcept -> size_t {
+      if constexpr (binLogTypeOf<T>() == BinLogType::STRING) {
+        return sizeof(uint32_t) + stringLength(value);
+      } else if constexpr (binLogTypeOf<T>() == BinLogType::CHAR || binLogTypeOf<T>() == BinLogType::TIMESTAMP) {
+        return sizeof(T);
+      } else if constexpr (binLogTypeOf<T>() == BinLogType::OBJECT) {
+        return sizeof(BinLogObjectFormatter) + sizeof(T);
+      } else {
+        return sizeof(+value);
+      }
+    }
+
+    /// Copy the argument's raw bytes of size arg_size to *dest and advance *dest past them.
+    template<typename T>
+    static auto writeArg(char **dest, const T &value, size_t arg_size) noexcept {
+      if constexpr (binLogTypeOf<T>() == BinLogType::STRING) {
+        const auto length = static_cast<uint32_t>(arg_size - sizeof(uint32_t));
+        memcpy(*dest, &length, sizeof(length));
+        memcpy(*dest + sizeof(length), stringData(value), length);
+      } else if constexpr (binLogTypeOf<T>() == BinLogType::CHAR || binLogTypeOf<T>() == BinLogType::TIMESTAMP) {
+        memcpy(*dest, &value, sizeof(T));
+      } else if constexpr (binLogTypeOf<T>() == BinLogType::OBJECT) {
+        const BinLogObjectFormatter formatter = &formatBinLogObject<T>;
+        memcpy(*dest, &formatter, sizeof(formatter));
+        memcpy(*dest + sizeof(formatter), &value, sizeof(T));
+      } else {
+        const auto promoted = +value;
+        memcpy(*dest, &promoted, sizeof(promoted));
+      }
+      *dest += arg_size;
+    }
+
+    /// Format the record to text, or write it in binary preceded by the definition of its format the first time it is seen.
+    auto writeRecord(const BinLogRecordHeader *record) noexcept -> void {
+      const auto args = reinterpret_cast<const char *>(record) + sizeof(BinLogRecordHeader);
+      if (mode_ == BinLogMode::TEXT) {
+        formatBinLogRecord(file_, record->format_, record->arg_types_, args);
+        return;
+      }
+
+      // The compiler may merge identical format literals used with different argument types, so the id is per pair.
+      const auto [first, last] = format_ids_.equal_range(record->format_);
+      auto format_id = std::find_if(first, last, [record](const auto &id) { return id.second.first == record->arg_types_; });
+      if (format_id == last) {
+        format_id = format_ids_.emplace(record->format_, std::make_pair(record->arg_types_, static_cast<uint32_t>(format_ids_.size())));
+
+        std::vector<BinLogType> arg_types;
+        for (auto type = record->arg_types_; *type != BinLogType::MAX; ++type) {
+          arg_types.push_back(*type == BinLogType::OBJECT ? BinLogType::STRING : *type);
+        }
+        arg_types.push_back(BinLogType::MAX);
+        const auto format_length = strlen(record->format_);
+        const BinLogFileRecordHeader definition{static_cast<uint32_t>(arg_types.size() + format_length), format_id->second.second,
+                                                BinLogFileRecordType::FORMAT};
+        file_.write(reinterpret_cast<const char *>(&definition), sizeof(definition));
+        file_.write(reinterpret_cast<const char *>(arg_types.data()), arg_types.size());
+        file_.write(record->format_, format_length);
+      }
+
+      const char *entry_args = args;
+      auto entry_length = static_cast<uint32_t>(record->size_ - sizeof(BinLogRecordHeader));
+      const auto arg_types_end = binLogArgTypesEnd(record->arg_types_);
+      if (std::find(record->arg_types_, arg_types_end, BinLogType::OBJECT) != arg_types_end) {
+        stringifyObjects(record->arg_types_, args);
+        entry_args = entry_args_.data();
+        entry_length = static_cast<uint32_t>(entry_args_.size());
+      }
+
+      const BinLogFileRecordHeader entry{entry_length, format_id->second.second, BinLogFileRecordType::ENTRY};
+      file_.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+      file_.write(entry_args, entry.length_);
+    }
+
+    /// Copy the arguments at args to entry_args_ with every object replaced by its string, as the format definition declares it.
+    auto stringifyObjects(const BinLogType *arg_types, const char *args) noexcept -> void {
+      entry_args_.clear();
+      for (auto type = arg_types; *type != BinLogType::MAX; ++type) {
+        if (*type == BinLogType::OBJECT) {
+          object_str_.str("");
+          args = formatBinLogArg(object_str_, *type, args);
+          const auto object_str = object_str_.view();
+          const auto length = static_cast<uint32_t>(object_str.size());
+          entry_args_.insert(entry_args_.end(), reinterpret_cast<const char *>(&length), reinterpret_cast<const char *>(&length) + sizeof(length));
+          entry_args_.insert(entry_args_.end(), object_str.begin(), object_str.end());
+        } else {
+          const auto next = nextBinLogArg(*type, args);
+          entry_args_.insert(entry_args_.end(), args, next);
+          args = next;
+        }
+      }
+    }
+
+    /// File to which the log records will be written.
+    const std::string file_name_;
+    const BinLogMode mode_;
+    std::ofstream file_;
+
+    /// Lock free queue of record chunks from main logging thread to background formatting and disk writer thread.
+    LFQueue<BinLogChunk> queue_;
+    std::atomic<bool> running_ = {true};
+
+    /// Background logging thread.
+    std::thread *logger_thread_ = nullptr;
+
+    /// BINARY mode: id assigned to each format string and argument types pair, in the order they were first logged.
+    std::unordered_multimap<const char *, std::pair<const BinLogType *, uint32_t>> format_ids_;
+
+    /// BINARY mode: arguments of the current entry with its objects converted to strings, reused across entries.
+    std::vector<char> entry_args_;
+    std::stringstream object_str_;
+
+    static inline std::atomic<bool> enabled_ = {true};
+  };
+}
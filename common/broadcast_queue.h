@@ -0,0 +1,207 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <immintrin.h>
+
+#include "macros.h"
+#include "huge_page_allocator.h"
+#include "lf_queue.h"
+
+namespace Common {
+  /// Bounded single-producer multi-consumer broadcast ring buffer: every element is written once and read by every reader.
+  /// Each reader owns its read cursor on its own cache line and consumes independently of the others.
+  /// The producer may only overwrite a slot once the slowest reader has released it, and keeps a private copy of the
+  /// slowest cursor which it only recomputes over all readers when the cached value says the queue is full.
+  /// Readers have to be added with addReader() before the producer starts writing.
+  template<typename T>
+  class BroadcastQueue final {
+  public:
+    /// A consumer of the broadcast queue with the same consumer API as LFQueue.
+    class Reader final {
+    public:
+      /// Next element to read, or nullptr if this reader has consumed everything published.
+      auto getNextToRead() const noexcept -> const T * {
+        const auto current_read = next_read_index_.load(std::memory_order_relaxed);
+        if (UNLIKELY(current_read == cached_write_index_)) {
+          cached_write_index_ = queue_->next_write_index_.load(std::memory_order_acquire);
+          if (UNLIKELY(current_read == cached_write_index_)) {
+            return nullptr;
+          }
+        }
+        return &queue_->store_[current_read & queue_->mask_];
+      }
+
+      /// Release the element returned by getNextToRead(), the producer reuses the slot once all readers released it.
+      auto updateReadIndex() noexcept {
+        next_read_index_.store(next_read_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+      }
+
+      /// Up to max_elems published elements starting at the next read slot, empty if there are none.
+      auto getReadable(std::size_t max_elems = std::numeric_limits<std::size_t>::max()) const noexcept -> RingSpan<const T> {
+        const auto current_read = next_read_index_.load(std::memory_order_relaxed);
+        if (cached_write_index_ - current_read < max_elems) {
+          cached_write_index_ = queue_->next_write_index_.load(std::memory_order_acquire);
+        }
+        return RingSpan<const T>(queue_->store_.data(), queue_->mask_, current_read, std::min(max_elems, cached_write_index_ - current_read));
+      }
+
+      /// Release the first num_elems readable elements with a single release store.
+      auto commitRead(std::size_t num_elems) noexcept {
+        next_read_index_.store(next_read_index_.load(std::memory_order_relaxed) + num_elems, std::memory_order_release);
+      }
+
+      /// Position of the next element to read, counting every element the producer ever wrote from 0.
+      auto nextReadIndex() const noexcept -> std::size_t {
+        return next_read_index_.load(std::memory_order_relaxed);
+      }
+
+      /// Number of elements published and not yet read by this reader.
+      auto size() const noexcept -> std::size_t {
+        const auto current_read = next_read_index_.load(std::memory_order_acquire);
+        return queue_->next_write_index_.load(std::memory_order_acquire) - current_read;
+      }
+
+      Reader(const BroadcastQueue *queue, std::size_t start_index) noexcept :
+          queue_(queue), next_read_index_(start_index), cached_write_index_(start_index) {
+      }
+
+      Reader() = delete;
+      Reader(const Reader &) = delete;
+      Reader(const Reader &&) = delete;
+      Reader &operator=(const Reader &) = delete;
+      Reader &operator=(const Reader &&) = delete;
+
+    private:
+      friend class BroadcastQueue;
+
+      const BroadcastQueue *queue_ = nullptr;
+
+      /// Reader cache line: this reader's published read index and its last seen write index.
+      alignas(64) std::atomic<std::size_t> next_read_index_ = {0};
+      mutable std::size_t cached_write_index_ = 0;
+    };
+
+    explicit BroadcastQueue(std::size_t num_elems) :
+        store_(round_up_to_power_of_2(num_elems), T()),
+        mask_(store_.size() - 1),
+        capacity_(store_.size()) {
+    }
+
+    /// Add a reader which sees every element written from now on, the queue owns the reader.
+    /// Not thread-safe against the producer, all readers have to be added before writing starts.
+    auto addReader() -> Reader * {
+      const auto current_write = next_write_index_.load(std::memory_order_relaxed);
+      readers_.push_back(std::make_unique<Reader>(this, current_write));
+      cached_min_read_index_ = current_write;
+      return readers_.back().get();
+    }
+
+    /// Producer: slot to write the next element into, or nullptr if the slowest reader has not released it yet.
+    auto tryGetNextToWriteTo() noexcept -> T* {
+      const auto current_write = next_write_index_.load(std::memory_order_relaxed);
+      if (UNLIKELY(current_write - cached_min_read_index_ == capacity_)) {
+        reloadMinReadIndex(current_write);
+        if (UNLIKELY(current_write - cached_min_read_index_ == capacity_)) {
+          return nullptr;
+        }
+      }
+      return &store_[current_write & mask_];
+    }
+
+    /// Producer: spin until a slot is available.
+    auto getNextToWriteTo() noexcept -> T* {
+      while (true) {
+        auto slot = tryGetNextToWriteTo();
+        if (LIKELY(slot != nullptr)) {
+          return slot;
+        }
+
+        _mm_pause();
+      }
+    }
+
+    /// Producer: publish the element written into the slot returned by getNextToWriteTo() to all readers.
+    auto updateWriteIndex() noexcept {
+      next_write_index_.store(next_write_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Producer: claim up to max_elems free slots starting at the next write slot, possibly fewer or none.
+    auto tryClaimWrite(std::size_t max_elems) noexcept -> RingSpan<T> {
+      const auto current_write = next_write_index_.load(std::memory_order_relaxed);
+      if (UNLIKELY(capacity_ - (current_write - cached_min_read_index_) < max_elems)) {
+        reloadMinReadIndex(current_write);
+      }
+      return RingSpan<T>(store_.data(), mask_, current_write, std::min(max_elems, capacity_ - (current_write - cached_min_read_index_)));
+    }
+
+    /// Producer: spin until num_elems slots starting at the next write slot are free and claim them, see LFQueue::claimWrite().
+    auto claimWrite(std::size_t num_elems) noexcept -> RingSpan<T> {
+      if (UNLIKELY(num_elems > capacity_)) {
+        FATAL("Claim of " + std::to_string(num_elems) + " larger than queue capacity " + std::to_string(capacity_));
+      }
+      while (true) {
+        const auto span = tryClaimWrite(num_elems);
+        if (LIKELY(span.size() == num_elems)) {
+          return span;
+        }
+
+        _mm_pause();
+      }
+    }
+
+    /// Producer: publish the first num_elems claimed slots to all readers with a single release store.
+    auto publishWrite(std::size_t num_elems) noexcept {
+      next_write_index_.store(next_write_index_.load(std::memory_order_relaxed) + num_elems, std::memory_order_release);
+    }
+
+    auto capacity() const noexcept -> std::size_t {
+      return capacity_;
+    }
+
+    BroadcastQueue() = delete;
+    BroadcastQueue(const BroadcastQueue &) = delete;
+    BroadcastQueue(const BroadcastQueue &&) = delete;
+    BroadcastQueue &operator=(const BroadcastQueue &) = delete;
+    BroadcastQueue &operator=(const BroadcastQueue &&) = delete;
+
+  private:
+    /// Recompute the slowest reader's cursor, without readers every published slot counts as released.
+    auto reloadMinReadIndex(std::size_t current_write) noexcept {
+      auto min_read_index = current_write;
+      for (const auto &reader: readers_) {
+        min_read_index = std::min(min_read_index, reader->next_read_index_.load(std::memory_order_acquire));
+      }
+      cached_min_read_index_ = min_read_index;
+    }
+
+    static std::size_t round_up_to_power_of_2(std::size_t v) {
+      if (UNLIKELY(v == 0)) return 1;
+
+      --v;
+      v |= v >> 1;
+      v |= v >> 2;
+      v |= v >> 4;
+      v |= v >> 8;
+      v |= v >> 16;
+      v |= v >> 32;
+      ++v;
+
+      return v;
+    }
+
+    /// Read-only after construction, shared by the producer and all readers. Large stores are backed by huge pages.
+    std::vector<T, HugePageAllocator<T>> store_;
+    const std::size_t mask_;
+    const std::size_t capacity_;
+    std::vector<std::unique_ptr<Reader>> readers_;
+
+    /// Producer cache line: the published write index and the slowest read index the producer last saw.
+    alignas(64) std::atomic<std::size_t> next_write_index_ = {0};
+    std::size_t cached_min_read_index_ = 0;
+  };
+}
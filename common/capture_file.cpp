@@ -0,0 +1,100 @@
+#include "capture_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Common {
+  CaptureWriter::CaptureWriter(const std::string &file_name, size_t max_size)
+      : max_size_(max_size) {
+    ASSERT(max_size_ > sizeof(CaptureFileHeader), "Capture file max size too small:" + std::to_string(max_size_));
+
+    fd_ = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ASSERT(fd_ >= 0, "Could not open capture file:" + file_name + " error:" + std::string(std::strerror(errno)));
+    ASSERT(ftruncate(fd_, max_size_) == 0, "ftruncate() failed on capture file:" + file_name + " error:" + std::string(std::strerror(errno)));
+
+    auto data = mmap(nullptr, max_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    ASSERT(data != MAP_FAILED, "mmap() failed on capture file:" + file_name + " error:" + std::string(std::strerror(errno)));
+    data_ = static_cast<char *>(data);
+
+    header_ = new(data_) CaptureFileHeader();
+  }
+
+  CaptureWriter::~CaptureWriter() {
+    const auto file_size = sizeof(CaptureFileHeader) + header_->data_size_;
+
+    msync(data_, file_size, MS_SYNC);
+    munmap(data_, max_size_);
+    data_ = nullptr;
+    header_ = nullptr;
+
+    if (ftruncate(fd_, file_size) != 0)
+      std::cerr << "ftruncate() failed on capture file error:" << std::strerror(errno) << std::endl;
+    close(fd_);
+    fd_ = -1;
+  }
+
+  /// Append one datagram, returns false if it does not fit in the remaining space.
+  auto CaptureWriter::write(uint16_t channel, Nanos kernel_time, Nanos user_time, const void *data, size_t len) noexcept -> bool {
+    const auto offset = sizeof(CaptureFileHeader) + header_->data_size_;
+    if (UNLIKELY(offset + sizeof(CaptureRecordHeader) + len > max_size_))
+      return false;
+
+    const CaptureRecordHeader record{static_cast<uint32_t>(len), channel, 0, kernel_time, user_time};
+    memcpy(data_ + offset, &record, sizeof(record));
+    memcpy(data_ + offset + sizeof(record), data, len);
+
+    // Publish the record only after it has been completely written.
+    header_->data_size_ += sizeof(record) + len;
+
+    return true;
+  }
+
+  CaptureReader::CaptureReader(const std::string &file_name) {
+    fd_ = open(file_name.c_str(), O_RDONLY);
+    ASSERT(fd_ >= 0, "Could not open capture file:" + file_name + " error:" + std::string(std::strerror(errno)));
+
+    struct stat file_stat;
+    ASSERT(fstat(fd_, &file_stat) == 0, "fstat() failed on capture file:" + file_name + " error:" + std::string(std::strerror(errno)));
+    map_size_ = static_cast<size_t>(file_stat.st_size);
+    ASSERT(map_size_ >= sizeof(CaptureFileHeader), "Capture file too small:" + file_name);
+
+    auto data = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    ASSERT(data != MAP_FAILED, "mmap() failed on capture file:" + file_name + " error:" + std::string(std::strerror(errno)));
+    data_ = static_cast<const char *>(data);
+
+    CaptureFileHeader header;
+    memcpy(&header, data_, sizeof(header));
+    ASSERT(header.magic_ == CaptureFileMagic && header.version_ == CaptureFileVersion,
+           "Unsupported capture file:" + file_name + " version:" + std::to_string(header.version_));
+
+    // Tolerate a writer which did not shut down cleanly and left the file at its maximum size.
+    end_ = std::min(map_size_, sizeof(CaptureFileHeader) + header.data_size_);
+  }
+
+  CaptureReader::~CaptureReader() {
+    munmap(const_cast<char *>(data_), map_size_);
+    data_ = nullptr;
+    close(fd_);
+    fd_ = -1;
+  }
+
+  /// Return the next record and point payload to its data, or nullptr at the end of the file.
+  auto CaptureReader::next(const char **payload) noexcept -> const CaptureRecordHeader * {
+    if (offset_ + sizeof(CaptureRecordHeader) > end_)
+      return nullptr;
+
+    auto record = reinterpret_cast<const CaptureRecordHeader *>(data_ + offset_);
+    if (UNLIKELY(offset_ + sizeof(CaptureRecordHeader) + record->length_ > end_))
+      return nullptr;
+
+    *payload = data_ + offset_ + sizeof(CaptureRecordHeader);
+    offset_ += sizeof(CaptureRecordHeader) + record->length_;
+
+    return record;
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <new>
+#include <string>
+
+#include "macros.h"
+#include "time_utils.h"
+
+namespace Common {
+  /// Magic number and format version at the start of every capture file.
+  constexpr uint32_t CaptureFileMagic = 0x50414344; // "DCAP" when read as little-endian bytes.
+  constexpr uint16_t CaptureFileVersion = 1;
+
+  /// Default maximum size of a capture file, the file is sparse until written to.
+  constexpr size_t CaptureFileDefaultMaxSize = 4ul * 1024 * 1024 * 1024;
+
+  /// These structures are written to disk as-is, so pack them to eliminate system dependent padding.
+#pragma pack(push, 1)
+
+  /// Header at the start of a capture file.
+  struct CaptureFileHeader {
+    uint32_t magic_ = CaptureFileMagic;
+    uint16_t version_ = CaptureFileVersion;
+    uint16_t reserved_ = 0;
+    uint64_t data_size_ = 0; /// Number of bytes of records following this header.
+  };
+
+  /// Length-prefix preceding each captured datagram, the payload of length_ bytes follows immediately after.
+  struct CaptureRecordHeader {
+    uint32_t length_ = 0;
+    uint16_t channel_ = 0; /// Identifies the stream the datagram was received on.
+    uint16_t reserved_ = 0;
+    Nanos kernel_time_ = 0; /// Kernel software receive timestamp, 0 if not available.
+    Nanos user_time_ = 0; /// User space time at which the datagram was read.
+  };
+
+#pragma pack(pop)
+
+  /// Appends records to a memory-mapped capture file of fixed maximum size.
+  /// The file is truncated to the data actually written when the writer is destroyed.
+  class CaptureWriter final {
+  public:
+    CaptureWriter(const std::string &file_name, size_t max_size = CaptureFileDefaultMaxSize);
+
+    ~CaptureWriter();
+
+    /// Append one datagram, returns false if it does not fit in the remaining space.
+    auto write(uint16_t channel, Nanos kernel_time, Nanos user_time, const void *data, size_t len) noexcept -> bool;
+
+    /// Number of bytes of records written so far.
+    auto size() const noexcept {
+      return header_->data_size_;
+    }
+
+    CaptureWriter() = delete;
+    CaptureWriter(const CaptureWriter &) = delete;
+    CaptureWriter(const CaptureWriter &&) = delete;
+    CaptureWriter &operator=(const CaptureWriter &) = delete;
+    CaptureWriter &operator=(const CaptureWriter &&) = delete;
+
+  private:
+    int fd_ = -1;
+    char *data_ = nullptr;
+    size_t max_size_ = 0;
+
+    CaptureFileHeader *header_ = nullptr;
+  };
+
+  /// Reads records sequentially from a memory-mapped capture file.
+  class CaptureReader final {
+  public:
+    explicit CaptureReader(const std::string &file_name);
+
+    ~CaptureReader();
+
+    /// Return the next record and point payload to its data, or nullptr at the end of the file.
+    auto next(const char **payload) noexcept -> const CaptureRecordHeader *;
+
+    /// Restart reading from the first record.
+    auto rewind() noexcept {
+      offset_ = sizeof(CaptureFileHeader);
+    }
+
+    CaptureReader() = delete;
+    CaptureReader(const CaptureReader &) = delete;
+    CaptureReader(const CaptureReader &&) = delete;
+    CaptureReader &operator=(const CaptureReader &) = delete;
+    CaptureReader &operator=(const CaptureReader &&) = delete;
+
+  private:
+    int fd_ = -1;
+    const char *data_ = nullptr;
+    size_t map_size_ = 0;
+    size_t end_ = 0;
+    size_t offset_ = sizeof(CaptureFileHeader);
+  };
+}
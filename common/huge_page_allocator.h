@@ -0,0 +1,226 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <memory>
+#include <sstream>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+
+#include "macros.h"
+
+namespace Common {
+  /// Size of an explicit (hugetlbfs) or transparent huge page on x86-64.
+  constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /// How a region ended up being backed, in order of preference.
+  enum class HugePageMode : uint8_t {
+    HUGETLB = 0, /// Explicit huge pages from the reserved pool (vm.nr_hugepages) via MAP_HUGETLB.
+    THP = 1,     /// Anonymous mapping marked MADV_HUGEPAGE, huge pages when the kernel's transparent huge page allocation succeeds.
+    NORMAL = 2,  /// Regular pages, when both huge page modes failed.
+    MAX = 3
+  };
+
+  inline auto hugePageModeToString(HugePageMode mode) -> std::string {
+    switch (mode) {
+      case HugePageMode::HUGETLB:
+        return "HUGETLB";
+      case HugePageMode::THP:
+        return "THP";
+      case HugePageMode::NORMAL:
+        return "NORMAL";
+      case HugePageMode::MAX:
+        return "MAX";
+    }
+
+    return "UNKNOWN";
+  }
+
+  /// NUMA node that huge page regions allocated from the current thread are bound to, -1 for the kernel's default policy.
+  /// createAndStartThread() sets it to the node of the core a thread is pinned to.
+  inline auto hugePageNumaNode() noexcept -> int & {
+    static thread_local int numa_node = -1;
+    return numa_node;
+  }
+
+  /// NUMA node of the core the calling thread is currently running on, -1 if unknown.
+  inline auto currentNumaNode() noexcept -> int {
+    unsigned cpu = 0, node = 0;
+    return (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 ? static_cast<int>(node) : -1);
+  }
+
+  /// NUMA node of the provided core from sysfs, -1 if unknown, e.g. to bind structures constructed before the thread pinned to that core is started.
+  inline auto numaNodeOfCore(int core_id) -> int {
+    if (core_id < 0) {
+      return -1;
+    }
+
+    const auto cpu_dir = "/sys/devices/system/cpu/cpu" + std::to_string(core_id) + "/node";
+    for (int node = 0; node < static_cast<int>(sizeof(unsigned long) * 8); ++node) {
+      if (access((cpu_dir + std::to_string(node)).c_str(), F_OK) == 0) {
+        return node;
+      }
+    }
+
+    return -1;
+  }
+
+  /// Binds the regions allocated by the current thread within a scope to a NUMA node, e.g. for structures constructed on the main
+  /// thread before the thread that uses them is started. A negative node leaves the current binding unchanged.
+  class HugePageNumaScope final {
+  public:
+    explicit HugePageNumaScope(int numa_node) noexcept : previous_numa_node_(hugePageNumaNode()) {
+      if (numa_node >= 0) {
+        hugePageNumaNode() = numa_node;
+      }
+    }
+
+    ~HugePageNumaScope() {
+      hugePageNumaNode() = previous_numa_node_;
+    }
+
+    HugePageNumaScope() = delete;
+    HugePageNumaScope(const HugePageNumaScope &) = delete;
+    HugePageNumaScope(const HugePageNumaScope &&) = delete;
+    HugePageNumaScope &operator=(const HugePageNumaScope &) = delete;
+    HugePageNumaScope &operator=(const HugePageNumaScope &&) = delete;
+
+  private:
+    const int previous_numa_node_;
+  };
+
+  /// Process-wide number of regions and bytes mapped per HugePageMode, and of regions bound to (HUGETLB: preferring) a NUMA node.
+  /// Updated by allocateHugePages() instead of reporting every mapping, the mains log hugePageSummary() once after startup.
+  struct HugePageStats {
+    std::array<std::atomic<size_t>, static_cast<size_t>(HugePageMode::MAX)> regions_ = {};
+    std::array<std::atomic<size_t>, static_cast<size_t>(HugePageMode::MAX)> bytes_ = {};
+    std::atomic<size_t> numa_bound_regions_ = 0;
+  };
+
+  inline auto hugePageStats() noexcept -> HugePageStats & {
+    static HugePageStats stats;
+    return stats;
+  }
+
+  /// One line with the regions and bytes mapped so far in every mode and how many of the regions are NUMA bound.
+  inline auto hugePageSummary() -> std::string {
+    const auto &stats = hugePageStats();
+    std::stringstream ss;
+    ss << "huge page regions";
+    for (size_t i = 0; i < static_cast<size_t>(HugePageMode::MAX); ++i) {
+      ss << " " << hugePageModeToString(static_cast<HugePageMode>(i)) << ":" << stats.regions_[i].load() << "/" << stats.bytes_[i].load() << "B";
+    }
+    ss << " numa-bound:" << stats.numa_bound_regions_.load();
+    return ss.str();
+  }
+
+  /// Mapped length of a region of the requested size, whole huge pages so that the tail of the region is huge page backed too.
+  inline constexpr auto hugePageRegionSize(size_t bytes) noexcept {
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  }
+
+  /// Map a zero-filled region of at least bytes, rounded up to whole huge pages, trying the modes from preferred_mode downwards:
+  /// MAP_HUGETLB fails cleanly with ENOMEM when the reserved pool is too small, MADV_HUGEPAGE fails when THP is disabled,
+  /// and the plain mapping is kept in either case.
+  /// Binds the region to hugePageNumaNode() if set, explicit huge page regions only prefer it, and counts the outcome in hugePageStats().
+  /// Returns the region and stores the mode it got in *mode.
+  inline auto allocateHugePages(size_t bytes, HugePageMode preferred_mode, HugePageMode *mode) -> void * {
+    const auto region_size = hugePageRegionSize(bytes);
+    void *region = MAP_FAILED;
+    *mode = preferred_mode;
+
+    if (*mode == HugePageMode::HUGETLB) {
+      region = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (region == MAP_FAILED) {
+        *mode = HugePageMode::THP;
+      }
+    }
+
+    if (region == MAP_FAILED) {
+      // Transparent huge pages only back 2 MiB aligned ranges, so over-map by one huge page and trim both ends to alignment.
+      auto mapping = static_cast<char *>(mmap(nullptr, region_size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+      ASSERT(mapping != MAP_FAILED, "mmap() of " + std::to_string(region_size) + " bytes failed. error:" + std::string(std::strerror(errno)));
+      const auto head = (HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(mapping) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+      if (head) {
+        munmap(mapping, head);
+      }
+      if (HUGE_PAGE_SIZE - head) {
+        munmap(mapping + head + region_size, HUGE_PAGE_SIZE - head);
+      }
+      region = mapping + head;
+
+      if (*mode == HugePageMode::THP && madvise(region, region_size, MADV_HUGEPAGE) != 0) {
+        *mode = HugePageMode::NORMAL;
+      }
+    }
+
+    // Binding has to happen before the first touch, the kernel places each page when it is faulted in.
+    // MAP_HUGETLB only reserves pages from the global pool, so with MPOL_BIND a fault on a node whose own pool is short raises SIGBUS
+    // instead of failing the mmap(). Explicit huge page regions therefore only prefer the node and take a page from another node's pool.
+    const auto numa_node = hugePageNumaNode();
+    bool numa_bound = false;
+    if (numa_node >= 0 && static_cast<size_t>(numa_node) < sizeof(unsigned long) * 8) {
+      const unsigned long node_mask = 1UL << numa_node;
+      const auto policy = (*mode == HugePageMode::HUGETLB ? MPOL_PREFERRED : MPOL_BIND);
+      numa_bound = (syscall(SYS_mbind, region, region_size, policy, &node_mask, sizeof(node_mask) * 8, 0) == 0);
+    }
+
+    auto &stats = hugePageStats();
+    stats.regions_[static_cast<size_t>(*mode)].fetch_add(1, std::memory_order_relaxed);
+    stats.bytes_[static_cast<size_t>(*mode)].fetch_add(region_size, std::memory_order_relaxed);
+    if (numa_bound) {
+      stats.numa_bound_regions_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return region;
+  }
+
+  /// Release a region returned by allocateHugePages() for the same number of bytes, in whichever mode it was backed.
+  inline auto deallocateHugePages(void *region, size_t bytes) noexcept {
+    munmap(region, hugePageRegionSize(bytes));
+  }
+
+  /// Standard allocator backing containers with huge pages, used for the large preallocated stores of pools, queues and buffers.
+  /// Containers only allocate once up front, so every allocation of at least HUGE_PAGE_SIZE is a separate mapping,
+  /// smaller ones gain nothing from huge pages and come from std::allocator.
+  template<typename T>
+  class HugePageAllocator {
+  public:
+    typedef T value_type;
+
+    HugePageAllocator() noexcept = default;
+
+    template<typename U>
+    HugePageAllocator(const HugePageAllocator<U> &) noexcept {
+    }
+
+    auto allocate(size_t n) -> T * {
+      if (n * sizeof(T) < HUGE_PAGE_SIZE) {
+        return std::allocator<T>().allocate(n);
+      }
+
+      HugePageMode mode;
+      return static_cast<T *>(allocateHugePages(n * sizeof(T), HugePageMode::HUGETLB, &mode));
+    }
+
+    auto deallocate(T *p, size_t n) noexcept {
+      if (n * sizeof(T) < HUGE_PAGE_SIZE) {
+        std::allocator<T>().deallocate(p, n);
+        return;
+      }
+
+      deallocateHugePages(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    auto operator==(const HugePageAllocator<U> &) const noexcept {
+      return true;
+    }
+  };
+}
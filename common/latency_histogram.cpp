@@ -0,0 +1,113 @@
+#include "latency_histogram.h"
+
+#include <cmath>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include "perf_counters.h"
+#include "thread_utils.h"
+
+namespace Common {
+  auto LatencyHistogramSnapshot::add(const LatencyHistogram &histogram) noexcept -> void {
+    // Sum count_ from the buckets read rather than LatencyHistogram::count(), so that percentile ranks stay consistent with the buckets.
+    for (size_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+      const auto bucket_count = histogram.bucketCount(i);
+      buckets_[i] += bucket_count;
+      count_ += bucket_count;
+    }
+    sum_ += histogram.sum();
+    max_ = std::max(max_, histogram.max());
+  }
+
+  auto LatencyHistogramSnapshot::percentile(double fraction) const noexcept -> uint64_t {
+    const auto rank = static_cast<uint64_t>(std::ceil(fraction * count_));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+      seen += buckets_[i];
+      if (seen && seen >= rank)
+        return std::min(LatencyHistogram::bucketHighestValue(i), max_);
+    }
+    return max_;
+  }
+
+  auto LatencyHistogramRegistry::histogram(const std::string &tag, LatencyUnit unit) noexcept -> LatencyHistogram * {
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto thread_id = std::this_thread::get_id();
+    for (auto &entry : entries_) {
+      if (entry.thread_id_ == thread_id && entry.unit_ == unit && entry.tag_ == tag)
+        return entry.histogram_.get();
+    }
+
+    entries_.push_back({tag, unit, thread_id, std::make_unique<LatencyHistogram>()});
+    return entries_.back().histogram_.get();
+  }
+
+  auto LatencyHistogramRegistry::dump(std::ostream &os) noexcept -> void {
+    // Merge the per-thread histograms by tag, ordered by tag so that consecutive dumps are easy to compare.
+    std::map<std::pair<std::string, LatencyUnit>, LatencyHistogramSnapshot> snapshots;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto &entry : entries_)
+        snapshots[{entry.tag_, entry.unit_}].add(*entry.histogram_);
+    }
+
+    std::string time_str;
+    os << getCurrentTimeStr(&time_str) << " latency histograms" << std::endl;
+    os << std::left << std::setw(72) << "tag" << std::right << std::setw(8) << "unit" << std::setw(12) << "count"
+       << std::setw(12) << "mean" << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "p99.9"
+       << std::setw(12) << "max" << std::endl;
+    for (const auto &[key, snapshot] : snapshots) {
+      if (!snapshot.count())
+        continue;
+      os << std::left << std::setw(72) << key.first << std::right << std::setw(8) << latencyUnitToString(key.second)
+         << std::setw(12) << snapshot.count() << std::setw(12) << std::fixed << std::setprecision(1) << snapshot.mean()
+         << std::setw(12) << snapshot.percentile(0.5) << std::setw(12) << snapshot.percentile(0.99)
+         << std::setw(12) << snapshot.percentile(0.999) << std::setw(12) << snapshot.max() << std::endl;
+    }
+
+#if defined(ENABLE_PERF_COUNTERS)
+    perfCounters().dump(os);
+#endif
+  }
+
+  auto latencyHistograms() noexcept -> LatencyHistogramRegistry & {
+    static LatencyHistogramRegistry registry;
+    return registry;
+  }
+
+  /// Set by the SIGUSR1 handler and consumed by the dumper thread, the handler itself only touches this lock-free flag.
+  static std::atomic<bool> latency_histogram_dump_requested = false;
+
+  /// Body of the dumper thread, takes its arguments by value since the lambda starting it does not outlive createAndStartThread().
+  static auto runLatencyHistogramDumper(std::string file_name, int64_t interval_secs) noexcept {
+    using namespace std::literals::chrono_literals;
+    auto last_dump_time = getCurrentNanos();
+    while (true) {
+      std::this_thread::sleep_for(100ms);
+      if (latency_histogram_dump_requested.exchange(false) || getCurrentNanos() - last_dump_time >= interval_secs * NANOS_TO_SECS) {
+        last_dump_time = getCurrentNanos();
+        dumpLatencyHistograms(file_name);
+      }
+    }
+  }
+
+  auto startLatencyHistogramDumper(const std::string &file_name, int64_t interval_secs) -> void {
+    std::signal(SIGUSR1, [](int) { latency_histogram_dump_requested = true; });
+
+    ASSERT(createAndStartThread(-1, "Common/LatencyHistogramDumper",
+                                [file_name, interval_secs]() { runLatencyHistogramDumper(file_name, interval_secs); }) != nullptr,
+           "Failed to start LatencyHistogramDumper thread.");
+  }
+
+  auto dumpLatencyHistograms(const std::string &file_name) noexcept -> void {
+    std::ofstream file(file_name, std::ios::app);
+    if (!file.is_open()) {
+      std::cerr << "Could not open latency histogram file:" << file_name << std::endl;
+      return;
+    }
+    latencyHistograms().dump(file);
+  }
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "macros.h"
+
+namespace Common {
+  /// Values below 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS are recorded exactly, larger values into log-linear buckets
+  /// whose width is at most 1/2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS of the value, i.e. a relative error below 1.6%.
+  constexpr size_t LATENCY_HISTOGRAM_SUB_BUCKET_BITS = 6;
+  constexpr size_t LATENCY_HISTOGRAM_SUB_BUCKET_COUNT = 1ul << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+
+  /// Values are clamped to this many bits before bucketing, the exact maximum is tracked separately.
+  constexpr size_t LATENCY_HISTOGRAM_MAX_VALUE_BITS = 48;
+  constexpr uint64_t LATENCY_HISTOGRAM_MAX_VALUE = (1ul << LATENCY_HISTOGRAM_MAX_VALUE_BITS) - 1;
+
+  /// The first 2 * SUB_BUCKET_COUNT buckets hold exact values, each further power of two adds SUB_BUCKET_COUNT buckets.
+  constexpr size_t LATENCY_HISTOGRAM_BUCKET_COUNT =
+      (LATENCY_HISTOGRAM_MAX_VALUE_BITS - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+
+  /// Unit of the values recorded into a histogram.
+  enum class LatencyUnit : uint8_t {
+    CYCLES = 0, /// rdtsc() differences from START_MEASURE / END_MEASURE.
+    NANOS = 1 /// Hops between consecutive TTT_MEASURE marks on the same thread.
+  };
+
+  inline auto latencyUnitToString(LatencyUnit unit) -> std::string {
+    switch (unit) {
+      case LatencyUnit::CYCLES:
+        return "cycles";
+      case LatencyUnit::NANOS:
+        return "ns";
+    }
+    return "UNKNOWN";
+  }
+
+  /// HDR-style log-linear histogram of latency samples.
+  /// Each instance has a single writer thread, which updates the counters with plain relaxed loads and stores,
+  /// so recording a sample costs a handful of instructions and no locked operations.
+  /// Other threads may read the counters concurrently, a snapshot taken while samples are recorded can be off by the in-flight samples.
+  class LatencyHistogram final {
+  public:
+    LatencyHistogram() = default;
+
+    /// Bucket index of the provided value.
+    static auto bucketIndex(uint64_t value) noexcept -> size_t {
+      value = std::min(value, LATENCY_HISTOGRAM_MAX_VALUE);
+      if (value < 2 * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+        return value;
+
+      const size_t shift = (63 - __builtin_clzl(value)) - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+      return shift * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + (value >> shift);
+    }
+
+    /// Largest value which maps to the bucket at the provided index.
+    static auto bucketHighestValue(size_t index) noexcept -> uint64_t {
+      if (index < 2 * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+        return index;
+
+      const auto shift = index / LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1;
+      const uint64_t sub_bucket = index - shift * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+      return ((sub_bucket + 1) << shift) - 1;
+    }
+
+    /// Record one sample, must only be called from the thread owning this histogram.
+    auto record(uint64_t value) noexcept {
+      auto &bucket = buckets_[bucketIndex(value)];
+      bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+      if (UNLIKELY(value > max_.load(std::memory_order_relaxed)))
+        max_.store(value, std::memory_order_relaxed);
+    }
+
+    auto count() const noexcept {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+    auto sum() const noexcept {
+      return sum_.load(std::memory_order_relaxed);
+    }
+
+    auto max() const noexcept {
+      return max_.load(std::memory_order_relaxed);
+    }
+
+    auto bucketCount(size_t index) const noexcept {
+      return buckets_[index].load(std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram(const LatencyHistogram &&) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &&) = delete;
+
+  private:
+    std::array<std::atomic<uint64_t>, LATENCY_HISTOGRAM_BUCKET_COUNT> buckets_ = {};
+    std::atomic<uint64_t> count_ = 0;
+    std::atomic<uint64_t> sum_ = 0;
+    std::atomic<uint64_t> max_ = 0;
+  };
+
+  /// Counts of several histograms with the same tag merged together, used to compute the reported statistics.
+  class LatencyHistogramSnapshot final {
+  public:
+    auto add(const LatencyHistogram &histogram) noexcept -> void;
+
+    /// Smallest value such that at least the provided fraction of the samples are not larger than it,
+    /// reported as the highest value of its bucket and never above the recorded maximum.
+    auto percentile(double fraction) const noexcept -> uint64_t;
+
+    auto count() const noexcept {
+      return count_;
+    }
+
+    auto mean() const noexcept {
+      return count_ ? static_cast<double>(sum_) / count_ : 0.0;
+    }
+
+    auto max() const noexcept {
+      return max_;
+    }
+
+  private:
+    std::vector<uint64_t> buckets_ = std::vector<uint64_t>(LATENCY_HISTOGRAM_BUCKET_COUNT, 0);
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+  };
+
+  /// Process-wide registry of latency histograms, keyed by measurement tag and writer thread.
+  /// Looking up a histogram takes a lock, callers cache the returned pointer per thread so that only the first sample pays for it.
+  class LatencyHistogramRegistry final {
+  public:
+    /// Histogram of the calling thread for the provided tag, created on first use and never freed.
+    auto histogram(const std::string &tag, LatencyUnit unit) noexcept -> LatencyHistogram *;
+
+    /// Write count, mean, p50, p99, p99.9 and max per tag, merging the histograms of all threads recording that tag.
+    auto dump(std::ostream &os) noexcept -> void;
+
+    LatencyHistogramRegistry() = default;
+
+    LatencyHistogramRegistry(const LatencyHistogramRegistry &) = delete;
+    LatencyHistogramRegistry(const LatencyHistogramRegistry &&) = delete;
+    LatencyHistogramRegistry &operator=(const LatencyHistogramRegistry &) = delete;
+    LatencyHistogramRegistry &operator=(const LatencyHistogramRegistry &&) = delete;
+
+  private:
+    struct Entry {
+      std::string tag_;
+      LatencyUnit unit_ = LatencyUnit::CYCLES;
+      std::thread::id thread_id_;
+      std::unique_ptr<LatencyHistogram> histogram_;
+    };
+
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+  };
+
+  /// The registry all START_MEASURE / END_MEASURE and TTT_MEASURE samples are recorded into.
+  auto latencyHistograms() noexcept -> LatencyHistogramRegistry &;
+
+  /// Start a thread which appends a dump of latencyHistograms() to the provided file every interval_secs seconds,
+  /// and additionally whenever the process receives SIGUSR1.
+  auto startLatencyHistogramDumper(const std::string &file_name, int64_t interval_secs) -> void;
+
+  /// Append a dump of latencyHistograms() to the provided file, e.g. once more right before the process exits.
+  auto dumpLatencyHistograms(const std::string &file_name) noexcept -> void;
+
+  /// Number of (previous tag, tag) pairs whose histograms are cached per thread by recordLatencyHop().
+  constexpr size_t LATENCY_HOP_CACHE_SIZE = 64;
+
+  /// Record the time elapsed since the previous TTT_MEASURE mark on this thread, into the histogram tagged "previous->tag".
+  /// Tags are string literals, so the pair of pointers identifies the hop in the per-thread cache without comparing strings.
+  inline auto recordLatencyHop(const char *tag, int64_t nanos) noexcept {
+    struct Hop {
+      const char *from_ = nullptr;
+      const char *to_ = nullptr;
+      LatencyHistogram *histogram_ = nullptr;
+    };
+    thread_local std::array<Hop, LATENCY_HOP_CACHE_SIZE> hops;
+    thread_local const char *last_tag = nullptr;
+    thread_local int64_t last_nanos = 0;
+
+    if (LIKELY(last_tag)) {
+      auto &hop = hops[((reinterpret_cast<uintptr_t>(last_tag) >> 3) ^ (reinterpret_cast<uintptr_t>(tag) >> 2)) % LATENCY_HOP_CACHE_SIZE];
+      if (UNLIKELY(hop.from_ != last_tag || hop.to_ != tag))
+        hop = {last_tag, tag, latencyHistograms().histogram(std::string(last_tag) + "->" + tag, LatencyUnit::NANOS)};
+      hop.histogram_->record(static_cast<uint64_t>(std::max<int64_t>(nanos - last_nanos, 0)));
+    }
+
+    last_tag = tag;
+    last_nanos = nanos;
+  }
+}
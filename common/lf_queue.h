@@ -3,11 +3,52 @@
 #include <iostream>
 #include <vector>
 #include <atomic>
+#include <limits>
+#include <algorithm>
 #include <immintrin.h>
 
 #include "macros.h"
+#include "huge_page_allocator.h"
 
 namespace Common {
+  /// A run of consecutive ring slots returned by the batch APIs of the ring buffer queues. operator[] applies the index mask,
+  /// so a run that wraps around the end of the store is still addressed as [0, size()).
+  template<typename U>
+  class RingSpan {
+  public:
+    RingSpan(U *store, std::size_t mask, std::size_t begin, std::size_t size) noexcept :
+        store_(store), mask_(mask), begin_(begin), size_(size) {
+    }
+
+    auto operator[](std::size_t i) const noexcept -> U & {
+      return store_[(begin_ + i) & mask_];
+    }
+
+    auto size() const noexcept {
+      return size_;
+    }
+
+    auto empty() const noexcept {
+      return !size_;
+    }
+
+    /// Number of elements of the run up to the end of the store, less than size() if the run wraps around.
+    auto contiguous() const noexcept {
+      return std::min(size_, mask_ + 1 - (begin_ & mask_));
+    }
+
+  private:
+    U *store_;
+    std::size_t mask_;
+    std::size_t begin_;
+    std::size_t size_;
+  };
+
+  /// Bounded single-producer single-consumer ring buffer.
+  /// The write and read indices increase monotonically and are only masked when indexing into the store.
+  /// Each side keeps a private copy of the other side's index and only reloads the shared one when the cached
+  /// value says the queue is full (producer) or empty (consumer), so the shared cache lines move between cores
+  /// only when the queue actually runs full or empty, and there is no shared element counter.
   template<typename T>
   class LFQueue final {
   public:
@@ -17,59 +58,106 @@ namespace Common {
         capacity_(store_.size()) {
     }
 
+    /// Producer: slot to write the next element into, or nullptr if the queue is full.
     auto tryGetNextToWriteTo() noexcept -> T* {
-      auto current_write = next_write_index_.load(std::memory_order_relaxed);
-      auto current_read = next_read_index_.load(std::memory_order_acquire);
-      
-      if (UNLIKELY((current_write + 1) & mask_ == current_read & mask_)) {
-        return nullptr;
+      const auto current_write = next_write_index_.load(std::memory_order_relaxed);
+      if (UNLIKELY(current_write - cached_read_index_ == capacity_)) {
+        cached_read_index_ = next_read_index_.load(std::memory_order_acquire);
+        if (UNLIKELY(current_write - cached_read_index_ == capacity_)) {
+          return nullptr;
+        }
       }
       return &store_[current_write & mask_];
     }
 
+    /// Producer: spin until a slot is available.
     auto getNextToWriteTo() noexcept -> T* {
       while (true) {
         auto slot = tryGetNextToWriteTo();
         if (LIKELY(slot != nullptr)) {
           return slot;
         }
-        
+
         _mm_pause();
       }
     }
 
+    /// Producer: publish the element written into the slot returned by getNextToWriteTo().
     auto updateWriteIndex() noexcept {
-      auto current_write_index = next_write_index_.load(std::memory_order_relaxed);
-      next_write_index_.store(current_write_index + 1, std::memory_order_release);
-      num_elements_.fetch_add(1, std::memory_order_release);
+      next_write_index_.store(next_write_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
     }
 
+    /// Consumer: next element to read, or nullptr if the queue is empty.
     auto getNextToRead() const noexcept -> const T * {
-        auto current_read_index = next_read_index_.load(std::memory_order_relaxed);
-        auto current_element_count = num_elements_.load(std::memory_order_acquire);
-    
-        if (LIKELY(current_element_count > 0)) {
-            std::size_t target_index = current_read_index & mask_;
-            return &store_[target_index];
-        } else {
-            return nullptr;
+      const auto current_read = next_read_index_.load(std::memory_order_relaxed);
+      if (UNLIKELY(current_read == cached_write_index_)) {
+        cached_write_index_ = next_write_index_.load(std::memory_order_acquire);
+        if (UNLIKELY(current_read == cached_write_index_)) {
+          return nullptr;
         }
+      }
+      return &store_[current_read & mask_];
     }
 
+    /// Consumer: release the element returned by getNextToRead() back to the producer.
     auto updateReadIndex() noexcept {
-      auto current_read_index = next_read_index_.load(std::memory_order_relaxed);
-      next_read_index_.store(current_read_index + 1, std::memory_order_release);
-      num_elements_.fetch_sub(1, std::memory_order_release);
+      next_read_index_.store(next_read_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
     }
 
-    auto size() const noexcept {
-      return num_elements_.load(std::memory_order_acquire);
+    /// Producer: claim up to max_elems free slots starting at the next write slot, possibly fewer or none.
+    /// Nothing is visible to the consumer until publishWrite().
+    auto tryClaimWrite(std::size_t max_elems) noexcept -> RingSpan<T> {
+      const auto current_write = next_write_index_.load(std::memory_order_relaxed);
+      if (UNLIKELY(capacity_ - (current_write - cached_read_index_) < max_elems)) {
+        cached_read_index_ = next_read_index_.load(std::memory_order_acquire);
+      }
+      return RingSpan<T>(store_.data(), mask_, current_write, std::min(max_elems, capacity_ - (current_write - cached_read_index_)));
+    }
+
+    /// Producer: spin until num_elems slots starting at the next write slot are free and claim them.
+    /// Claiming again before publishing returns the same starting slot, so a producer can grow a batch one element at a time
+    /// with claimWrite(n + 1)[n].
+    auto claimWrite(std::size_t num_elems) noexcept -> RingSpan<T> {
+      if (UNLIKELY(num_elems > capacity_)) {
+        FATAL("Claim of " + std::to_string(num_elems) + " larger than queue capacity " + std::to_string(capacity_));
+      }
+      while (true) {
+        const auto span = tryClaimWrite(num_elems);
+        if (LIKELY(span.size() == num_elems)) {
+          return span;
+        }
+
+        _mm_pause();
+      }
+    }
+
+    /// Producer: publish the first num_elems claimed slots with a single release store.
+    auto publishWrite(std::size_t num_elems) noexcept {
+      next_write_index_.store(next_write_index_.load(std::memory_order_relaxed) + num_elems, std::memory_order_release);
+    }
+
+    /// Consumer: up to max_elems published elements starting at the next read slot, empty if there are none.
+    auto getReadable(std::size_t max_elems = std::numeric_limits<std::size_t>::max()) const noexcept -> RingSpan<const T> {
+      const auto current_read = next_read_index_.load(std::memory_order_relaxed);
+      if (cached_write_index_ - current_read < max_elems) {
+        cached_write_index_ = next_write_index_.load(std::memory_order_acquire);
+      }
+      return RingSpan<const T>(store_.data(), mask_, current_read, std::min(max_elems, cached_write_index_ - current_read));
+    }
+
+    /// Consumer: release the first num_elems readable elements back to the producer with a single release store.
+    auto commitRead(std::size_t num_elems) noexcept {
+      next_read_index_.store(next_read_index_.load(std::memory_order_relaxed) + num_elems, std::memory_order_release);
+    }
+
+    /// Number of elements in the queue, exact only when called from the producer or consumer thread with the other side idle.
+    auto size() const noexcept -> std::size_t {
+      const auto current_read = next_read_index_.load(std::memory_order_acquire);
+      return next_write_index_.load(std::memory_order_acquire) - current_read;
     }
 
     auto is_full() const noexcept -> bool {
-      auto current_write = next_write_index_.load(std::memory_order_relaxed);
-      auto current_read = next_read_index_.load(std::memory_order_relaxed);
-      return (current_write + 1) & mask_ == current_read & mask_;
+      return size() == capacity_;
     }
 
     auto capacity() const noexcept -> std::size_t {
@@ -98,12 +186,17 @@ namespace Common {
       return v;
     }
 
-    std::vector<T> store_;
+    /// Read-only after construction, shared by both sides. Large stores are backed by huge pages.
+    std::vector<T, HugePageAllocator<T>> store_;
     const std::size_t mask_;
     const std::size_t capacity_;
 
+    /// Producer cache line: the published write index and the producer's last seen read index.
     alignas(64) std::atomic<std::size_t> next_write_index_ = {0};
+    std::size_t cached_read_index_ = 0;
+
+    /// Consumer cache line: the published read index and the consumer's last seen write index.
     alignas(64) std::atomic<std::size_t> next_read_index_ = {0};
-    alignas(64) std::atomic<std::size_t> num_elements_ = {0};
+    mutable std::size_t cached_write_index_ = 0;
   };
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <concepts>
 #include <string>
 #include <fstream>
 #include <cstdio>
@@ -23,7 +24,8 @@ namespace Common {
     UNSIGNED_LONG_INTEGER = 5,
     UNSIGNED_LONG_LONG_INTEGER = 6,
     FLOAT = 7,
-    DOUBLE = 8
+    DOUBLE = 8,
+    TIMESTAMP = 9
   };
 
   /// Represents a single and primitive log entry.
@@ -39,6 +41,7 @@ namespace Common {
       unsigned long long ull;
       float f;
       double d;
+      Nanos t;
     } u_;
   };
 
@@ -77,6 +80,11 @@ namespace Common {
             case LogType::DOUBLE:
               file_ << next->u_.d;
               break;
+            case LogType::TIMESTAMP: {
+              char time_str[TIME_STR_SIZE];
+              file_ << formatTimeStr(next->u_.t, time_str);
+            }
+              break;
           }
           queue_.updateReadIndex();
         }
@@ -153,6 +161,10 @@ namespace Common {
       pushValue(LogElement{LogType::DOUBLE, {.d = value}});
     }
 
+    auto pushValue(const LogTime &value) noexcept {
+      pushValue(LogElement{LogType::TIMESTAMP, {.t = value.nanos_}});
+    }
+
     auto pushValue(const char *value) noexcept {
       while (*value) {
         pushValue(*value);
@@ -164,9 +176,26 @@ namespace Common {
       pushValue(value.c_str());
     }
 
+    /// Objects with a toString() member, passed by reference or pointer, are converted only when the entry is actually logged,
+    /// so that a disabled logger does not pay for formatting them.
+    template<typename T>
+    requires requires(const T &value) { { value.toString() } -> std::convertible_to<std::string>; }
+    auto pushValue(const T &value) noexcept {
+      pushValue(value.toString());
+    }
+
+    template<typename T>
+    requires requires(const T *value) { { value->toString() } -> std::convertible_to<std::string>; }
+    auto pushValue(const T *value) noexcept {
+      pushValue(value->toString());
+    }
+
     /// Parse the format string, substitute % with the variable number of arguments passed and write the string to the lock free queue.
     template<typename T, typename... A>
-    auto log(const char *s, const T &value, A... args) noexcept {
+    auto log(const char *s, const T &value, const A &... args) noexcept {
+      if (UNLIKELY(!enabled_))
+        return;
+
       while (*s) {
         if (*s == '%') {
           if (UNLIKELY(*(s + 1) == '%')) { // to allow %% -> % escape character.
@@ -185,6 +214,9 @@ namespace Common {
     /// Overload for case where no substitution in the string is necessary.
     /// Note that this is overloading not specialization. gcc does not allow inline specializations.
     auto log(const char *s) noexcept {
+      if (UNLIKELY(!enabled_))
+        return;
+
       while (*s) {
         if (*s == '%') {
           if (UNLIKELY(*(s + 1) == '%')) { // to allow %% -> % escape character.
@@ -197,6 +229,11 @@ namespace Common {
       }
     }
 
+    /// Enable or disable log() on all loggers in the process, enabled by default.
+    static auto setEnabled(bool enabled) noexcept {
+      enabled_ = enabled;
+    }
+
     /// Deleted default, copy & move constructors and assignment-operators.
     Logger() = delete;
 
@@ -219,5 +256,7 @@ namespace Common {
 
     /// Background logging thread.
     std::thread *logger_thread_ = nullptr;
+
+    static inline bool enabled_ = true;
   };
 }
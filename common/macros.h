@@ -8,7 +8,9 @@
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
 
 /// Check condition and exit if not true.
-inline auto ASSERT(bool cond, const std::string &msg) noexcept {
+/// The message is an argument, so one built with std::string concatenation is built on every call, even when the condition holds:
+/// checks on hot paths use if (UNLIKELY(..)) FATAL(..) instead, and literal messages bind to the const char * overload without a copy.
+inline auto ASSERT(bool cond, const char *msg) noexcept {
   if (UNLIKELY(!cond)) {
     std::cerr << "ASSERT : " << msg << std::endl;
 
@@ -16,6 +18,10 @@ inline auto ASSERT(bool cond, const std::string &msg) noexcept {
   }
 }
 
+inline auto ASSERT(bool cond, const std::string &msg) noexcept {
+  ASSERT(cond, msg.c_str());
+}
+
 inline auto FATAL(const std::string &msg) noexcept {
   std::cerr << "FATAL : " << msg << std::endl;
 
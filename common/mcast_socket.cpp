@@ -3,8 +3,9 @@
 namespace Common {
   /// Initialize multicast socket to read from or publish to a stream.
   /// Does not join the multicast stream yet.
-  auto McastSocket::init(const std::string &ip, const std::string &iface, int port, bool is_listening) -> int {
-    const SocketCfg socket_cfg{ip, iface, port, true, is_listening, false};
+  auto McastSocket::init(const std::string &ip, const std::string &iface, int port, bool is_listening, bool needs_so_timestamp) -> int {
+    const SocketCfg socket_cfg{ip, iface, port, true, is_listening, needs_so_timestamp};
+    needs_so_timestamp_ = needs_so_timestamp;
     socket_fd_ = createSocket(logger_, socket_cfg);
     return socket_fd_;
   }
@@ -23,10 +24,31 @@ namespace Common {
   /// Publish outgoing data and read incoming data.
   auto McastSocket::sendAndRecv() noexcept -> bool {
     // Read data and dispatch callbacks if data is available - non blocking.
-    const ssize_t n_rcv = recv(socket_fd_, inbound_data_.data() + next_rcv_valid_index_, McastBufferSize - next_rcv_valid_index_, MSG_DONTWAIT);
+    ssize_t n_rcv = 0;
+    if (UNLIKELY(needs_so_timestamp_)) {
+      // Use recvmsg() to also read the kernel receive timestamp.
+      char ctrl[CMSG_SPACE(sizeof(struct timeval))];
+      auto cmsg = reinterpret_cast<struct cmsghdr *>(&ctrl);
+
+      iovec iov{inbound_data_.data() + next_rcv_valid_index_, McastBufferSize - next_rcv_valid_index_};
+      msghdr msg{nullptr, 0, &iov, 1, ctrl, sizeof(ctrl), 0};
+      n_rcv = recvmsg(socket_fd_, &msg, MSG_DONTWAIT);
+
+      last_recv_kernel_time_ = 0;
+      if (n_rcv > 0 && msg.msg_controllen &&
+          cmsg->cmsg_level == SOL_SOCKET &&
+          cmsg->cmsg_type == SCM_TIMESTAMP &&
+          cmsg->cmsg_len == CMSG_LEN(sizeof(timeval))) {
+        timeval time_kernel;
+        memcpy(&time_kernel, CMSG_DATA(cmsg), sizeof(time_kernel));
+        last_recv_kernel_time_ = time_kernel.tv_sec * NANOS_TO_SECS + time_kernel.tv_usec * NANOS_TO_MICROS; // convert timestamp to nanoseconds.
+      }
+    } else {
+      n_rcv = recv(socket_fd_, inbound_data_.data() + next_rcv_valid_index_, McastBufferSize - next_rcv_valid_index_, MSG_DONTWAIT);
+    }
     if (n_rcv > 0) {
       next_rcv_valid_index_ += n_rcv;
-      logger_.log("%:% %() % read socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket_fd_,
+      logger_.log("%:% %() % read socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), socket_fd_,
                   next_rcv_valid_index_);
       recv_callback_(this);
     }
@@ -35,7 +57,7 @@ namespace Common {
     if (next_send_valid_index_ > 0) {
       ssize_t n = ::send(socket_fd_, outbound_data_.data(), next_send_valid_index_, MSG_DONTWAIT | MSG_NOSIGNAL);
 
-      logger_.log("%:% %() % send socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket_fd_, n);
+      logger_.log("%:% %() % send socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), socket_fd_, n);
     }
     next_send_valid_index_ = 0;
 
@@ -3,15 +3,16 @@
 #include <functional>
 
 #include "socket_utils.h"
+#include "huge_page_allocator.h"
 
-#include "logging.h"
+#include "bin_logging.h"
 
 namespace Common {
   /// Size of send and receive buffers in bytes.
   constexpr size_t McastBufferSize = 64 * 1024 * 1024;
 
   struct McastSocket {
-    McastSocket(Logger &logger)
+    McastSocket(BinLogger &logger)
         : logger_(logger) {
       outbound_data_.resize(McastBufferSize);
       inbound_data_.resize(McastBufferSize);
@@ -19,7 +20,8 @@ namespace Common {
 
     /// Initialize multicast socket to read from or publish to a stream.
     /// Does not join the multicast stream yet.
-    auto init(const std::string &ip, const std::string &iface, int port, bool is_listening) -> int;
+    /// needs_so_timestamp enables kernel software receive timestamps, available in last_recv_kernel_time_ during the callback.
+    auto init(const std::string &ip, const std::string &iface, int port, bool is_listening, bool needs_so_timestamp = false) -> int;
 
     /// Add / Join membership / subscription to a multicast stream.
     auto join(const std::string &ip) -> bool;
@@ -35,16 +37,19 @@ namespace Common {
 
     int socket_fd_ = -1;
 
+    /// Kernel receive timestamp of the last datagram read, 0 if SO_TIMESTAMP is not enabled or not available.
+    bool needs_so_timestamp_ = false;
+    Nanos last_recv_kernel_time_ = 0;
+
     /// Send and receive buffers, typically only one or the other is needed, not both.
-    std::vector<char> outbound_data_;
+    std::vector<char, HugePageAllocator<char>> outbound_data_;
     size_t next_send_valid_index_ = 0;
-    std::vector<char> inbound_data_;
+    std::vector<char, HugePageAllocator<char>> inbound_data_;
     size_t next_rcv_valid_index_ = 0;
 
     /// Function wrapper for the method to call when data is read.
     std::function<void(McastSocket *s)> recv_callback_ = nullptr;
 
-    std::string time_str_;
-    Logger &logger_;
+    BinLogger &logger_;
   };
 }
@@ -5,37 +5,54 @@
 #include <string>
 
 #include "macros.h"
+#include "huge_page_allocator.h"
 
 namespace Common {
   template<typename T>
   class MemPool final {
   public:
     explicit MemPool(std::size_t num_elems) :
-        store_(num_elems, {T(), true}) /* pre-allocation of vector storage. */ {
+        store_(num_elems, {T(), true, nullptr}) /* pre-allocation of vector storage. */ {
       ASSERT(reinterpret_cast<const ObjectBlock *>(&(store_[0].object_)) == &(store_[0]), "T object should be first member of ObjectBlock.");
+
+      // Chain the blocks in address order so that a fresh pool hands out consecutive blocks.
+      for (size_t i = 0; i + 1 < store_.size(); ++i) {
+        store_[i].next_free_ = &store_[i + 1];
+      }
+      free_head_ = (store_.empty() ? nullptr : &store_[0]);
     }
 
     /// Allocate a new object of type T, use placement new to initialize the object, mark the block as in-use and return the object.
+    /// O(1) irrespective of occupancy: pops the head of the free-list.
+    /// Running out of space is checked in every build; the free-flag check builds its message eagerly, so it is compiled only into debug builds.
     template<typename... Args>
     T *allocate(Args... args) noexcept {
-      auto obj_block = &(store_[next_free_index_]);
-      ASSERT(obj_block->is_free_, "Expected free ObjectBlock at index:" + std::to_string(next_free_index_));
+      auto obj_block = free_head_;
+      ASSERT(obj_block != nullptr, "Memory Pool out of space.");
+#if !defined(NDEBUG)
+      ASSERT(obj_block->is_free_, "Expected free ObjectBlock at index:" + std::to_string(obj_block - &store_[0]));
+#endif
+      free_head_ = obj_block->next_free_;
       T *ret = &(obj_block->object_);
       ret = new(ret) T(args...); // placement new.
       obj_block->is_free_ = false;
 
-      updateNextFreeIndex();
-
       return ret;
     }
 
-    /// Return the object back to the pool by marking the block as free again.
+    /// Return the object back to the pool by marking the block as free again and pushing it on the free-list,
+    /// so the most recently freed (and most likely still cached) block is the next one handed out.
     /// Destructor is not called for the object.
     auto deallocate(const T *elem) noexcept {
       const auto elem_index = (reinterpret_cast<const ObjectBlock *>(elem) - &store_[0]);
       ASSERT(elem_index >= 0 && static_cast<size_t>(elem_index) < store_.size(), "Element being deallocated does not belong to this Memory pool.");
+#if !defined(NDEBUG)
       ASSERT(!store_[elem_index].is_free_, "Expected in-use ObjectBlock at index:" + std::to_string(elem_index));
-      store_[elem_index].is_free_ = true;
+#endif
+      auto obj_block = &store_[elem_index];
+      obj_block->is_free_ = true;
+      obj_block->next_free_ = free_head_;
+      free_head_ = obj_block;
     }
 
     // Deleted default, copy & move constructors and assignment-operators.
@@ -50,32 +67,21 @@ namespace Common {
     MemPool &operator=(const MemPool &&) = delete;
 
   private:
-    /// Find the next available free block to be used for the next allocation.
-    auto updateNextFreeIndex() noexcept {
-      const auto initial_free_index = next_free_index_;
-      while (!store_[next_free_index_].is_free_) {
-        ++next_free_index_;
-        if (UNLIKELY(next_free_index_ == store_.size())) { // hardware branch predictor should almost always predict this to be false any ways.
-          next_free_index_ = 0;
-        }
-        if (UNLIKELY(initial_free_index == next_free_index_)) {
-          ASSERT(initial_free_index != next_free_index_, "Memory Pool out of space.");
-        }
-      }
-    }
-
     /// It is better to have one vector of structs with two objects than two vectors of one object.
     /// Consider how these are accessed and cache performance.
     struct ObjectBlock {
       T object_;
       bool is_free_ = true;
+      ObjectBlock *next_free_ = nullptr; /// Next block on the free-list, only meaningful while the block is free.
     };
 
     /// We could've chosen to use a std::array that would allocate the memory on the stack instead of the heap.
     /// We would have to measure to see which one yields better performance.
     /// It is good to have objects on the stack but performance starts getting worse as the size of the pool increases.
-    std::vector<ObjectBlock> store_;
+    /// Large pools are backed by huge pages so that random access into them does not miss the TLB on every block.
+    std::vector<ObjectBlock, Common::HugePageAllocator<ObjectBlock>> store_;
 
-    size_t next_free_index_ = 0;
+    /// Head of the intrusive LIFO free-list threaded through the free blocks, nullptr when the pool is exhausted.
+    ObjectBlock *free_head_ = nullptr;
   };
 }
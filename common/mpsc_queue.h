@@ -0,0 +1,135 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <immintrin.h>
+
+#include "macros.h"
+#include "huge_page_allocator.h"
+
+namespace Common {
+  /// Bounded multi-producer single-consumer ring buffer for fan-in paths, with the same slot-reserve API as LFQueue.
+  /// Every slot carries a sequence stamp: a slot at position pos is free for the producer which claims pos when its stamp
+  /// equals pos, holds a published element when its stamp equals pos + 1, and is handed back for the next lap as pos + capacity.
+  /// Producers claim positions with a CAS on the shared write index and publish by bumping the stamp of their own slot,
+  /// so a slow producer only delays the consumer at its slot and never blocks other producers from claiming.
+  template<typename T>
+  class MPSCQueue final {
+  public:
+    explicit MPSCQueue(std::size_t num_elems) :
+        store_(round_up_to_power_of_2(num_elems)),
+        mask_(store_.size() - 1),
+        capacity_(store_.size()) {
+      for (std::size_t i = 0; i < capacity_; ++i) {
+        store_[i].sequence_.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    /// Producer (any thread): claim the slot to write the next element into, or nullptr if the queue is full.
+    auto tryGetNextToWriteTo() noexcept -> T* {
+      auto current_write = next_write_index_.load(std::memory_order_relaxed);
+      while (true) {
+        auto &slot = store_[current_write & mask_];
+        const auto sequence = slot.sequence_.load(std::memory_order_acquire);
+        const auto lap = static_cast<std::ptrdiff_t>(sequence - current_write);
+        if (LIKELY(lap == 0)) {
+          // On failure compare_exchange_weak reloads current_write and the loop retries at the new position.
+          if (LIKELY(next_write_index_.compare_exchange_weak(current_write, current_write + 1, std::memory_order_relaxed))) {
+            return &slot.value_;
+          }
+        } else if (lap < 0) {
+          return nullptr; // The consumer has not released this slot from the previous lap yet.
+        } else {
+          current_write = next_write_index_.load(std::memory_order_relaxed); // Another producer claimed it first.
+        }
+      }
+    }
+
+    /// Producer (any thread): spin until a slot is available.
+    auto getNextToWriteTo() noexcept -> T* {
+      while (true) {
+        auto slot = tryGetNextToWriteTo();
+        if (LIKELY(slot != nullptr)) {
+          return slot;
+        }
+
+        _mm_pause();
+      }
+    }
+
+    /// Producer: publish the element written into a slot returned by getNextToWriteTo().
+    /// Unlike LFQueue the slot has to be passed back since producers publish out of claim order.
+    auto updateWriteIndex(T *written) noexcept {
+      auto &slot = store_[slotIndex(written)];
+      slot.sequence_.store(slot.sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Consumer: next element to read, or nullptr if the producer which claimed it has not published it yet.
+    auto getNextToRead() const noexcept -> const T * {
+      const auto current_read = next_read_index_.load(std::memory_order_relaxed);
+      const auto &slot = store_[current_read & mask_];
+      return (slot.sequence_.load(std::memory_order_acquire) == current_read + 1 ? &slot.value_ : nullptr);
+    }
+
+    /// Consumer: release the element returned by getNextToRead() back to the producers for the next lap.
+    auto updateReadIndex() noexcept {
+      const auto current_read = next_read_index_.load(std::memory_order_relaxed);
+      store_[current_read & mask_].sequence_.store(current_read + capacity_, std::memory_order_release);
+      next_read_index_.store(current_read + 1, std::memory_order_relaxed);
+    }
+
+    /// Number of claimed and not yet released slots, exact only when all producers and the consumer are idle.
+    auto size() const noexcept -> std::size_t {
+      const auto current_read = next_read_index_.load(std::memory_order_acquire);
+      return next_write_index_.load(std::memory_order_acquire) - current_read;
+    }
+
+    auto capacity() const noexcept -> std::size_t {
+      return capacity_;
+    }
+
+    MPSCQueue() = delete;
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue(const MPSCQueue &&) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &&) = delete;
+
+  private:
+    /// The element is the first member so that the slot index can be recovered from the pointer handed to producers.
+    struct Slot {
+      T value_ = T();
+      std::atomic<std::size_t> sequence_ = {0};
+    };
+
+    auto slotIndex(const T *written) const noexcept -> std::size_t {
+      return static_cast<std::size_t>(reinterpret_cast<const char *>(written) - reinterpret_cast<const char *>(store_.data())) / sizeof(Slot);
+    }
+
+    static std::size_t round_up_to_power_of_2(std::size_t v) {
+      if (UNLIKELY(v == 0)) return 1;
+
+      --v;
+      v |= v >> 1;
+      v |= v >> 2;
+      v |= v >> 4;
+      v |= v >> 8;
+      v |= v >> 16;
+      v |= v >> 32;
+      ++v;
+
+      return v;
+    }
+
+    /// Read-only after construction apart from the per-slot stamps. Large stores are backed by huge pages.
+    std::vector<Slot, HugePageAllocator<Slot>> store_;
+    const std::size_t mask_;
+    const std::size_t capacity_;
+
+    /// Contended by all producers.
+    alignas(64) std::atomic<std::size_t> next_write_index_ = {0};
+
+    /// Only written by the consumer.
+    alignas(64) std::atomic<std::size_t> next_read_index_ = {0};
+  };
+}
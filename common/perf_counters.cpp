@@ -0,0 +1,183 @@
+#include "perf_counters.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "time_utils.h"
+
+namespace Common {
+  /// Bit per PerfCounter which some thread managed to open, and whether some thread reads them with rdpmc, for dump().
+  static std::atomic<uint32_t> perf_counters_available = 0;
+  static std::atomic<bool> perf_counters_use_rdpmc = false;
+
+  /// Open one counter of the calling thread on any core, as the group leader if group_fd is -1.
+  static auto openPerfCounter(PerfCounter counter, int group_fd) noexcept -> int {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    constexpr auto cache_read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    switch (counter) {
+      case PerfCounter::CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+      case PerfCounter::INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+      case PerfCounter::L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | cache_read_miss;
+        break;
+      case PerfCounter::LLC_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+      case PerfCounter::DTLB_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | cache_read_miss;
+        break;
+      case PerfCounter::BRANCH_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+      case PerfCounter::MAX:
+        return -1;
+    }
+
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+  }
+
+  PerfCounterGroup::PerfCounterGroup() {
+    fds_.fill(-1);
+
+    fds_[0] = openPerfCounter(PerfCounter::CYCLES, -1);
+    if (fds_[0] < 0) {
+      std::cerr << "perf_event_open() failed for cycles, hardware counters not available on this thread error:" << std::strerror(errno)
+                << std::endl;
+      return;
+    }
+
+    for (size_t i = 1; i < PERF_COUNTER_COUNT; ++i) {
+      fds_[i] = openPerfCounter(static_cast<PerfCounter>(i), fds_[0]);
+      if (fds_[i] < 0)
+        std::cerr << "perf_event_open() failed for " << perfCounterToString(static_cast<PerfCounter>(i)) << " error:" << std::strerror(errno)
+                  << std::endl;
+    }
+
+    // rdpmc is only used if every open counter's page can be mapped and permits it.
+    use_rdpmc_ = true;
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+      if (fds_[i] < 0)
+        continue;
+      perf_counters_available |= (1u << i);
+
+      auto page = mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fds_[i], 0);
+      if (page == MAP_FAILED) {
+        use_rdpmc_ = false;
+        continue;
+      }
+      pages_[i] = static_cast<const volatile perf_event_mmap_page *>(page);
+      if (!pages_[i]->cap_user_rdpmc)
+        use_rdpmc_ = false;
+    }
+    if (use_rdpmc_)
+      perf_counters_use_rdpmc = true;
+  }
+
+  PerfCounterGroup::~PerfCounterGroup() {
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+      if (pages_[i])
+        munmap(const_cast<perf_event_mmap_page *>(pages_[i]), sysconf(_SC_PAGESIZE));
+      if (fds_[i] >= 0)
+        close(fds_[i]);
+    }
+  }
+
+  auto PerfCounterGroup::readGroup() const noexcept -> PerfCounterValues {
+    PerfCounterValues values;
+
+    // PERF_FORMAT_GROUP: the number of counters followed by their values, in the order they were added to the group.
+    std::array<uint64_t, 1 + PERF_COUNTER_COUNT> buffer = {};
+    if (UNLIKELY(::read(fds_[0], buffer.data(), sizeof(buffer)) < 0))
+      return values;
+
+    size_t next = 1;
+    for (size_t i = 0; i < PERF_COUNTER_COUNT && next <= buffer[0]; ++i) {
+      if (fds_[i] >= 0)
+        values.values_[i] = buffer[next++];
+    }
+    return values;
+  }
+
+  auto PerfCounterRegistry::stats(const std::string &tag) noexcept -> PerfCounterStats * {
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto thread_id = std::this_thread::get_id();
+    for (auto &entry : entries_) {
+      if (entry.thread_id_ == thread_id && entry.tag_ == tag)
+        return entry.stats_.get();
+    }
+
+    entries_.push_back({tag, thread_id, std::make_unique<PerfCounterStats>()});
+    return entries_.back().stats_.get();
+  }
+
+  auto PerfCounterRegistry::dump(std::ostream &os) noexcept -> void {
+    // Merge the per-thread stats by tag: the number of samples and the sum of every counter.
+    std::map<std::string, std::array<uint64_t, 1 + PERF_COUNTER_COUNT>> totals;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto &entry : entries_) {
+        auto &total = totals[entry.tag_];
+        total[0] += entry.stats_->count();
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+          total[1 + i] += entry.stats_->sum(static_cast<PerfCounter>(i));
+      }
+    }
+    if (totals.empty())
+      return;
+
+    const auto available = perf_counters_available.load();
+    std::string time_str;
+    os << getCurrentTimeStr(&time_str) << " perf counters per sample, read with " << (perf_counters_use_rdpmc ? "rdpmc" : "read()")
+       << (available ? "" : ", no hardware counters available") << std::endl;
+    os << std::left << std::setw(72) << "tag" << std::right << std::setw(12) << "count";
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+      os << std::setw(14) << perfCounterToString(static_cast<PerfCounter>(i));
+    os << std::setw(8) << "ipc" << std::endl;
+
+    for (const auto &[tag, total] : totals) {
+      if (!total[0])
+        continue;
+      os << std::left << std::setw(72) << tag << std::right << std::setw(12) << total[0] << std::fixed << std::setprecision(1);
+      for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        if (available & (1u << i))
+          os << std::setw(14) << static_cast<double>(total[1 + i]) / total[0];
+        else
+          os << std::setw(14) << "-";
+      }
+      const auto cycles = total[1 + static_cast<size_t>(PerfCounter::CYCLES)];
+      const auto instructions = total[1 + static_cast<size_t>(PerfCounter::INSTRUCTIONS)];
+      if (cycles && (available & (1u << static_cast<size_t>(PerfCounter::INSTRUCTIONS))))
+        os << std::setw(8) << std::setprecision(2) << static_cast<double>(instructions) / cycles;
+      else
+        os << std::setw(8) << "-";
+      os << std::endl;
+    }
+  }
+
+  auto perfCounters() noexcept -> PerfCounterRegistry & {
+    static PerfCounterRegistry registry;
+    return registry;
+  }
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/perf_event.h>
+
+#include "macros.h"
+
+namespace Common {
+  /// Hardware events counted around each START_MEASURE / END_MEASURE when built with ENABLE_PERF_COUNTERS.
+  enum class PerfCounter : uint8_t {
+    CYCLES = 0,
+    INSTRUCTIONS = 1,
+    L1D_MISSES = 2, /// L1 data cache read misses.
+    LLC_MISSES = 3, /// Last level cache misses.
+    DTLB_MISSES = 4, /// Data TLB read misses.
+    BRANCH_MISSES = 5,
+    MAX = 6
+  };
+
+  constexpr size_t PERF_COUNTER_COUNT = static_cast<size_t>(PerfCounter::MAX);
+
+  inline auto perfCounterToString(PerfCounter counter) -> std::string {
+    switch (counter) {
+      case PerfCounter::CYCLES:
+        return "cycles";
+      case PerfCounter::INSTRUCTIONS:
+        return "instructions";
+      case PerfCounter::L1D_MISSES:
+        return "l1d-misses";
+      case PerfCounter::LLC_MISSES:
+        return "llc-misses";
+      case PerfCounter::DTLB_MISSES:
+        return "dtlb-misses";
+      case PerfCounter::BRANCH_MISSES:
+        return "branch-misses";
+      case PerfCounter::MAX:
+        return "MAX";
+    }
+    return "UNKNOWN";
+  }
+
+  /// Read performance monitoring counter number counter of the current core.
+  inline auto rdpmc(uint32_t counter) noexcept {
+    unsigned int lo, hi;
+    __asm__ __volatile__ ("rdpmc" : "=a" (lo), "=d" (hi) : "c" (counter));
+    return ((uint64_t) hi << 32) | lo;
+  }
+
+  /// Values of all counters at one point in time, or the difference between two such readings.
+  struct PerfCounterValues {
+    std::array<uint64_t, PERF_COUNTER_COUNT> values_ = {};
+
+    auto operator-(const PerfCounterValues &other) const noexcept {
+      PerfCounterValues delta;
+      for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+        delta.values_[i] = values_[i] - other.values_[i];
+      return delta;
+    }
+  };
+
+  /// Hardware counters of the calling thread, opened through perf_event_open() as one group led by cycles so that they are
+  /// scheduled onto the PMU together, counting user space only.
+  /// Counters are read with rdpmc through their mmap()ed pages where the kernel allows it, which takes no system call,
+  /// otherwise the whole group is read with a single read().
+  /// Counters which the CPU or kernel do not support read as 0 and are reported as unavailable.
+  class PerfCounterGroup final {
+  public:
+    PerfCounterGroup();
+
+    ~PerfCounterGroup();
+
+    /// Current values of all counters, must only be called from the thread which created this group.
+    auto read() const noexcept -> PerfCounterValues {
+      PerfCounterValues values;
+      if (UNLIKELY(!isAvailable(PerfCounter::CYCLES)))
+        return values;
+
+      if (LIKELY(use_rdpmc_)) {
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+          if (pages_[i])
+            values.values_[i] = readPage(pages_[i]);
+        }
+        return values;
+      }
+
+      return readGroup();
+    }
+
+    auto isAvailable(PerfCounter counter) const noexcept -> bool {
+      return fds_[static_cast<size_t>(counter)] >= 0;
+    }
+
+    /// True if read() uses rdpmc rather than a read() system call.
+    auto usesRdpmc() const noexcept {
+      return use_rdpmc_;
+    }
+
+    PerfCounterGroup(const PerfCounterGroup &) = delete;
+    PerfCounterGroup(const PerfCounterGroup &&) = delete;
+    PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+    PerfCounterGroup &operator=(const PerfCounterGroup &&) = delete;
+
+  private:
+    /// Read one counter from its mmap()ed page, retrying if the kernel updated the page concurrently,
+    /// e.g. because the thread was rescheduled between reading the page and executing rdpmc.
+    static auto readPage(const volatile perf_event_mmap_page *page) noexcept -> uint64_t {
+      uint32_t seq;
+      uint64_t count;
+      do {
+        seq = page->lock;
+        std::atomic_signal_fence(std::memory_order_acquire);
+        count = page->offset;
+        const auto index = page->index;
+        if (LIKELY(index)) {
+          // The hardware counter is pmc_width bits wide, sign extend it before adding to the kernel maintained offset.
+          const auto shift = 64 - page->pmc_width;
+          count += static_cast<uint64_t>(static_cast<int64_t>(rdpmc(index - 1) << shift) >> shift);
+        }
+        std::atomic_signal_fence(std::memory_order_acquire);
+      } while (UNLIKELY(page->lock != seq));
+
+      return count;
+    }
+
+    /// Read all counters of the group with one system call on the group leader.
+    auto readGroup() const noexcept -> PerfCounterValues;
+
+    std::array<int, PERF_COUNTER_COUNT> fds_;
+    std::array<const volatile perf_event_mmap_page *, PERF_COUNTER_COUNT> pages_ = {};
+    bool use_rdpmc_ = false;
+  };
+
+  /// Counter group of the calling thread, opened on first use.
+  inline auto threadPerfCounters() noexcept -> PerfCounterGroup & {
+    thread_local PerfCounterGroup group;
+    return group;
+  }
+
+  /// Sums of the counter deltas of all samples of one tag on one thread.
+  /// Single writer thread, updated with relaxed loads and stores like LatencyHistogram.
+  class PerfCounterStats final {
+  public:
+    PerfCounterStats() = default;
+
+    /// Record the counter deltas of one sample, must only be called from the thread owning these stats.
+    auto record(const PerfCounterValues &delta) noexcept {
+      count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+        sums_[i].store(sums_[i].load(std::memory_order_relaxed) + delta.values_[i], std::memory_order_relaxed);
+    }
+
+    auto count() const noexcept {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+    auto sum(PerfCounter counter) const noexcept {
+      return sums_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    PerfCounterStats(const PerfCounterStats &) = delete;
+    PerfCounterStats(const PerfCounterStats &&) = delete;
+    PerfCounterStats &operator=(const PerfCounterStats &) = delete;
+    PerfCounterStats &operator=(const PerfCounterStats &&) = delete;
+
+  private:
+    std::atomic<uint64_t> count_ = 0;
+    std::array<std::atomic<uint64_t>, PERF_COUNTER_COUNT> sums_ = {};
+  };
+
+  /// Process-wide registry of per-tag counter stats, keyed by measurement tag and writer thread like LatencyHistogramRegistry.
+  class PerfCounterRegistry final {
+  public:
+    /// Stats of the calling thread for the provided tag, created on first use and never freed.
+    auto stats(const std::string &tag) noexcept -> PerfCounterStats *;
+
+    /// Write the number of samples and the mean of every counter per sample per tag, merging all threads recording that tag.
+    auto dump(std::ostream &os) noexcept -> void;
+
+    PerfCounterRegistry() = default;
+
+    PerfCounterRegistry(const PerfCounterRegistry &) = delete;
+    PerfCounterRegistry(const PerfCounterRegistry &&) = delete;
+    PerfCounterRegistry &operator=(const PerfCounterRegistry &) = delete;
+    PerfCounterRegistry &operator=(const PerfCounterRegistry &&) = delete;
+
+  private:
+    struct Entry {
+      std::string tag_;
+      std::thread::id thread_id_;
+      std::unique_ptr<PerfCounterStats> stats_;
+    };
+
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+  };
+
+  /// The registry all START_MEASURE / END_MEASURE counter samples are recorded into when built with ENABLE_PERF_COUNTERS,
+  /// dumped together with latencyHistograms().
+  auto perfCounters() noexcept -> PerfCounterRegistry &;
+}
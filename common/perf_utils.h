@@ -1,5 +1,8 @@
 #pragma once
 
+#include "latency_histogram.h"
+#include "perf_counters.h"
+
 namespace Common {
   /// Read from the TSC register and return a uint64_t value to represent elapsed CPU clock cycles.
   inline auto rdtsc() noexcept {
@@ -10,18 +13,50 @@ namespace Common {
 }
 
 /// Start latency measurement using rdtsc(). Creates a variable called TAG in the local scope.
+/// When built with ENABLE_PERF_COUNTERS, also reads the thread's hardware counters into a variable called TAG_perf_counters,
+/// and END_MEASURE records their deltas into perfCounters() under TAG.
+#if defined(ENABLE_PERF_COUNTERS)
+#define START_MEASURE(TAG)                                                                    \
+      const auto TAG##_perf_counters = Common::threadPerfCounters().read();                   \
+      const auto TAG = Common::rdtsc()
+
+#define PERF_COUNTERS_RECORD(TAG)                                                             \
+      do {                                                                                    \
+        const auto counters = Common::threadPerfCounters().read();                            \
+        static thread_local auto perf_stats = Common::perfCounters().stats(#TAG);             \
+        perf_stats->record(counters - TAG##_perf_counters);                                   \
+      } while(false)
+#else
 #define START_MEASURE(TAG) const auto TAG = Common::rdtsc()
 
+#define PERF_COUNTERS_RECORD(TAG) do { } while(false)
+#endif
+
+/// Log one latency line per sample through LOGGER, unless built with DISABLE_LATENCY_LOG,
+/// in which case the samples are only recorded into latencyHistograms() and LOGGER is not evaluated.
+#if defined(DISABLE_LATENCY_LOG)
+#define LATENCY_LOG(LOGGER, ...) static_cast<void>(sizeof(LOGGER))
+#else
+#define LATENCY_LOG(LOGGER, ...) LOGGER.log(__VA_ARGS__)
+#endif
+
 /// End latency measurement using rdtsc(). Expects a variable called TAG to already exist in the local scope.
+/// The cycles elapsed are recorded into the calling thread's histogram for TAG, looked up once per call site and thread.
 #define END_MEASURE(TAG, LOGGER)                                                              \
       do {                                                                                    \
         const auto end = Common::rdtsc();                                                     \
-        LOGGER.log("% RDTSC "#TAG" %\n", Common::getCurrentTimeStr(&time_str_), (end - TAG)); \
+        PERF_COUNTERS_RECORD(TAG);                                                            \
+        static thread_local auto histogram =                                                  \
+            Common::latencyHistograms().histogram(#TAG, Common::LatencyUnit::CYCLES);         \
+        histogram->record(end - TAG);                                                         \
+        LATENCY_LOG(LOGGER, "% RDTSC "#TAG" %\n", Common::getCurrentLogTime(), (end - TAG)); \
       } while(false)
 
 /// Log a current timestamp at the time this macro is invoked.
+/// The time since the previous TTT_MEASURE on the same thread is recorded into the histogram tagged "previous->TAG".
 #define TTT_MEASURE(TAG, LOGGER)                                                              \
       do {                                                                                    \
-        const auto TAG = Common::getCurrentNanos();                                           \
-        LOGGER.log("% TTT "#TAG" %\n", Common::getCurrentTimeStr(&time_str_), TAG);           \
+        const auto TAG = Common::getCurrentTscNanos();                                        \
+        Common::recordLatencyHop(#TAG, TAG);                                                  \
+        LATENCY_LOG(LOGGER, "% TTT "#TAG" %\n", Common::LogTime{TAG}, TAG);                  \
       } while(false)
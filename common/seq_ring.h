@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "macros.h"
+
+namespace Common {
+  /// Circular buffer indexed by sequence number, used to reassemble a stream which may have gaps or reordering.
+  /// Every sequence number in [begin(), watermark()) has been received, so a consumer only has to act when the watermark advances.
+  /// Sequence numbers at or beyond begin() + capacity() slide the window forward and drop the oldest entries.
+  template<typename T>
+  class SeqRing final {
+  public:
+    explicit SeqRing(std::size_t num_elems) :
+        store_(round_up_to_power_of_2(num_elems)),
+        mask_(store_.size() - 1) {
+    }
+
+    /// Discard all entries and restart the window at begin_seq, O(1) irrespective of the number of entries.
+    auto reset(size_t begin_seq) noexcept {
+      ++generation_;
+      begin_ = watermark_ = end_ = begin_seq;
+    }
+
+    /// Store an entry, returns true if the contiguity watermark advanced.
+    /// Entries below begin() are ignored, entries already present are overwritten.
+    auto insert(size_t seq, const T &value) noexcept -> bool {
+      if (UNLIKELY(seq < begin_))
+        return false;
+
+      if (UNLIKELY(seq >= begin_ + capacity()))
+        advanceBegin(seq + 1 - capacity());
+
+      auto &slot = store_[seq & mask_];
+      slot.generation_ = generation_;
+      slot.seq_ = seq;
+      slot.value_ = value;
+      end_ = std::max(end_, seq + 1);
+
+      return (seq == watermark_ && advanceWatermark());
+    }
+
+    /// Drop all entries below seq and move the window to start at seq, returns true if the contiguity watermark advanced.
+    auto advanceBegin(size_t seq) noexcept -> bool {
+      if (seq <= begin_)
+        return false;
+
+      begin_ = seq;
+      end_ = std::max(end_, begin_);
+      if (watermark_ >= begin_)
+        return false;
+
+      watermark_ = begin_;
+      advanceWatermark();
+      return true;
+    }
+
+    auto contains(size_t seq) const noexcept {
+      const auto &slot = store_[seq & mask_];
+      return (seq >= begin_ && slot.generation_ == generation_ && slot.seq_ == seq);
+    }
+
+    auto at(size_t seq) const noexcept -> const T & {
+      ASSERT(contains(seq), "SeqRing does not contain seq:" + std::to_string(seq));
+      return store_[seq & mask_].value_;
+    }
+
+    /// First sequence number in the window.
+    auto begin() const noexcept {
+      return begin_;
+    }
+
+    /// One past the last sequence number of the contiguous run starting at begin().
+    auto watermark() const noexcept {
+      return watermark_;
+    }
+
+    /// One past the highest sequence number received, equals watermark() when there are no gaps.
+    auto end() const noexcept {
+      return end_;
+    }
+
+    auto empty() const noexcept {
+      return end_ == begin_;
+    }
+
+    auto capacity() const noexcept {
+      return store_.size();
+    }
+
+    SeqRing() = delete;
+    SeqRing(const SeqRing &) = delete;
+    SeqRing(const SeqRing &&) = delete;
+    SeqRing &operator=(const SeqRing &) = delete;
+    SeqRing &operator=(const SeqRing &&) = delete;
+
+  private:
+    /// Move the watermark past the contiguous run of entries which are present, returns true if it moved.
+    auto advanceWatermark() noexcept -> bool {
+      const auto old_watermark = watermark_;
+      while (watermark_ < end_ && contains(watermark_))
+        ++watermark_;
+      return watermark_ != old_watermark;
+    }
+
+    static std::size_t round_up_to_power_of_2(std::size_t v) {
+      if (UNLIKELY(v == 0)) return 1;
+
+      --v;
+      v |= v >> 1;
+      v |= v >> 2;
+      v |= v >> 4;
+      v |= v >> 8;
+      v |= v >> 16;
+      v |= v >> 32;
+      ++v;
+
+      return v;
+    }
+
+    /// generation_ is bumped by reset() so stale entries from before the reset are never mistaken for present ones.
+    struct Slot {
+      size_t generation_ = 0;
+      size_t seq_ = 0;
+      T value_;
+    };
+
+    std::vector<Slot> store_;
+    const std::size_t mask_;
+
+    size_t generation_ = 1;
+    size_t begin_ = 0, watermark_ = 0, end_ = 0;
+  };
+}
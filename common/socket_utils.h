@@ -18,7 +18,7 @@
 
 #include "macros.h"
 
-#include "logging.h"
+#include "bin_logging.h"
 
 namespace Common {
   struct SocketCfg {
@@ -91,12 +91,10 @@ namespace Common {
   }
 
   /// Create a TCP / UDP socket to either connect to or listen for data on or listen for connections on the specified interface and IP:port information.
-  [[nodiscard]] inline auto createSocket(Logger &logger, const SocketCfg& socket_cfg) -> int {
-    std::string time_str;
-
+  [[nodiscard]] inline auto createSocket(BinLogger &logger, const SocketCfg& socket_cfg) -> int {
     const auto ip = socket_cfg.ip_.empty() ? getIfaceIP(socket_cfg.iface_) : socket_cfg.ip_;
     logger.log("%:% %() % cfg:%\n", __FILE__, __LINE__, __FUNCTION__,
-               Common::getCurrentTimeStr(&time_str), socket_cfg.toString());
+               Common::getCurrentLogTime(), socket_cfg.toString());
 
     const int input_flags = (socket_cfg.is_listening_ ? AI_PASSIVE : 0) | (AI_NUMERICHOST | AI_NUMERICSERV);
     const addrinfo hints{input_flags, AF_INET, socket_cfg.is_udp_ ? SOCK_DGRAM : SOCK_STREAM,
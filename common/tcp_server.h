@@ -4,7 +4,7 @@
 
 namespace Common {
   struct TCPServer {
-    explicit TCPServer(Logger &logger)
+    explicit TCPServer(BinLogger &logger)
         : listener_socket_(logger), logger_(logger) {
     }
 
@@ -36,7 +36,6 @@ namespace Common {
     /// Function wrapper to call back when all data across all TCPSockets has been read and dispatched this round.
     std::function<void()> recv_finished_callback_ = nullptr;
 
-    std::string time_str_;
-    Logger &logger_;
+    BinLogger &logger_;
   };
 }
@@ -7,6 +7,9 @@
 
 #include <sys/syscall.h>
 
+#include "huge_page_allocator.h"
+#include "time_utils.h"
+
 namespace Common {
   /// Set affinity for current thread to be pinned to the provided core_id.
   inline auto setThreadCore(int core_id) noexcept {
@@ -20,6 +23,9 @@ namespace Common {
 
   /// Creates a thread instance, sets affinity on it, assigns it a name and
   /// passes the function to be run on that thread as well as the arguments to the function.
+  /// A pinned thread binds the huge page regions it allocates to the NUMA node of its core.
+  /// The thread's TscClock is calibrated before the function starts, so that its first timestamp is not delayed,
+  /// and likewise its hardware counters are opened when built with ENABLE_PERF_COUNTERS.
   template<typename T, typename... A>
   inline auto createAndStartThread(int core_id, const std::string &name, T &&func, A &&... args) noexcept {
     auto t = new std::thread([&]() {
@@ -27,6 +33,13 @@ namespace Common {
         std::cerr << "Failed to set core affinity for " << name << " " << pthread_self() << " to " << core_id << std::endl;
         exit(EXIT_FAILURE);
       }
+      if (core_id >= 0) {
+        hugePageNumaNode() = currentNumaNode();
+      }
+      tscClock();
+#if defined(ENABLE_PERF_COUNTERS)
+      threadPerfCounters();
+#endif
       std::cerr << "Set core affinity for " << name << " " << pthread_self() << " to " << core_id << std::endl;
 
       std::forward<T>(func)((std::forward<A>(args))...);
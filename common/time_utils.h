@@ -3,7 +3,11 @@
 #include <string>
 #include <chrono>
 #include <ctime>
+#include <cmath>
+#include <thread>
+#include <algorithm>
 
+#include "macros.h"
 #include "perf_utils.h"
 
 namespace Common {
@@ -22,16 +26,141 @@ namespace Common {
     return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
   }
 
+  /// How long the process-wide initial TSC rate measurement takes, which is also the first recalibration interval.
+  constexpr Nanos TSC_CLOCK_INITIAL_CALIBRATION = 10 * NANOS_TO_MILLIS;
+
+  /// How often a TscClock re-reads CLOCK_REALTIME at most, and the largest change of the measured TSC rate accepted on a recalibration.
+  constexpr Nanos TSC_CLOCK_RECALIBRATION_INTERVAL = NANOS_TO_SECS;
+  constexpr double TSC_CLOCK_MAX_RATE_CHANGE = 1e-3;
+
+  /// Converts rdtsc() readings to wall-clock (CLOCK_REALTIME) nanoseconds without a system call or vDSO clock read.
+  /// Assumes an invariant TSC, which ticks at a constant rate and is synchronized across cores on current x86-64 CPUs.
+  /// On each recalibration the owning thread reads CLOCK_REALTIME again, re-anchors to it and re-measures the TSC rate over
+  /// the whole time since the first reading, so the rate gets more precise and NTP adjustments are followed.
+  /// The interval starts at TSC_CLOCK_INITIAL_CALIBRATION and doubles up to TSC_CLOCK_RECALIBRATION_INTERVAL, so that the
+  /// coarse initial rate is refined before its error adds up.
+  /// A rate change beyond TSC_CLOCK_MAX_RATE_CHANGE means CLOCK_REALTIME was stepped, the baseline then restarts from there.
+  class TscClock final {
+  public:
+    /// Starts from a process-wide calibration measured once, so that only the first clock in the process blocks.
+    TscClock() noexcept : first_(initialCalibration().first), base_(first_), nanos_per_tick_(initialCalibration().second) {
+      recalibrate();
+    }
+
+    /// Current wall-clock time in nanoseconds.
+    auto nanos() noexcept -> Nanos {
+      const auto tsc = rdtsc();
+      if (UNLIKELY(tsc >= next_calibration_tsc_)) {
+        recalibrate();
+      }
+      return toNanos(tsc);
+    }
+
+    /// Wall-clock time in nanoseconds at which rdtsc() returned tsc.
+    auto toNanos(uint64_t tsc) const noexcept -> Nanos {
+      return base_.nanos_ + static_cast<Nanos>(static_cast<double>(static_cast<int64_t>(tsc - base_.tsc_)) * nanos_per_tick_);
+    }
+
+    auto nanosPerTick() const noexcept {
+      return nanos_per_tick_;
+    }
+
+    TscClock(const TscClock &) = delete;
+    TscClock(const TscClock &&) = delete;
+    TscClock &operator=(const TscClock &) = delete;
+    TscClock &operator=(const TscClock &&) = delete;
+
+  private:
+    /// A CLOCK_REALTIME reading and the TSC value at the same instant.
+    struct Reading {
+      uint64_t tsc_ = 0;
+      Nanos nanos_ = 0;
+    };
+
+    /// Bracket the clock read with two TSC reads and attribute it to their midpoint.
+    static auto readRealtime() noexcept -> Reading {
+      const auto before = rdtsc();
+      timespec ts;
+      clock_gettime(CLOCK_REALTIME, &ts);
+      const auto after = rdtsc();
+      return Reading{before + (after - before) / 2, ts.tv_sec * NANOS_TO_SECS + ts.tv_nsec};
+    }
+
+    static auto initialCalibration() noexcept -> const std::pair<Reading, double> & {
+      static const auto calibration = []() {
+        const auto first = readRealtime();
+        std::this_thread::sleep_for(std::chrono::nanoseconds(TSC_CLOCK_INITIAL_CALIBRATION));
+        const auto second = readRealtime();
+        return std::make_pair(first, static_cast<double>(second.nanos_ - first.nanos_) / static_cast<double>(second.tsc_ - first.tsc_));
+      }();
+      return calibration;
+    }
+
+    auto recalibrate() noexcept -> void {
+      const auto now = readRealtime();
+      const auto nanos_per_tick = static_cast<double>(now.nanos_ - first_.nanos_) / static_cast<double>(now.tsc_ - first_.tsc_);
+      if (std::abs(nanos_per_tick / nanos_per_tick_ - 1.0) < TSC_CLOCK_MAX_RATE_CHANGE) {
+        nanos_per_tick_ = nanos_per_tick;
+        recalibration_interval_ = std::min(recalibration_interval_ * 2, TSC_CLOCK_RECALIBRATION_INTERVAL);
+      } else {
+        first_ = now;
+        recalibration_interval_ = TSC_CLOCK_INITIAL_CALIBRATION;
+      }
+      base_ = now;
+      next_calibration_tsc_ = now.tsc_ + static_cast<uint64_t>(static_cast<double>(recalibration_interval_) / nanos_per_tick_);
+    }
+
+    /// Start of the baseline the rate is measured over.
+    Reading first_;
+
+    /// Reading the current time is extrapolated from.
+    Reading base_;
+    double nanos_per_tick_ = 0;
+    Nanos recalibration_interval_ = TSC_CLOCK_INITIAL_CALIBRATION;
+    uint64_t next_calibration_tsc_ = 0;
+  };
+
+  /// The calling thread's TscClock, each thread calibrates its own so that reading the clock never touches shared state.
+  inline auto tscClock() noexcept -> TscClock & {
+    static thread_local TscClock clock;
+    return clock;
+  }
+
+  /// Get current nanosecond timestamp from the calling thread's TscClock, for hot paths.
+  inline auto getCurrentTscNanos() noexcept {
+    return tscClock().nanos();
+  }
+
+  /// Size of the buffer formatTimeStr() writes to, including the terminating null.
+  constexpr size_t TIME_STR_SIZE = 24;
+
+  /// Format a nanosecond timestamp as local time HH:MM:SS.nnnnnnnnn into a buffer of TIME_STR_SIZE chars.
+  inline auto formatTimeStr(Nanos nanos, char *buffer) noexcept -> char * {
+    const time_t time = nanos / NANOS_TO_SECS;
+    tm local_time;
+    localtime_r(&time, &local_time);
+    const auto length = strftime(buffer, TIME_STR_SIZE, "%H:%M:%S", &local_time);
+    snprintf(buffer + length, TIME_STR_SIZE - length, ".%09ld", nanos % NANOS_TO_SECS);
+    return buffer;
+  }
+
   /// Format current timestamp to a human readable string.
   /// String formatting is inefficient.
   inline auto& getCurrentTimeStr(std::string* time_str) {
-    const auto clock = std::chrono::system_clock::now();
-    const auto time = std::chrono::system_clock::to_time_t(clock);
-
-    char nanos_str[24];
-    sprintf(nanos_str, "%.8s.%09ld", ctime(&time) + 11, std::chrono::duration_cast<std::chrono::nanoseconds>(clock.time_since_epoch()).count() % NANOS_TO_SECS);
-    time_str->assign(nanos_str);
+    char nanos_str[TIME_STR_SIZE];
+    time_str->assign(formatTimeStr(getCurrentNanos(), nanos_str));
 
     return *time_str;
   }
+
+  /// Timestamp argument to the loggers' log(), recorded as raw nanoseconds and only formatted like getCurrentTimeStr() by the
+  /// logger's background thread.
+  struct LogTime {
+    Nanos nanos_ = 0;
+  };
+
+  /// Current timestamp to pass to log() in place of getCurrentTimeStr().
+  inline auto getCurrentLogTime() noexcept {
+    return LogTime{getCurrentTscNanos()};
+  }
 }
@@ -25,6 +25,16 @@ namespace Common {
   /// Maximum price level depth in the order books.
   constexpr size_t ME_MAX_PRICE_LEVELS = 256;
 
+  /// Maximum strategy instances hosted by a single TradeEngine, each owns an equal partition of the client's order ids.
+  constexpr size_t TE_MAX_STRATEGIES = 16;
+
+  /// Number of client order ids in each strategy instance's partition, strategy i uses [i * TE_STRATEGY_ORDER_IDS, (i + 1) * TE_STRATEGY_ORDER_IDS).
+  constexpr size_t TE_STRATEGY_ORDER_IDS = ME_MAX_ORDER_IDS / TE_MAX_STRATEGIES;
+
+  /// Cores the MatchingEngine and TradeEngine threads are pinned to, their order books and queues are bound to the NUMA node of these cores.
+  constexpr int ME_CORE_ID = 2;
+  constexpr int TE_CORE_ID = 6;
+
   typedef uint64_t OrderId;
   constexpr auto OrderId_INVALID = std::numeric_limits<OrderId>::max();
 
@@ -179,6 +189,24 @@ namespace Common {
     }
   };
 
+  /// Portfolio level risk limits of a strategy instance, applied to the notional summed across all tickers.
+  /// Gross notional counts the absolute value of every position and working order, net notional lets opposite sides offset.
+  struct PortfolioRiskCfg {
+    double max_gross_notional_ = std::numeric_limits<double>::max();
+    double max_net_notional_ = std::numeric_limits<double>::max();
+
+    auto toString() const {
+      std::stringstream ss;
+
+      ss << "PortfolioRiskCfg{"
+         << "max-gross-notional:" << max_gross_notional_ << " "
+         << "max-net-notional:" << max_net_notional_
+         << "}";
+
+      return ss.str();
+    }
+  };
+
   /// Top level configuration to configure the TradeEngine, trading algorithm and RiskManager.
   struct TradeEngineCfg {
     Qty clip_ = 0;
@@ -199,4 +227,23 @@ namespace Common {
 
   /// Hash map from TickerId -> TradeEngineCfg.
   typedef std::array<TradeEngineCfg, ME_MAX_TICKERS> TradeEngineCfgHashMap;
+
+  /// Configuration of a single strategy instance in a TradeEngine, the trading algorithm and its per-ticker configuration.
+  struct StrategyCfg {
+    AlgoType algo_type_ = AlgoType::INVALID;
+    TradeEngineCfgHashMap ticker_cfg_;
+    PortfolioRiskCfg portfolio_risk_cfg_;
+
+    auto toString() const {
+      std::stringstream ss;
+      ss << "StrategyCfg{"
+         << "algo:" << algoTypeToString(algo_type_) << " "
+         << "ticker-cfg:[";
+      for (TickerId i = 0; i < ticker_cfg_.size(); ++i)
+        ss << i << ":" << ticker_cfg_[i].toString() << " ";
+      ss << "] portfolio-risk:" << portfolio_risk_cfg_.toString() << "}";
+
+      return ss.str();
+    }
+  };
 }
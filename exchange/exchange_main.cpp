@@ -5,7 +5,7 @@
 #include "order_server/order_server.h"
 
 /// 主要组件，设为全局变量以便信号处理器访问
-Common::Logger *logger = nullptr;
+Common::BinLogger *logger = nullptr;
 Exchange::MatchingEngine *matching_engine = nullptr;
 Exchange::MarketDataPublisher *market_data_publisher = nullptr;
 Exchange::OrderServer *order_server = nullptr;
@@ -27,36 +27,56 @@ void signal_handler(int) {
 
   std::this_thread::sleep_for(10s);  // 等待释放完成
 
+  Common::dumpLatencyHistograms("exchange_main_latency.txt");  // 退出前写出最终的延迟直方图
+
   exit(EXIT_SUCCESS);
 }
 
-int main(int, char **) {
-  logger = new Common::Logger("exchange_main.log");  // 创建主日志器
+/// 用法：exchange_main [ORDER|LEVEL] [BBO_INTERVAL_MICROS] [FIXED|COMPACT]
+/// 可选参数指定快照模式：ORDER（默认，逐订单快照）或 LEVEL（按价格档位聚合的L2快照），
+/// BBO流的最小发布间隔（微秒），0（默认）表示每处理完一批市场更新即发布，
+/// 以及增量流的线路格式：FIXED（默认，定长MDPMarketUpdate）或 COMPACT（按包增量编码）
+int main(int argc, char **argv) {
+  logger = new Common::BinLogger("exchange_main.log");  // 创建主日志器
 
   std::signal(SIGINT, signal_handler);  // 注册信号处理器（处理Ctrl+C等中断信号）
 
-  const int sleep_time = 100 * 1000;  // 主循环休眠时间（微秒）
+  // 每60秒及收到SIGUSR1时将各测量标签的延迟分位数追加写入文件
+  Common::startLatencyHistogramDumper("exchange_main_latency.txt", 60);
 
-  // 无锁队列，用于订单服务器与匹配引擎、匹配引擎与市场数据发布器之间的通信
-  Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
-  Exchange::ClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
-  Exchange::MEMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
+  const int sleep_time = 100 * 1000;  // 主循环休眠时间（微秒）
 
-  std::string time_str;
+  // 无锁队列，用于订单服务器与匹配引擎之间的通信，以及匹配引擎向市场数据发布器和快照合成器广播市场更新
+  // 队列的存储绑定到匹配引擎线程所在核心的NUMA节点，匹配引擎是每个队列的一端
+  Exchange::ClientRequestLFQueue *client_requests = nullptr;
+  Exchange::ClientResponseLFQueue *client_responses = nullptr;
+  Exchange::MEMarketUpdateBroadcastQueue *market_updates = nullptr;
+  {
+    Common::HugePageNumaScope numa_scope(Common::numaNodeOfCore(Common::ME_CORE_ID));
+    client_requests = new Exchange::ClientRequestLFQueue(ME_MAX_CLIENT_UPDATES);
+    client_responses = new Exchange::ClientResponseLFQueue(ME_MAX_CLIENT_UPDATES);
+    market_updates = new Exchange::MEMarketUpdateBroadcastQueue(ME_MAX_MARKET_UPDATES);
+  }
 
   // 启动匹配引擎
-  logger->log("%:% %() % 启动匹配引擎...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-  matching_engine = new Exchange::MatchingEngine(&client_requests, &client_responses, &market_updates);
+  logger->log("%:% %() % 启动匹配引擎...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
+  matching_engine = new Exchange::MatchingEngine(client_requests, client_responses, market_updates);
   matching_engine->start();
 
   // 市场数据发布器配置
   const std::string mkt_pub_iface = "lo";
-  const std::string snap_pub_ip = "233.252.14.1", inc_pub_ip = "233.252.14.3";
-  const int snap_pub_port = 20000, inc_pub_port = 20001;
-
-  // 启动市场数据发布器
-  logger->log("%:% %() % 启动市场数据发布器...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-  market_data_publisher = new Exchange::MarketDataPublisher(&market_updates, mkt_pub_iface, snap_pub_ip, snap_pub_port, inc_pub_ip, inc_pub_port);
+  const std::string snap_pub_ip = "233.252.14.1", inc_pub_ip = "233.252.14.3", bbo_pub_ip = "233.252.14.5";
+  const int snap_pub_port = 20000, inc_pub_port = 20001, bbo_pub_port = 20002;
+  const auto snapshot_mode = (argc > 1 ? Exchange::stringToSnapshotMode(argv[1]) : Exchange::SnapshotMode::ORDER);
+  const Common::Nanos bbo_publish_interval = (argc > 2 ? atol(argv[2]) : 0) * Common::NANOS_TO_MICROS;
+  const auto wire_format = (argc > 3 ? Exchange::stringToMDWireFormat(argv[3]) : Exchange::MDWireFormat::FIXED);
+
+  // 启动市场数据发布器，发布器和快照合成器在构造时加入广播队列的读取者，早于订单服务器启动，即早于匹配引擎写入第一条市场更新
+  logger->log("%:% %() % 启动市场数据发布器 快照模式:% BBO发布间隔:%ns 增量格式:%...\n", __FILE__, __LINE__, __FUNCTION__,
+              Common::getCurrentLogTime(), Exchange::snapshotModeToString(snapshot_mode), bbo_publish_interval,
+              Exchange::mdWireFormatToString(wire_format));
+  market_data_publisher = new Exchange::MarketDataPublisher(market_updates, mkt_pub_iface, snap_pub_ip, snap_pub_port, inc_pub_ip, inc_pub_port,
+                                                            bbo_pub_ip, bbo_pub_port, bbo_publish_interval, snapshot_mode, wire_format);
   market_data_publisher->start();
 
   // 订单服务器配置
@@ -64,13 +84,15 @@ int main(int, char **) {
   const int order_gw_port = 12345;
 
   // 启动订单服务器
-  logger->log("%:% %() % 启动订单服务器...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-  order_server = new Exchange::OrderServer(&client_requests, &client_responses, order_gw_iface, order_gw_port);
+  logger->log("%:% %() % 启动订单服务器...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
+  order_server = new Exchange::OrderServer(client_requests, client_responses, order_gw_iface, order_gw_port);
   order_server->start();
 
+  logger->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), Common::hugePageSummary().c_str());
+
   // 主循环：持续运行并定期打印日志
   while (true) {
-    logger->log("%:% %() % 休眠几毫秒..\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+    logger->log("%:% %() % 休眠几毫秒..\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
     usleep(sleep_time * 1000);  // 休眠指定时间
   }
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "bbo_publisher.h"
+
+namespace Exchange {
+  BBOPublisher::BBOPublisher(BinLogger *logger, const std::string &iface, const std::string &bbo_ip, int bbo_port, Nanos publish_interval)
+      : publish_interval_(publish_interval), logger_(logger), bbo_socket_(*logger) {
+    // 初始化BBO多播 socket
+    ASSERT(bbo_socket_.init(bbo_ip, iface, bbo_port, /*is_listening*/ false) >= 0,
+           "无法创建BBO多播 socket。错误：" + std::string(std::strerror(errno)));
+    // 初始化每个股票上次发布的BBO
+    for (size_t ticker_id = 0; ticker_id < ticker_books_.size(); ++ticker_id)
+      ticker_books_.at(ticker_id).last_published_.ticker_id_ = static_cast<TickerId>(ticker_id);
+  }
+
+  // 根据一条市场更新增量更新对应股票的价格档位和最优报价
+  auto BBOPublisher::onMarketUpdate(const MEMarketUpdate *market_update) noexcept -> void {
+    auto &book = ticker_books_.at(market_update->ticker_id_);
+
+    switch (market_update->type_) {
+      case MarketUpdateType::ADD:
+        updateLevel(book, market_update->side_, market_update->price_, market_update->qty_);
+        break;
+      case MarketUpdateType::CANCEL:
+        // CANCEL 携带订单被移除时的剩余数量，成交部分已在 TRADE 中扣除
+        updateLevel(book, market_update->side_, market_update->price_, -static_cast<int64_t>(market_update->qty_));
+        break;
+      case MarketUpdateType::TRADE:
+        // TRADE 的 side_ 为主动方，成交数量从被动方档位中扣除
+        updateLevel(book, market_update->side_ == Side::BUY ? Side::SELL : Side::BUY, market_update->price_,
+                    -static_cast<int64_t>(market_update->qty_));
+        break;
+      case MarketUpdateType::MODIFY:  // 部分成交后的剩余数量，已在 TRADE 中处理
+      case MarketUpdateType::CLEAR:
+      case MarketUpdateType::SNAPSHOT_START:
+      case MarketUpdateType::SNAPSHOT_END:
+      case MarketUpdateType::LEVEL:
+      case MarketUpdateType::INVALID:
+        break;
+    }
+  }
+
+  // 调整指定档位的数量，并在档位变为最优或最优档位被清空时更新最优价格
+  auto BBOPublisher::updateLevel(BBOBook &book, Side side, Price price, int64_t qty_delta) noexcept -> void {
+    auto &level = book.levels_.at(sideToIndex(side)).at(price % ME_MAX_PRICE_LEVELS);
+    // 断言：同一价格索引上不存在其他价格的档位
+    if (UNLIKELY(level.qty_ && level.price_ != price))
+      FATAL("BBO价格档位冲突 现有价格:" + priceToString(level.price_) + " 新价格:" + priceToString(price));
+
+    level.price_ = price;
+    level.qty_ = static_cast<Qty>(static_cast<int64_t>(level.qty_) + qty_delta);
+
+    auto &best_price = (side == Side::BUY ? book.best_bid_price_ : book.best_ask_price_);
+    const auto old_best_price = best_price;
+    if (level.qty_) {
+      // 档位价格优于当前最优价格时成为新的最优档位
+      if (best_price == Price_INVALID || (side == Side::BUY ? price > best_price : price < best_price))
+        best_price = price;
+    } else if (price == best_price) {
+      best_price = findBestPrice(book, side);
+    }
+
+    // 仅最优价格或最优档位数量的变化会影响BBO
+    if (best_price != old_best_price || price == best_price) {
+      if (!book.dirty_) {
+        book.dirty_ = true;
+        ++num_dirty_;
+      }
+    }
+  }
+
+  // 最优档位被清空后，扫描所有档位找到新的最优价格
+  auto BBOPublisher::findBestPrice(const BBOBook &book, Side side) const noexcept -> Price {
+    auto best_price = Price_INVALID;
+    for (const auto &level : book.levels_.at(sideToIndex(side))) {
+      if (level.qty_ && (best_price == Price_INVALID || (side == Side::BUY ? level.price_ > best_price : level.price_ < best_price)))
+        best_price = level.price_;
+    }
+    return best_price;
+  }
+
+  // 若到达发布间隔，则为每个最优报价发生变化的股票发布一条BBO更新
+  auto BBOPublisher::publish() noexcept -> void {
+    if (!num_dirty_)
+      return;
+
+    const auto now = getCurrentTscNanos();
+    if (publish_interval_ && now - last_publish_time_ < publish_interval_)
+      return;
+    last_publish_time_ = now;
+
+    for (auto &book : ticker_books_) {
+      if (!book.dirty_)
+        continue;
+      book.dirty_ = false;
+
+      const auto &bids = book.levels_.at(sideToIndex(Side::BUY));
+      const auto &asks = book.levels_.at(sideToIndex(Side::SELL));
+      const auto bid_qty = (book.best_bid_price_ != Price_INVALID ? bids.at(book.best_bid_price_ % ME_MAX_PRICE_LEVELS).qty_ : Qty_INVALID);
+      const auto ask_qty = (book.best_ask_price_ != Price_INVALID ? asks.at(book.best_ask_price_ % ME_MAX_PRICE_LEVELS).qty_ : Qty_INVALID);
+
+      // 合并后报价未变化则不发布
+      auto &bbo_update = book.last_published_;
+      if (bbo_update.bid_price_ == book.best_bid_price_ && bbo_update.bid_qty_ == bid_qty &&
+          bbo_update.ask_price_ == book.best_ask_price_ && bbo_update.ask_qty_ == ask_qty)
+        continue;
+
+      bbo_update.seq_num_ = next_bbo_seq_num_++;
+      bbo_update.bid_price_ = book.best_bid_price_;
+      bbo_update.bid_qty_ = bid_qty;
+      bbo_update.ask_price_ = book.best_ask_price_;
+      bbo_update.ask_qty_ = ask_qty;
+
+      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime(), bbo_update);
+      bbo_socket_.send(&bbo_update, sizeof(MDPBBOUpdate));
+    }
+    num_dirty_ = 0;
+
+    // 发布数据到多播流
+    bbo_socket_.sendAndRecv();
+  }
+}
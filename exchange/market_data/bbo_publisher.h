@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common/types.h"
+#include "common/macros.h"
+#include "common/mcast_socket.h"
+#include "common/bin_logging.h"
+#include "common/time_utils.h"
+
+#include "market_data/market_update.h"
+
+using namespace Common;
+
+namespace Exchange {
+  // 单个价格档位的总挂单数量
+  struct BBOLevel {
+    Price price_ = Price_INVALID;  // 档位价格
+    Qty qty_ = 0;                  // 档位总数量
+  };
+
+  // 从价格索引到BBOLevel的哈希映射，按买卖方向展开
+  typedef std::array<BBOLevel, ME_MAX_PRICE_LEVELS> BBOLevelHashMap;
+  typedef std::array<BBOLevelHashMap, sideToIndex(Side::MAX) + 1> BBOLevelSideHashMap;
+
+  // 单个股票的价格档位、当前最优档位以及上次发布的BBO
+  struct BBOBook {
+    BBOLevelSideHashMap levels_;
+    Price best_bid_price_ = Price_INVALID;
+    Price best_ask_price_ = Price_INVALID;
+
+    MDPBBOUpdate last_published_;  // 上次发布的BBO，用于过滤未变化的报价
+    bool dirty_ = false;           // 自上次发布以来最优档位是否可能变化
+  };
+
+  // 从撮合引擎的增量市场更新中增量维护每个股票的最优买卖报价，并在BBO多播流上合并发布
+  // 由 MarketDataPublisher 拥有并在其线程上调用，不单独占用线程
+  class BBOPublisher {
+  public:
+    // publish_interval 为两次发布之间的最小间隔（纳秒），0 表示每处理完一批市场更新即发布
+    BBOPublisher(BinLogger *logger, const std::string &iface, const std::string &bbo_ip, int bbo_port, Nanos publish_interval);
+
+    // 根据一条市场更新增量更新对应股票的价格档位和最优报价
+    auto onMarketUpdate(const MEMarketUpdate *market_update) noexcept -> void;
+
+    // 若到达发布间隔，则为每个最优报价发生变化的股票发布一条BBO更新
+    auto publish() noexcept -> void;
+
+    BBOPublisher() = delete;
+    BBOPublisher(const BBOPublisher &) = delete;
+    BBOPublisher(const BBOPublisher &&) = delete;
+    BBOPublisher &operator=(const BBOPublisher &) = delete;
+    BBOPublisher &operator=(const BBOPublisher &&) = delete;
+
+  private:
+    // 调整指定档位的数量，并在档位变为最优或最优档位被清空时更新最优价格
+    auto updateLevel(BBOBook &book, Side side, Price price, int64_t qty_delta) noexcept -> void;
+
+    // 最优档位被清空后，扫描所有档位找到新的最优价格
+    auto findBestPrice(const BBOBook &book, Side side) const noexcept -> Price;
+
+    const Nanos publish_interval_;
+    Nanos last_publish_time_ = 0;
+
+    size_t next_bbo_seq_num_ = 1;
+    size_t num_dirty_ = 0;  // 待发布的股票数量
+
+    std::array<BBOBook, ME_MAX_TICKERS> ticker_books_;
+
+    BinLogger *logger_ = nullptr;
+
+    McastSocket bbo_socket_;
+  };
+}
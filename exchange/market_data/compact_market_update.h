@@ -0,0 +1,296 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+
+#include "common/types.h"
+#include "common/macros.h"
+
+#include "market_update.h"
+
+using namespace Common;
+
+namespace Exchange {
+  // 增量市场数据流的线路格式：FIXED 为定长的 MDPMarketUpdate，COMPACT 为按包增量编码的紧凑格式
+  enum class MDWireFormat : uint8_t {
+    FIXED = 0,
+    COMPACT = 1
+  };
+
+  inline std::string mdWireFormatToString(MDWireFormat format) {
+    switch (format) {
+      case MDWireFormat::FIXED:
+        return "FIXED";
+      case MDWireFormat::COMPACT:
+        return "COMPACT";
+    }
+    return "UNKNOWN";
+  }
+
+  inline MDWireFormat stringToMDWireFormat(const std::string &str) {
+    return (str == "COMPACT" ? MDWireFormat::COMPACT : MDWireFormat::FIXED);
+  }
+
+  // 紧凑格式的版本号，解码端拒绝不认识的版本
+  constexpr uint8_t COMPACT_MD_VERSION = 1;
+
+  // 单个包最多包含的市场更新数，保证最大包长小于一个UDP数据报
+  constexpr size_t COMPACT_MD_MAX_UPDATES_PER_PACKET = 1024;
+
+#pragma pack(push, 1)
+
+  // 紧凑格式包头，包内市场更新的序列号从 base_seq_num_ 开始连续递增
+  // base_price_ 和 base_order_id_ 为包内首个出现的价格和订单ID，后续字段编码为相对前一个值的差值
+  struct CompactPacketHeader {
+    uint8_t version_ = COMPACT_MD_VERSION;  // 格式版本
+    uint16_t num_updates_ = 0;              // 包内市场更新数
+    uint32_t size_ = 0;                     // 包总字节数（含包头）
+    size_t base_seq_num_ = 0;               // 首个市场更新的序列号
+    Price base_price_ = 0;                  // 价格基准
+    OrderId base_order_id_ = 0;             // 订单ID基准
+  };
+
+#pragma pack(pop)
+
+  // 每个市场更新编码为：1字节类型 + 1字节字段存在位图 + 存在的字段
+  // 值为无效值（如 TRADE 的订单ID和优先级）的字段不编码，解码时还原为无效值，因此可以精确往返
+  enum CompactField : uint8_t {
+    COMPACT_FIELD_ORDER_ID = 1 << 0,  // zigzag varint，相对前一个订单ID的差值
+    COMPACT_FIELD_TICKER_ID = 1 << 1, // varint
+    COMPACT_FIELD_SIDE = 1 << 2,      // 1字节
+    COMPACT_FIELD_PRICE = 1 << 3,     // zigzag varint，相对前一个价格的差值
+    COMPACT_FIELD_QTY = 1 << 4,       // varint
+    COMPACT_FIELD_PRIORITY = 1 << 5   // varint
+  };
+
+  // 单个市场更新编码后的最大字节数
+  constexpr size_t COMPACT_MD_MAX_UPDATE_SIZE = 1 + 1 + 10 + 5 + 1 + 10 + 5 + 10;
+
+  // 单个包的最大字节数
+  constexpr size_t COMPACT_MD_MAX_PACKET_SIZE = sizeof(CompactPacketHeader) + COMPACT_MD_MAX_UPDATES_PER_PACKET * COMPACT_MD_MAX_UPDATE_SIZE;
+
+  // 写入无符号 LEB128 varint
+  inline auto writeVarint(char *&out, uint64_t value) noexcept {
+    while (value >= 0x80) {
+      *out++ = static_cast<char>(value | 0x80);
+      value >>= 7;
+    }
+    *out++ = static_cast<char>(value);
+  }
+
+  // 读取无符号 LEB128 varint，不读取 end 及其之后的字节
+  // 数据在 end 之前截断或 varint 超过10字节时返回 false，此时 in 和 value 的值无意义
+  inline auto readVarint(const char *&in, const char *end, uint64_t *value) noexcept -> bool {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (UNLIKELY(in == end))
+        return false;
+      const auto byte = static_cast<uint8_t>(*in++);
+      result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // 有符号差值与无符号值之间的 zigzag 映射，使绝对值小的差值编码为短 varint
+  inline constexpr auto zigzagEncode(int64_t value) noexcept -> uint64_t {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  }
+
+  inline constexpr auto zigzagDecode(uint64_t value) noexcept -> int64_t {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  // 将一批序列号连续的 MEMarketUpdate 编码为一个紧凑格式包
+  class CompactMarketUpdateEncoder {
+  public:
+    // 开始一个新包，base_seq_num 为包内首个市场更新的序列号
+    auto reset(size_t base_seq_num) noexcept {
+      header_ = CompactPacketHeader{};
+      header_.base_seq_num_ = base_seq_num;
+      next_ = buffer_ + sizeof(CompactPacketHeader);
+      have_base_price_ = have_base_order_id_ = false;
+    }
+
+    auto empty() const noexcept {
+      return header_.num_updates_ == 0;
+    }
+
+    auto full() const noexcept {
+      return header_.num_updates_ >= COMPACT_MD_MAX_UPDATES_PER_PACKET;
+    }
+
+    // 将一个市场更新追加到当前包
+    auto add(const MEMarketUpdate &market_update) noexcept {
+      if (UNLIKELY(full()))
+        FATAL("紧凑格式包已满：" + std::to_string(header_.num_updates_));
+
+      auto out = next_;
+      *out++ = static_cast<char>(market_update.type_);
+      auto fields = out++;
+      uint8_t mask = 0;
+
+      if (market_update.order_id_ != OrderId_INVALID) {
+        if (UNLIKELY(!have_base_order_id_)) {
+          header_.base_order_id_ = last_order_id_ = market_update.order_id_;
+          have_base_order_id_ = true;
+        }
+        writeVarint(out, zigzagEncode(static_cast<int64_t>(market_update.order_id_ - last_order_id_)));
+        last_order_id_ = market_update.order_id_;
+        mask |= COMPACT_FIELD_ORDER_ID;
+      }
+      if (market_update.ticker_id_ != TickerId_INVALID) {
+        writeVarint(out, market_update.ticker_id_);
+        mask |= COMPACT_FIELD_TICKER_ID;
+      }
+      if (market_update.side_ != Side::INVALID) {
+        *out++ = static_cast<char>(market_update.side_);
+        mask |= COMPACT_FIELD_SIDE;
+      }
+      if (market_update.price_ != Price_INVALID) {
+        if (UNLIKELY(!have_base_price_)) {
+          header_.base_price_ = last_price_ = market_update.price_;
+          have_base_price_ = true;
+        }
+        writeVarint(out, zigzagEncode(static_cast<int64_t>(static_cast<uint64_t>(market_update.price_) - static_cast<uint64_t>(last_price_))));
+        last_price_ = market_update.price_;
+        mask |= COMPACT_FIELD_PRICE;
+      }
+      if (market_update.qty_ != Qty_INVALID) {
+        writeVarint(out, market_update.qty_);
+        mask |= COMPACT_FIELD_QTY;
+      }
+      if (market_update.priority_ != Priority_INVALID) {
+        writeVarint(out, market_update.priority_);
+        mask |= COMPACT_FIELD_PRIORITY;
+      }
+
+      *fields = static_cast<char>(mask);
+      next_ = out;
+      ++header_.num_updates_;
+    }
+
+    // 写入包头并返回包的总字节数
+    auto finish() noexcept -> size_t {
+      header_.size_ = static_cast<uint32_t>(next_ - buffer_);
+      memcpy(buffer_, &header_, sizeof(CompactPacketHeader));
+      return header_.size_;
+    }
+
+    auto data() const noexcept -> const char * {
+      return buffer_;
+    }
+
+  private:
+    CompactPacketHeader header_;
+    char *next_ = buffer_ + sizeof(CompactPacketHeader);
+
+    bool have_base_price_ = false, have_base_order_id_ = false;
+    Price last_price_ = 0;
+    OrderId last_order_id_ = 0;
+
+    char buffer_[COMPACT_MD_MAX_PACKET_SIZE];
+  };
+
+  // 包头是否可信：版本可识别，且包长和更新数在编码端可能产生的范围内
+  // 包头不可信时无法确定包的边界
+  inline auto isValidCompactPacketHeader(const CompactPacketHeader &header) noexcept {
+    return header.version_ == COMPACT_MD_VERSION && header.num_updates_ <= COMPACT_MD_MAX_UPDATES_PER_PACKET &&
+           header.size_ >= sizeof(CompactPacketHeader) + 2 * header.num_updates_ && header.size_ <= COMPACT_MD_MAX_PACKET_SIZE;
+  }
+
+  // 将包头之后 [in, end) 的包体解码到 updates，包体恰好包含 header.num_updates_ 个合法的市场更新时返回 true
+  // 任何字段读取都不越过 end，类型、方向或股票ID超出范围、包体提前结束或有多余字节时返回 false
+  inline auto decodeCompactPacket(const CompactPacketHeader &header, const char *in, const char *end, MDPMarketUpdate *updates) noexcept -> bool {
+    auto last_price = header.base_price_;
+    auto last_order_id = header.base_order_id_;
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < header.num_updates_; ++i) {
+      auto &update = updates[i];
+      auto &me_update = update.me_market_update_;
+      update.seq_num_ = header.base_seq_num_ + i;
+      me_update = MEMarketUpdate{};
+
+      if (UNLIKELY(end - in < 2))
+        return false;
+      me_update.type_ = static_cast<MarketUpdateType>(*in++);
+      const auto mask = static_cast<uint8_t>(*in++);
+      if (UNLIKELY(me_update.type_ == MarketUpdateType::INVALID || me_update.type_ > MarketUpdateType::LEVEL))
+        return false;
+
+      if (mask & COMPACT_FIELD_ORDER_ID) {
+        if (UNLIKELY(!readVarint(in, end, &value)))
+          return false;
+        me_update.order_id_ = last_order_id = last_order_id + static_cast<uint64_t>(zigzagDecode(value));
+      }
+      if (mask & COMPACT_FIELD_TICKER_ID) {
+        if (UNLIKELY(!readVarint(in, end, &value) || value >= ME_MAX_TICKERS))
+          return false;
+        me_update.ticker_id_ = static_cast<TickerId>(value);
+      }
+      if (mask & COMPACT_FIELD_SIDE) {
+        if (UNLIKELY(in == end))
+          return false;
+        me_update.side_ = static_cast<Side>(*in++);
+        if (UNLIKELY(me_update.side_ != Side::BUY && me_update.side_ != Side::SELL))
+          return false;
+      }
+      if (mask & COMPACT_FIELD_PRICE) {
+        if (UNLIKELY(!readVarint(in, end, &value)))
+          return false;
+        me_update.price_ = last_price = static_cast<Price>(static_cast<uint64_t>(last_price) + static_cast<uint64_t>(zigzagDecode(value)));
+      }
+      if (mask & COMPACT_FIELD_QTY) {
+        if (UNLIKELY(!readVarint(in, end, &value)))
+          return false;
+        me_update.qty_ = static_cast<Qty>(value);
+      }
+      if (mask & COMPACT_FIELD_PRIORITY) {
+        if (UNLIKELY(!readVarint(in, end, &value)))
+          return false;
+        me_update.priority_ = static_cast<Priority>(value);
+      }
+    }
+
+    return in == end;
+  }
+
+  // 解码 data 中所有完整的紧凑格式包，对每个市场更新调用 on_update(const MDPMarketUpdate &)
+  // 返回已消费的字节数，末尾不完整的包留待下次接收更多数据后解码
+  // 数据来自不可信的多播流：包体损坏的包整体丢弃，不回调其中任何更新；包头损坏时无法确定包边界，丢弃剩余的全部数据
+  // 丢弃的包数累加到 num_dropped（如果提供），丢包造成的序列号缺口由调用方的快照恢复处理
+  template<typename F>
+  inline auto decodeCompactPackets(const char *data, size_t len, F &&on_update, size_t *num_dropped = nullptr) noexcept -> size_t {
+    // 先将整个包解码到暂存区，校验通过后再回调，避免损坏的包只回调了一部分更新
+    thread_local std::array<MDPMarketUpdate, COMPACT_MD_MAX_UPDATES_PER_PACKET> updates;
+
+    size_t consumed = 0;
+    while (len - consumed >= sizeof(CompactPacketHeader)) {
+      CompactPacketHeader header;
+      memcpy(&header, data + consumed, sizeof(CompactPacketHeader));
+      if (UNLIKELY(!isValidCompactPacketHeader(header))) {
+        if (num_dropped)
+          ++*num_dropped;
+        return len;
+      }
+      if (len - consumed < header.size_)
+        break;
+
+      const auto packet = data + consumed;
+      consumed += header.size_;
+      if (UNLIKELY(!decodeCompactPacket(header, packet + sizeof(CompactPacketHeader), packet + header.size_, updates.data()))) {
+        if (num_dropped)
+          ++*num_dropped;
+        continue;
+      }
+
+      for (size_t i = 0; i < header.num_updates_; ++i)
+        on_update(updates[i]);
+    }
+    return consumed;
+  }
+}
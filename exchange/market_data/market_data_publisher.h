@@ -3,13 +3,17 @@
 #include <functional>
 
 #include "market_data/snapshot_synthesizer.h"
+#include "market_data/bbo_publisher.h"
+#include "market_data/compact_market_update.h"
 
 namespace Exchange {
   class MarketDataPublisher {
   public:
-    MarketDataPublisher(MEMarketUpdateLFQueue *market_updates, const std::string &iface,
+    MarketDataPublisher(MEMarketUpdateBroadcastQueue *market_updates, const std::string &iface,
                         const std::string &snapshot_ip, int snapshot_port,
-                        const std::string &incremental_ip, int incremental_port);
+                        const std::string &incremental_ip, int incremental_port,
+                        const std::string &bbo_ip, int bbo_port, Nanos bbo_publish_interval,
+                        SnapshotMode snapshot_mode = SnapshotMode::ORDER, MDWireFormat wire_format = MDWireFormat::FIXED);
 
     ~MarketDataPublisher() {
       stop();
@@ -19,6 +23,12 @@ namespace Exchange {
 
       delete snapshot_synthesizer_;
       snapshot_synthesizer_ = nullptr;
+
+      delete bbo_publisher_;
+      bbo_publisher_ = nullptr;
+
+      delete compact_encoder_;
+      compact_encoder_ = nullptr;
     }
 
     auto start() {
@@ -34,7 +44,7 @@ namespace Exchange {
 
       snapshot_synthesizer_->stop();
     }
-    // 从无锁队列消费匹配引擎的市场更新，发布到增量多播流，并转发给快照合成器
+    // 从广播队列消费匹配引擎的市场更新，发布到增量多播流，并转发给BBO发布器
     auto run() noexcept -> void;
 
     MarketDataPublisher() = delete;
@@ -44,19 +54,28 @@ namespace Exchange {
     MarketDataPublisher &operator=(const MarketDataPublisher &&) = delete;
 
   private:
+    // 以紧凑格式发送当前包并开始下一个包
+    auto flushCompactPacket() noexcept {
+      incremental_socket_.send(compact_encoder_->data(), compact_encoder_->finish());
+      compact_encoder_->reset(next_inc_seq_num_);
+    }
+
     size_t next_inc_seq_num_ = 1;
 
-    MEMarketUpdateLFQueue *outgoing_md_updates_ = nullptr;
+    const MDWireFormat wire_format_;
+    CompactMarketUpdateEncoder *compact_encoder_ = nullptr;
 
-    MDPMarketUpdateLFQueue snapshot_md_updates_;
+    // 匹配引擎市场更新广播队列中市场数据发布器的读取位置，快照合成器持有另一个独立的读取位置
+    MEMarketUpdateBroadcastQueue::Reader *outgoing_md_updates_ = nullptr;
 
     volatile bool run_ = false;
 
-    std::string time_str_;
-    Logger logger_;
+    BinLogger logger_;
 
     Common::McastSocket incremental_socket_;
 
     SnapshotSynthesizer *snapshot_synthesizer_ = nullptr;
+
+    BBOPublisher *bbo_publisher_ = nullptr;
   };
 }
@@ -4,6 +4,7 @@
 
 #include "common/types.h"
 #include "common/lf_queue.h"
+#include "common/broadcast_queue.h"
 
 using namespace Common;
 
@@ -17,7 +18,8 @@ namespace Exchange {
     CANCEL = 4,        // 取消订单
     TRADE = 5,         // 成交
     SNAPSHOT_START = 6,// 快照开始
-    SNAPSHOT_END = 7   // 快照结束
+    SNAPSHOT_END = 7,  // 快照结束
+    LEVEL = 8          // 价格档位聚合（仅出现在L2快照中）
   };
 
   // 将MarketUpdateType转换为字符串
@@ -37,6 +39,8 @@ namespace Exchange {
         return "SNAPSHOT_START";
       case MarketUpdateType::SNAPSHOT_END:
         return "SNAPSHOT_END";
+      case MarketUpdateType::LEVEL:
+        return "LEVEL";
       case MarketUpdateType::INVALID:
         return "INVALID";
     }
@@ -47,6 +51,8 @@ namespace Exchange {
 #pragma pack(push, 1)
 
   // 匹配引擎内部使用的市场更新结构
+  // CANCEL 的 qty_ 为订单被移除时的剩余数量（完全成交后移除时为0）
+  // LEVEL 的 qty_ 为该价格档位的总数量，priority_ 为该档位的订单数，order_id_ 无效
   struct MEMarketUpdate {
     MarketUpdateType type_ = MarketUpdateType::INVALID;  // 更新类型
 
@@ -91,9 +97,36 @@ namespace Exchange {
     }
   };
 
+  // 市场数据发布器在BBO多播流上发布的合并最优买卖报价结构
+  // 某一方无报价时价格和数量均为无效值
+  struct MDPBBOUpdate {
+    size_t seq_num_ = 0;                     // BBO流独立的序列号
+    TickerId ticker_id_ = TickerId_INVALID;  // 股票代码
+    Price bid_price_ = Price_INVALID;        // 买一价
+    Qty bid_qty_ = Qty_INVALID;              // 买一量
+    Price ask_price_ = Price_INVALID;        // 卖一价
+    Qty ask_qty_ = Qty_INVALID;              // 卖一量
+
+    // 将BBO更新信息转换为字符串
+    auto toString() const {
+      std::stringstream ss;
+      ss << "MDPBBOUpdate"
+         << " ["
+         << " seq:" << seq_num_
+         << " ticker:" << tickerIdToString(ticker_id_)
+         << " " << qtyToString(bid_qty_) << "@" << priceToString(bid_price_)
+         << "X" << priceToString(ask_price_) << "@" << qtyToString(ask_qty_)
+         << "]";
+      return ss.str();
+    }
+  };
+
 #pragma pack(pop) // 取消后续结构的紧凑打包指令
 
-  // 分别为匹配引擎市场更新消息和市场数据发布器市场更新消息的无锁队列
+  // 匹配引擎市场更新消息的无锁队列
   typedef Common::LFQueue<Exchange::MEMarketUpdate> MEMarketUpdateLFQueue;
-  typedef Common::LFQueue<Exchange::MDPMarketUpdate> MDPMarketUpdateLFQueue;
+
+  // 匹配引擎发布市场更新的广播队列：每条更新只写入一次，市场数据发布器和快照合成器等消费者各自按独立的读取位置读取
+  // 读取位置从0开始计数，与增量流序列号（从1开始）一一对应
+  typedef Common::BroadcastQueue<Exchange::MEMarketUpdate> MEMarketUpdateBroadcastQueue;
 }
\ No newline at end of file
@@ -1,9 +1,10 @@
 #include "snapshot_synthesizer.h"
 
 namespace Exchange {
-  SnapshotSynthesizer::SnapshotSynthesizer(MDPMarketUpdateLFQueue *market_updates, const std::string &iface,
-                                           const std::string &snapshot_ip, int snapshot_port)
-      : snapshot_md_updates_(market_updates), logger_("exchange_snapshot_synthesizer.log"), snapshot_socket_(logger_), order_pool_(ME_MAX_ORDER_IDS) {
+  SnapshotSynthesizer::SnapshotSynthesizer(MEMarketUpdateBroadcastQueue::Reader *market_updates, const std::string &iface,
+                                           const std::string &snapshot_ip, int snapshot_port, SnapshotMode snapshot_mode)
+      : snapshot_md_updates_(market_updates), logger_("exchange_snapshot_synthesizer.log"), snapshot_socket_(logger_),
+        snapshot_mode_(snapshot_mode), order_pool_(ME_MAX_ORDER_IDS) {
     // 初始化快照多播 socket
     ASSERT(snapshot_socket_.init(snapshot_ip, iface, snapshot_port, /*is_listening*/ false) >= 0,
            "无法创建快照多播 socket。错误：" + std::string(std::strerror(errno)));
@@ -27,9 +28,9 @@ namespace Exchange {
     run_ = false;
   }
 
-  // 处理增量市场更新并更新限价订单簿快照
-  auto SnapshotSynthesizer::addToSnapshot(const MDPMarketUpdate *market_update) {
-    const auto &me_market_update = market_update->me_market_update_;
+  // 处理增量流序列号为 seq_num 的市场更新并更新限价订单簿快照
+  auto SnapshotSynthesizer::addToSnapshot(size_t seq_num, const MEMarketUpdate *market_update) {
+    const auto &me_market_update = *market_update;
     auto *orders = &ticker_orders_.at(me_market_update.ticker_id_);  // 获取对应股票的订单数组
 
     // 根据市场更新类型处理
@@ -37,18 +38,26 @@ namespace Exchange {
       case MarketUpdateType::ADD: {
         auto order = orders->at(me_market_update.order_id_);
         // 断言：添加的订单不存在
-        ASSERT(order == nullptr, "收到：" + me_market_update.toString() + " 但订单已存在：" + (order ? order->toString() : ""));
+        if (UNLIKELY(order != nullptr))
+          FATAL("收到：" + me_market_update.toString() + " 但订单已存在：" + order->toString());
         // 从内存池分配订单并存储
         orders->at(me_market_update.order_id_) = order_pool_.allocate(me_market_update);
+        if (snapshot_mode_ == SnapshotMode::LEVEL)
+          updateLevel(me_market_update.ticker_id_, me_market_update.side_, me_market_update.price_, me_market_update.qty_, 1);
       }
         break;
       case MarketUpdateType::MODIFY: {
         auto order = orders->at(me_market_update.order_id_);
         // 断言：修改的订单存在且信息匹配
-        ASSERT(order != nullptr, "收到：" + me_market_update.toString() + " 但订单不存在。");
+        if (UNLIKELY(order == nullptr))
+          FATAL("收到：" + me_market_update.toString() + " 但订单不存在。");
         ASSERT(order->order_id_ == me_market_update.order_id_, "预期现有订单与新订单匹配。");
         ASSERT(order->side_ == me_market_update.side_, "预期现有订单与新订单匹配。");
 
+        if (snapshot_mode_ == SnapshotMode::LEVEL)
+          updateLevel(me_market_update.ticker_id_, order->side_, order->price_,
+                      static_cast<int64_t>(me_market_update.qty_) - static_cast<int64_t>(order->qty_), 0);
+
         // 更新订单数量和价格
         order->qty_ = me_market_update.qty_;
         order->price_ = me_market_update.price_;
@@ -57,10 +66,14 @@ namespace Exchange {
       case MarketUpdateType::CANCEL: {
         auto order = orders->at(me_market_update.order_id_);
         // 断言：取消的订单存在且信息匹配
-        ASSERT(order != nullptr, "收到：" + me_market_update.toString() + " 但订单不存在。");
+        if (UNLIKELY(order == nullptr))
+          FATAL("收到：" + me_market_update.toString() + " 但订单不存在。");
         ASSERT(order->order_id_ == me_market_update.order_id_, "预期现有订单与新订单匹配。");
         ASSERT(order->side_ == me_market_update.side_, "预期现有订单与新订单匹配。");
 
+        if (snapshot_mode_ == SnapshotMode::LEVEL)
+          updateLevel(me_market_update.ticker_id_, order->side_, order->price_, -static_cast<int64_t>(order->qty_), -1);
+
         // 释放订单并置空
         order_pool_.deallocate(order);
         orders->at(me_market_update.order_id_) = nullptr;
@@ -71,13 +84,26 @@ namespace Exchange {
       case MarketUpdateType::CLEAR:
       case MarketUpdateType::SNAPSHOT_END:
       case MarketUpdateType::TRADE:
+      case MarketUpdateType::LEVEL:
       case MarketUpdateType::INVALID:
         break;
     }
 
     // 断言：增量序列号连续递增
-    ASSERT(market_update->seq_num_ == last_inc_seq_num_ + 1, "预期增量序列号递增。");
-    last_inc_seq_num_ = market_update->seq_num_;  // 更新最后处理的序列号
+    ASSERT(seq_num == last_inc_seq_num_ + 1, "预期增量序列号递增。");
+    last_inc_seq_num_ = seq_num;  // 更新最后处理的序列号
+  }
+
+  // 按价格档位累加数量和订单数的变化，仅在 LEVEL 模式下使用
+  auto SnapshotSynthesizer::updateLevel(TickerId ticker_id, Side side, Price price, int64_t qty_delta, int64_t num_orders_delta) noexcept -> void {
+    auto &level = ticker_levels_.at(ticker_id).at(sideToIndex(side)).at(price % ME_MAX_PRICE_LEVELS);
+    // 断言：同一价格索引上不存在其他价格的档位
+    if (UNLIKELY(level.num_orders_ && level.price_ != price))
+      FATAL("价格档位冲突 ticker:" + tickerIdToString(ticker_id) + " 现有价格:" + priceToString(level.price_) + " 新价格:" + priceToString(price));
+
+    level.price_ = price;
+    level.qty_ = static_cast<Qty>(static_cast<int64_t>(level.qty_) + qty_delta);
+    level.num_orders_ = static_cast<Priority>(static_cast<int64_t>(level.num_orders_) + num_orders_delta);
   }
 
   // 在快照多播流上发布完整的快照周期
@@ -86,7 +112,7 @@ namespace Exchange {
 
     // 快照周期以 SNAPSHOT_START 消息开始，order_id_ 包含用于构建此快照的增量市场数据流的最后序列号
     const MDPMarketUpdate start_market_update{snapshot_size++, {MarketUpdateType::SNAPSHOT_START, last_inc_seq_num_}};
-    logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), start_market_update.toString());
+    logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime(), start_market_update);
     snapshot_socket_.send(&start_market_update, sizeof(MDPMarketUpdate));  // 发送开始消息
 
     // 为每个工具的限价订单簿中的每个订单发布订单信息
@@ -99,14 +125,30 @@ namespace Exchange {
 
       // 发布每个工具的订单信息前，先发布 CLEAR 消息，以便下游消费者清空订单簿
       const MDPMarketUpdate clear_market_update{snapshot_size++, me_market_update};
-      logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), clear_market_update.toString());
+      logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime(), clear_market_update);
       snapshot_socket_.send(&clear_market_update, sizeof(MDPMarketUpdate));  // 发送清除消息
 
+      if (snapshot_mode_ == SnapshotMode::LEVEL) {
+        // 每个非空价格档位发布一条聚合记录
+        for (const auto side : {Side::BUY, Side::SELL}) {
+          for (const auto &level : ticker_levels_.at(ticker_id).at(sideToIndex(side))) {
+            if (level.num_orders_) {
+              const MDPMarketUpdate market_update{snapshot_size++, {MarketUpdateType::LEVEL, OrderId_INVALID, static_cast<TickerId>(ticker_id), side,
+                                                                    level.price_, level.qty_, level.num_orders_}};
+              logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime(), market_update);
+              snapshot_socket_.send(&market_update, sizeof(MDPMarketUpdate));  // 发送档位信息
+              snapshot_socket_.sendAndRecv();  // 处理发送和接收
+            }
+          }
+        }
+        continue;
+      }
+
       // 发布每个订单
       for (const auto order: orders) {
         if (order) {
           const MDPMarketUpdate market_update{snapshot_size++, *order};
-          logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), market_update.toString());
+          logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime(), market_update);
           snapshot_socket_.send(&market_update, sizeof(MDPMarketUpdate));  // 发送订单信息
           snapshot_socket_.sendAndRecv();  // 处理发送和接收
         }
@@ -115,30 +157,32 @@ namespace Exchange {
 
     // 快照周期以 SNAPSHOT_END 消息结束，order_id_ 包含用于构建此快照的增量市场数据流的最后序列号
     const MDPMarketUpdate end_market_update{snapshot_size++, {MarketUpdateType::SNAPSHOT_END, last_inc_seq_num_}};
-    logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), end_market_update.toString());
+    logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime(), end_market_update);
     snapshot_socket_.send(&end_market_update, sizeof(MDPMarketUpdate));  // 发送结束消息
     snapshot_socket_.sendAndRecv();  // 处理发送和接收
 
-    logger_.log("%:% %() % 已发布包含 % 个订单的快照。\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), snapshot_size - 1);
+    logger_.log("%:% %() % 已发布包含 % 条记录的 % 快照。\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime(), snapshot_size - 1,
+                snapshotModeToString(snapshot_mode_));
   }
 
-  // 处理来自市场数据发布器的增量更新，更新快照并定期发布快照
+  // 处理来自匹配引擎的增量更新，更新快照并定期发布快照
   void SnapshotSynthesizer::run() {
-    logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_));
+    logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime());
     while (run_) {
       // 处理所有待处理的市场更新
-      for (auto market_update = snapshot_md_updates_->getNextToRead(); snapshot_md_updates_->size() && market_update; market_update = snapshot_md_updates_->getNextToRead()) {
-        logger_.log("%:% %() % 处理 %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_),
-                    market_update->toString().c_str());
+      for (auto market_update = snapshot_md_updates_->getNextToRead(); market_update; market_update = snapshot_md_updates_->getNextToRead()) {
+        const auto seq_num = snapshot_md_updates_->nextReadIndex() + 1;  // 与市场数据发布器分配的增量流序列号相同
+        logger_.log("%:% %() % 处理序列号：% %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentLogTime(), seq_num,
+                    market_update);
 
-        addToSnapshot(market_update);  // 更新快照
+        addToSnapshot(seq_num, market_update);  // 更新快照
 
         snapshot_md_updates_->updateReadIndex();  // 更新队列读取索引
       }
 
       // 每60秒发布一次快照
-      if (getCurrentNanos() - last_snapshot_time_ > 60 * NANOS_TO_SECS) {
-        last_snapshot_time_ = getCurrentNanos();  // 更新最后快照时间
+      if (getCurrentTscNanos() - last_snapshot_time_ > 60 * NANOS_TO_SECS) {
+        last_snapshot_time_ = getCurrentTscNanos();  // 更新最后快照时间
         publishSnapshot();  // 发布快照
       }
     }
@@ -2,11 +2,11 @@
 
 #include "common/types.h"
 #include "common/thread_utils.h"
-#include "common/lf_queue.h"
+#include "common/broadcast_queue.h"
 #include "common/macros.h"
 #include "common/mcast_socket.h"
 #include "common/mem_pool.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
 
 #include "market_data/market_update.h"
 #include "matcher/me_order.h"
@@ -14,17 +14,52 @@
 using namespace Common;
 
 namespace Exchange {
+  // 快照格式：ORDER 逐笔发布每个挂单，LEVEL 按 (ticker, side, price) 聚合后每个价格档位发布一条记录
+  enum class SnapshotMode : uint8_t {
+    ORDER = 0,
+    LEVEL = 1
+  };
+
+  inline std::string snapshotModeToString(SnapshotMode mode) {
+    switch (mode) {
+      case SnapshotMode::ORDER:
+        return "ORDER";
+      case SnapshotMode::LEVEL:
+        return "LEVEL";
+    }
+    return "UNKNOWN";
+  }
+
+  inline auto stringToSnapshotMode(const std::string &str) -> SnapshotMode {
+    return (str == snapshotModeToString(SnapshotMode::LEVEL) ? SnapshotMode::LEVEL : SnapshotMode::ORDER);
+  }
+
+  // L2快照中单个价格档位的聚合信息
+  struct SnapshotLevel {
+    Price price_ = Price_INVALID;  // 档位价格
+    Qty qty_ = 0;                  // 档位总数量
+    Priority num_orders_ = 0;      // 档位订单数
+  };
+
+  // 从价格索引到SnapshotLevel的哈希映射，再按买卖方向和股票代码展开
+  typedef std::array<SnapshotLevel, ME_MAX_PRICE_LEVELS> SnapshotLevelHashMap;
+  typedef std::array<SnapshotLevelHashMap, sideToIndex(Side::MAX) + 1> SnapshotLevelSideHashMap;
+  typedef std::array<SnapshotLevelSideHashMap, ME_MAX_TICKERS> SnapshotLevelTickerSideHashMap;
+
   class SnapshotSynthesizer {
   public:
-    SnapshotSynthesizer(MDPMarketUpdateLFQueue *market_updates, const std::string &iface,
-                        const std::string &snapshot_ip, int snapshot_port);
+    SnapshotSynthesizer(MEMarketUpdateBroadcastQueue::Reader *market_updates, const std::string &iface,
+                        const std::string &snapshot_ip, int snapshot_port, SnapshotMode snapshot_mode);
 
     ~SnapshotSynthesizer();
 
     auto start() -> void;
     auto stop() -> void;
 
-    auto addToSnapshot(const MDPMarketUpdate *market_update);
+    auto addToSnapshot(size_t seq_num, const MEMarketUpdate *market_update);
+
+    // 按价格档位累加数量和订单数的变化，仅在 LEVEL 模式下使用
+    auto updateLevel(TickerId ticker_id, Side side, Price price, int64_t qty_delta, int64_t num_orders_delta) noexcept -> void;
 
     auto publishSnapshot();
 
@@ -37,17 +72,19 @@ namespace Exchange {
     SnapshotSynthesizer &operator=(const SnapshotSynthesizer &&) = delete;
 
   private:
-    MDPMarketUpdateLFQueue *snapshot_md_updates_ = nullptr;
+    // 匹配引擎市场更新广播队列中快照合成器的读取位置，读取位置 + 1 即为该更新在增量流上的序列号
+    MEMarketUpdateBroadcastQueue::Reader *snapshot_md_updates_ = nullptr;
 
-    Logger logger_;
+    BinLogger logger_;
 
     volatile bool run_ = false;
 
-    std::string time_str_;
-
     McastSocket snapshot_socket_;
 
+    const SnapshotMode snapshot_mode_;
+
     std::array<std::array<MEMarketUpdate *, ME_MAX_ORDER_IDS>, ME_MAX_TICKERS> ticker_orders_;
+    SnapshotLevelTickerSideHashMap ticker_levels_;
     size_t last_inc_seq_num_ = 0;
     Nanos last_snapshot_time_ = 0;
 
@@ -2,9 +2,11 @@
 
 namespace Exchange {
   MatchingEngine::MatchingEngine(ClientRequestLFQueue *client_requests, ClientResponseLFQueue *client_responses,
-                                 MEMarketUpdateLFQueue *market_updates)
+                                 MEMarketUpdateBroadcastQueue *market_updates)
       : incoming_requests_(client_requests), outgoing_ogw_responses_(client_responses), outgoing_md_updates_(market_updates),
         logger_("exchange_matching_engine.log") {
+    // 订单簿及其内存池在主线程上构造，绑定到匹配引擎线程所在核心的NUMA节点
+    Common::HugePageNumaScope numa_scope(Common::numaNodeOfCore(ME_CORE_ID));
     for(size_t i = 0; i < ticker_order_book_.size(); ++i) {
       ticker_order_book_[i] = new MEOrderBook(i, &logger_, this);
     }
@@ -28,7 +30,7 @@ namespace Exchange {
   
   auto MatchingEngine::start() -> void {
     run_ = true;
-    ASSERT(Common::createAndStartThread(2, "Exchange/MatchingEngine", [this]() { run(); }) != nullptr, "Failed to start MatchingEngine thread.");
+    ASSERT(Common::createAndStartThread(ME_CORE_ID, "Exchange/MatchingEngine", [this]() { run(); }) != nullptr, "Failed to start MatchingEngine thread.");
   }
 
   auto MatchingEngine::stop() -> void {
@@ -16,7 +16,7 @@ namespace Exchange {
   public:
     MatchingEngine(ClientRequestLFQueue *client_requests,
                    ClientResponseLFQueue *client_responses,
-                   MEMarketUpdateLFQueue *market_updates);
+                   MEMarketUpdateBroadcastQueue *market_updates);
 
     ~MatchingEngine();
 
@@ -24,6 +24,7 @@ namespace Exchange {
     auto stop() -> void;
 
     // 处理从无锁队列读取的客户端请求（由订单服务器发送）
+    // 处理过程中产生的客户端响应和市场更新先写入已申请的队列槽位，处理完后各以一次发布使其对消费者可见
     auto processClientRequest(const MEClientRequest *client_request) noexcept {
       auto order_book = ticker_order_book_[client_request->ticker_id_];  // 获取对应股票的订单簿
       switch (client_request->type_) {
@@ -49,44 +50,61 @@ namespace Exchange {
         }
           break;
       }
+
+      publishPending();
     }
 
-    // 将客户端响应写入无锁队列，供订单服务器消费
+    // 将客户端响应写入无锁队列中已申请的下一个槽位，在当前请求处理完后发布，供订单服务器消费
     auto sendClientResponse(const MEClientResponse *client_response) noexcept {
-      logger_.log("%:% %() % 发送 %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), client_response->toString());
-      auto next_write = outgoing_ogw_responses_->getNextToWriteTo();
-      *next_write = std::move(*client_response);
-      outgoing_ogw_responses_->updateWriteIndex();  // 更新队列写入索引
-      TTT_MEASURE(T4t_MatchingEngine_LFQueue_write, logger_);  // 测量队列写入时间
+      logger_.log("%:% %() % 发送 %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), client_response);
+      outgoing_ogw_responses_->claimWrite(pending_responses_ + 1)[pending_responses_] = *client_response;
+      ++pending_responses_;
     }
 
-    // 将市场数据更新写入无锁队列，供市场数据发布器消费
+    // 将市场数据更新写入无锁队列中已申请的下一个槽位，在当前请求处理完后发布，供市场数据发布器消费
     auto sendMarketUpdate(const MEMarketUpdate *market_update) noexcept {
-      logger_.log("%:% %() % 发送 %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), market_update->toString());
-      auto next_write = outgoing_md_updates_->getNextToWriteTo();
-      *next_write = *market_update;
-      outgoing_md_updates_->updateWriteIndex();  // 更新队列写入索引
-      TTT_MEASURE(T4_MatchingEngine_LFQueue_write, logger_);  // 测量队列写入时间
+      logger_.log("%:% %() % 发送 %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), market_update);
+      outgoing_md_updates_->claimWrite(pending_md_updates_ + 1)[pending_md_updates_] = *market_update;
+      ++pending_md_updates_;
     }
 
     // 处理传入的客户端请求，生成客户端响应和市场更新
     auto run() noexcept {
-      logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+      logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
       while (run_) {
-        const auto me_client_request = incoming_requests_->getNextToRead();  // 读取请求
-        if (LIKELY(me_client_request)) {
+        // 读取全部已发布的请求，逐个处理后一次性归还队列槽位
+        const auto me_client_requests = incoming_requests_->getReadable();
+        if (LIKELY(!me_client_requests.empty())) {
           TTT_MEASURE(T3_MatchingEngine_LFQueue_read, logger_);  // 测量队列读取时间
 
-          logger_.log("%:% %() % 处理 %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                      me_client_request->toString());
-          START_MEASURE(Exchange_MatchingEngine_processClientRequest);
-          processClientRequest(me_client_request);  // 处理请求
-          END_MEASURE(Exchange_MatchingEngine_processClientRequest, logger_);  // 测量处理时间
-          incoming_requests_->updateReadIndex();  // 更新队列读取索引
+          for (size_t i = 0; i < me_client_requests.size(); ++i) {
+            const auto me_client_request = &me_client_requests[i];
+            logger_.log("%:% %() % 处理 %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                        me_client_request);
+            START_MEASURE(Exchange_MatchingEngine_processClientRequest);
+            processClientRequest(me_client_request);  // 处理请求
+            END_MEASURE(Exchange_MatchingEngine_processClientRequest, logger_);  // 测量处理时间
+          }
+          incoming_requests_->commitRead(me_client_requests.size());  // 更新队列读取索引
         }
       }
     }
 
+    // 发布处理当前请求时写入的客户端响应和市场更新，每个队列一次发布
+    // 不经 processClientRequest() 直接驱动订单簿时（如基准测试）需由调用方发布
+    auto publishPending() noexcept -> void {
+      if (LIKELY(pending_responses_)) {
+        outgoing_ogw_responses_->publishWrite(pending_responses_);  // 更新队列写入索引
+        pending_responses_ = 0;
+        TTT_MEASURE(T4t_MatchingEngine_LFQueue_write, logger_);  // 测量队列写入时间
+      }
+      if (LIKELY(pending_md_updates_)) {
+        outgoing_md_updates_->publishWrite(pending_md_updates_);  // 更新队列写入索引
+        pending_md_updates_ = 0;
+        TTT_MEASURE(T4_MatchingEngine_LFQueue_write, logger_);  // 测量队列写入时间
+      }
+    }
+
     MatchingEngine() = delete;
     MatchingEngine(const MatchingEngine &) = delete;
     MatchingEngine(const MatchingEngine &&) = delete;
@@ -100,14 +118,17 @@ namespace Exchange {
     // 无锁队列：
     // 一个用于消费订单服务器发送的传入客户端请求
     // 第二个用于发布 outgoing 客户端响应，供订单服务器消费
-    // 第三个用于发布 outgoing 市场更新，供市场数据发布器消费
+    // 第三个用于广播 outgoing 市场更新，供市场数据发布器和快照合成器消费
     ClientRequestLFQueue *incoming_requests_ = nullptr;
     ClientResponseLFQueue *outgoing_ogw_responses_ = nullptr;
-    MEMarketUpdateLFQueue *outgoing_md_updates_ = nullptr;
+    MEMarketUpdateBroadcastQueue *outgoing_md_updates_ = nullptr;
+
+    // 处理当前请求时已写入但尚未发布的客户端响应和市场更新数量
+    size_t pending_responses_ = 0;
+    size_t pending_md_updates_ = 0;
 
     volatile bool run_ = false;
 
-    std::string time_str_;
-    Logger logger_;
+    BinLogger logger_;
   };
 }
\ No newline at end of file
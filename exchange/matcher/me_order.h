@@ -20,6 +20,9 @@ namespace Exchange {
     MEOrder *prev_order_ = nullptr;
     MEOrder *next_order_ = nullptr;
 
+    // toString() 经由指针读取相邻的订单，BinLogger 在记录日志的线程上转换为字符串而不是按值拷贝
+    static constexpr bool BIN_LOG_AS_STRING = true;
+
     MEOrder() = default;
 
     MEOrder(TickerId ticker_id, ClientId client_id, OrderId client_order_id, OrderId market_order_id, Side side, Price price,
@@ -42,6 +45,9 @@ namespace Exchange {
     MEOrdersAtPrice *prev_entry_ = nullptr;
     MEOrdersAtPrice *next_entry_ = nullptr;
 
+    // toString() 经由指针读取相邻的订单和价格层级，BinLogger 在记录日志的线程上转换为字符串而不是按值拷贝
+    static constexpr bool BIN_LOG_AS_STRING = true;
+
     MEOrdersAtPrice() = default;
 
     MEOrdersAtPrice(Side side, Price price, MEOrder *first_me_order, MEOrdersAtPrice *prev_entry, MEOrdersAtPrice *next_entry)
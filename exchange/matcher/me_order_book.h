@@ -2,7 +2,8 @@
 
 #include "common/types.h"
 #include "common/mem_pool.h"
-#include "common/logging.h"
+#include "common/huge_page_allocator.h"
+#include "common/bin_logging.h"
 #include "order_server/client_response.h"
 #include "market_data/market_update.h"
 
@@ -15,10 +16,21 @@ namespace Exchange {
 
   class MEOrderBook final {
   public:
-    explicit MEOrderBook(TickerId ticker_id, Logger *logger, MatchingEngine *matching_engine);
+    explicit MEOrderBook(TickerId ticker_id, BinLogger *logger, MatchingEngine *matching_engine);
 
     ~MEOrderBook();
 
+    // 订单簿对象的大部分是 cid_oid_to_order_（每个客户端 ME_MAX_ORDER_IDS 个指针），随机访问且大部分从不触及：
+    // 以透明大页映射以减少 TLB 未命中，未触及的部分不占用物理内存，且映射的内存初始为零，cid_oid_to_order_ 依赖于此初始化为空指针
+    static auto operator new(size_t size) -> void * {
+      HugePageMode mode;
+      return allocateHugePages(size, HugePageMode::THP, &mode);
+    }
+
+    static auto operator delete(void *ptr, size_t size) noexcept -> void {
+      deallocateHugePages(ptr, size);
+    }
+
     auto add(ClientId client_id, OrderId client_order_id, TickerId ticker_id, Side side, Price price, Qty qty) noexcept -> void;
     auto cancel(ClientId client_id, OrderId order_id, TickerId ticker_id) noexcept -> void;
 
@@ -51,8 +63,7 @@ namespace Exchange {
 
     OrderId next_market_order_id_ = 1;
 
-    std::string time_str_;
-    Logger *logger_ = nullptr;
+    BinLogger *logger_ = nullptr;
 
   private:
     auto generateNewMarketOrderId() noexcept -> OrderId {
@@ -3,13 +3,13 @@
 #include "matcher/matching_engine.h"
 
 namespace Exchange {
-  UnorderedMapMEOrderBook::UnorderedMapMEOrderBook(TickerId ticker_id, Logger *logger, MatchingEngine *matching_engine)
+  UnorderedMapMEOrderBook::UnorderedMapMEOrderBook(TickerId ticker_id, BinLogger *logger, MatchingEngine *matching_engine)
       : ticker_id_(ticker_id), matching_engine_(matching_engine), orders_at_price_pool_(ME_MAX_PRICE_LEVELS), order_pool_(ME_MAX_ORDER_IDS),
         logger_(logger) {
   }
 
   UnorderedMapMEOrderBook::~UnorderedMapMEOrderBook() {
-    logger_->log("%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+    logger_->log("%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
                 toString(false, true));
 
     matching_engine_ = nullptr;
@@ -43,7 +43,7 @@ namespace Exchange {
     if (!order->qty_) {  // 被动订单完全成交，需移除
       // 发送取消类型的市场更新（表示订单已完全成交）
       market_update_ = {MarketUpdateType::CANCEL, order->market_order_id_, ticker_id, order->side_,
-                        order->price_, order_qty, Priority_INVALID};
+                        order->price_, order->qty_, Priority_INVALID};
       matching_engine_->sendMarketUpdate(&market_update_);
 
       // 从订单簿中移除该订单
@@ -139,8 +139,8 @@ namespace Exchange {
       client_response_ = {ClientResponseType::CANCELED, client_id, ticker_id, order_id, exchange_order->market_order_id_,
                           exchange_order->side_, exchange_order->price_, Qty_INVALID, exchange_order->qty_};
       // 发送取消类型的市场更新
-      market_update_ = {MarketUpdateType::CANCEL, exchange_order->market_order_id_, ticker_id, exchange_order->side_, exchange_order->price_, 0,
-                        exchange_order->priority_};
+      market_update_ = {MarketUpdateType::CANCEL, exchange_order->market_order_id_, ticker_id, exchange_order->side_, exchange_order->price_,
+                        exchange_order->qty_, exchange_order->priority_};
 
       // 从订单簿中移除订单
       START_MEASURE(Exchange_UnorderedMapMEOrderBook_removeOrder);
@@ -156,7 +156,6 @@ namespace Exchange {
   // 将订单簿信息转换为字符串（支持详细模式和有效性检查）
   auto UnorderedMapMEOrderBook::toString(bool detailed, bool validity_check) const -> std::string {
     std::stringstream ss;
-    std::string time_str;
 
     // 用于打印价格层级及其包含订单的lambda函数
     auto printer = [&](std::stringstream &ss, MEOrdersAtPrice *itr, Side side, Price &last_price, bool sanity_check) {
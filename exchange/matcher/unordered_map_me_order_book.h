@@ -4,7 +4,7 @@
 
 #include "common/types.h"
 #include "common/mem_pool.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
 #include "order_server/client_response.h"
 #include "market_data/market_update.h"
 
@@ -17,7 +17,7 @@ namespace Exchange {
 
   class UnorderedMapMEOrderBook final {
   public:
-    explicit UnorderedMapMEOrderBook(TickerId ticker_id, Logger *logger, MatchingEngine *matching_engine);
+    explicit UnorderedMapMEOrderBook(TickerId ticker_id, BinLogger *logger, MatchingEngine *matching_engine);
 
     ~UnorderedMapMEOrderBook();
 
@@ -53,8 +53,7 @@ namespace Exchange {
 
     OrderId next_market_order_id_ = 1;
 
-    std::string time_str_;
-    Logger *logger_ = nullptr;
+    BinLogger *logger_ = nullptr;
 
   private:
     auto generateNewMarketOrderId() noexcept -> OrderId {
@@ -10,7 +10,7 @@ namespace Exchange {
 
   class FIFOSequencer {
   public:
-    FIFOSequencer(ClientRequestLFQueue *client_requests, Logger *logger)
+    FIFOSequencer(ClientRequestLFQueue *client_requests, BinLogger *logger)
         : incoming_requests_(client_requests), logger_(logger) {
     }
 
@@ -28,21 +28,22 @@ namespace Exchange {
       if (UNLIKELY(!pending_size_))
         return;
 
-      logger_->log("%:% %() % Processing % requests.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), pending_size_);
+      logger_->log("%:% %() % Processing % requests.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), pending_size_);
 
       std::sort(pending_client_requests_.begin(), pending_client_requests_.begin() + pending_size_);
 
+      // 为排序后的整批请求申请连续的队列槽位，写完后以一次发布使整批请求对匹配引擎可见
+      auto next_writes = incoming_requests_->claimWrite(pending_size_);
       for (size_t i = 0; i < pending_size_; ++i) {
         const auto &client_request = pending_client_requests_.at(i);
 
-        logger_->log("%:% %() % Writing RX:% Req:% to FIFO.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                     client_request.recv_time_, client_request.request_.toString());
+        logger_->log("%:% %() % Writing RX:% Req:% to FIFO.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                     client_request.recv_time_, client_request.request_);
 
-        auto next_write = incoming_requests_->getNextToWriteTo();
-        *next_write = std::move(client_request.request_);
-        incoming_requests_->updateWriteIndex();
-        TTT_MEASURE(T2_OrderServer_LFQueue_write, (*logger_));
+        next_writes[i] = std::move(client_request.request_);
       }
+      incoming_requests_->publishWrite(pending_size_);
+      TTT_MEASURE(T2_OrderServer_LFQueue_write, (*logger_));
 
       pending_size_ = 0;
     }
@@ -56,8 +57,7 @@ namespace Exchange {
   private:
     ClientRequestLFQueue *incoming_requests_ = nullptr;
 
-    std::string time_str_;
-    Logger *logger_ = nullptr;
+    BinLogger *logger_ = nullptr;
 
     struct RecvTimeClientRequest {
       Nanos recv_time_ = 0;
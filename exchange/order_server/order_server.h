@@ -21,7 +21,7 @@ namespace Exchange {
     auto stop() -> void;
 
     auto run() noexcept {
-      logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+      logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
       while (run_) {
         tcp_server_.poll();
 
@@ -31,11 +31,11 @@ namespace Exchange {
           TTT_MEASURE(T5t_OrderServer_LFQueue_read, logger_);
 
           auto &next_outgoing_seq_num = cid_next_outgoing_seq_num_[client_response->client_id_];
-          logger_.log("%:% %() % Processing cid:% seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                      client_response->client_id_, next_outgoing_seq_num, client_response->toString());
+          logger_.log("%:% %() % Processing cid:% seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                      client_response->client_id_, next_outgoing_seq_num, client_response);
 
-          ASSERT(cid_tcp_socket_[client_response->client_id_] != nullptr,
-                 "Dont have a TCPSocket for ClientId:" + std::to_string(client_response->client_id_));
+          if (UNLIKELY(cid_tcp_socket_[client_response->client_id_] == nullptr))
+            FATAL("Dont have a TCPSocket for ClientId:" + std::to_string(client_response->client_id_));
           START_MEASURE(Exchange_TCPSocket_send);
           cid_tcp_socket_[client_response->client_id_]->send(&next_outgoing_seq_num, sizeof(next_outgoing_seq_num));
           cid_tcp_socket_[client_response->client_id_]->send(client_response, sizeof(MEClientResponse));
@@ -51,14 +51,14 @@ namespace Exchange {
 
     auto recvCallback(TCPSocket *socket, Nanos rx_time) noexcept {
       TTT_MEASURE(T1_OrderServer_TCP_read, logger_);
-      logger_.log("%:% %() % Received socket:% len:% rx:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+      logger_.log("%:% %() % Received socket:% len:% rx:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
                   socket->socket_fd_, socket->next_rcv_valid_index_, rx_time);
 
       if (socket->next_rcv_valid_index_ >= sizeof(OMClientRequest)) {
         size_t i = 0;
         for (; i + sizeof(OMClientRequest) <= socket->next_rcv_valid_index_; i += sizeof(OMClientRequest)) {
           auto request = reinterpret_cast<const OMClientRequest *>(socket->inbound_data_.data() + i);
-          logger_.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->toString());
+          logger_.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), request);
 
           if (UNLIKELY(cid_tcp_socket_[request->me_client_request_.client_id_] == nullptr)) { // first message from this ClientId.
             cid_tcp_socket_[request->me_client_request_.client_id_] = socket;
@@ -66,7 +66,7 @@ namespace Exchange {
 
           if (cid_tcp_socket_[request->me_client_request_.client_id_] != socket) { // TODO - change this to send a reject back to the client.
             logger_.log("%:% %() % Received ClientRequest from ClientId:% on different socket:% expected:%\n", __FILE__, __LINE__, __FUNCTION__,
-                        Common::getCurrentTimeStr(&time_str_), request->me_client_request_.client_id_, socket->socket_fd_,
+                        Common::getCurrentLogTime(), request->me_client_request_.client_id_, socket->socket_fd_,
                         cid_tcp_socket_[request->me_client_request_.client_id_]->socket_fd_);
             continue;
           }
@@ -74,7 +74,7 @@ namespace Exchange {
           auto &next_exp_seq_num = cid_next_exp_seq_num_[request->me_client_request_.client_id_];
           if (request->seq_num_ != next_exp_seq_num) { // TODO - change this to send a reject back to the client.
             logger_.log("%:% %() % Incorrect sequence number. ClientId:% SeqNum expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__,
-                        Common::getCurrentTimeStr(&time_str_), request->me_client_request_.client_id_, next_exp_seq_num, request->seq_num_);
+                        Common::getCurrentLogTime(), request->me_client_request_.client_id_, next_exp_seq_num, request->seq_num_);
             continue;
           }
 
@@ -109,8 +109,7 @@ namespace Exchange {
 
     volatile bool run_ = false;
 
-    std::string time_str_;
-    Logger logger_;
+    BinLogger logger_;
 
     std::array<size_t, ME_MAX_NUM_CLIENTS> cid_next_outgoing_seq_num_;
 
@@ -5,16 +5,76 @@ bash scripts/build.sh
 date
 
 echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
-echo " Benchmark before and after optimization for Logger string handling. "
+echo " Benchmark before and after optimization for Logger string handling, and BinLogger recording one binary record per call with text and binary output. "
 echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
 ./cmake-build-release/logger_benchmark
 
 echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
-echo " Benchmark before and after optimization for release builds. "
+echo " Benchmark before and after optimization for release builds, and scan vs free-list MemPool under fragmented order-book churn. "
 echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
 ./cmake-build-release/release_benchmark
 
 echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
 echo " Benchmark using std::arrays and std::unordered_maps as hash maps. "
 echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
-./cmake-build-release/hash_benchmark
\ No newline at end of file
+./cmake-build-release/hash_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark fixed and compact delta-encoded market data wire formats. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/md_codec_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark snapshot recovery using std::map queues and sequence-indexed rings. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/recovery_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark tick-to-BBO with per-level aggregates against walking deep order queues. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/bbo_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark tick-to-order through the strategy layer with 1 and 4 market maker strategies, static vs std::function dispatch. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/tick_to_order_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark pre-trade risk checks with incrementally maintained and recomputed portfolio exposure. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/risk_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark double and lazy fixed-point PnL arithmetic in PositionKeeper BBO updates. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/pnl_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark cross-core ping-pong and streaming through LFQueue with a shared counter, with cached indices and with batch claim/publish, and fan-out by forwarding copy and by BroadcastQueue. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/lf_queue_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark fan-in from 2-16 producer threads through one MPSCQueue and through one LFQueue per producer. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/mpsc_queue_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark random access over 256 MiB backed by regular pages and by huge pages (MAP_HUGETLB, falling back to transparent huge pages). "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/huge_page_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark timestamps from getCurrentTimeStr(), the system clock and the calibrated TSC clock, and logging with a formatted vs a raw timestamp. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/clock_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark recording into the per-tag latency histograms, and check their percentiles against the exact ones. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/latency_histogram_benchmark
+
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+echo " Benchmark reading the thread's hardware counter group, and aggregate the counters per tag over sequential, random and branchy workloads. "
+echo "---------------------------------------------------------------------------------------------------------------------------------------------------------"
+./cmake-build-release/perf_counter_benchmark
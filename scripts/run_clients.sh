@@ -1,6 +1,7 @@
 #!/bin/bash
 
 # ./trading_main CLIENT_ID ALGO_TYPE [CLIP_1 THRESH_1 MAX_ORDER_SIZE_1 MAX_POS_1 MAX_LOSS_1] [CLIP_2 THRESH_2 MAX_ORDER_SIZE_2 MAX_POS_2 MAX_LOSS_2] ...
+# 每个 ALGO_TYPE 开始一个新的策略实例: ./trading_main CLIENT_ID ALGO_TYPE_1 [...] ... ALGO_TYPE_2 [...] ...
 
 ./cmake-build-release/trading_main  1 MAKER \
                                   100 0.6 150 300 -100 \
@@ -0,0 +1,126 @@
+#include <random>
+#include <vector>
+
+#include "exchange/market_data/compact_market_update.h"
+
+// 紧凑格式编解码的检查：正常数据精确往返，截断和损坏的数据不越界读取、不终止进程，损坏的包整体丢弃
+
+static constexpr size_t num_updates = 3000;
+
+// 比较两个市场更新的所有字段
+bool sameMarketUpdate(const Exchange::MEMarketUpdate &lhs, const Exchange::MEMarketUpdate &rhs) {
+  return lhs.type_ == rhs.type_ && lhs.order_id_ == rhs.order_id_ && lhs.ticker_id_ == rhs.ticker_id_ && lhs.side_ == rhs.side_ &&
+         lhs.price_ == rhs.price_ && lhs.qty_ == rhs.qty_ && lhs.priority_ == rhs.priority_;
+}
+
+// 随机的 ADD / MODIFY / CANCEL / TRADE 序列，TRADE 不带订单ID和优先级，覆盖省略无效字段的编码
+std::vector<Exchange::MEMarketUpdate> generateUpdates(std::mt19937_64 &rng) {
+  std::vector<Exchange::MEMarketUpdate> updates(num_updates);
+  OrderId order_id = 1000;
+  for (auto &update : updates) {
+    update.type_ = static_cast<Exchange::MarketUpdateType>(2 + rng() % 4);
+    update.order_id_ = (update.type_ == Exchange::MarketUpdateType::TRADE ? OrderId_INVALID : order_id - rng() % 50);
+    update.ticker_id_ = rng() % ME_MAX_TICKERS;
+    update.side_ = (rng() % 2 ? Side::BUY : Side::SELL);
+    update.price_ = 100 + static_cast<Price>(rng() % 20);
+    update.qty_ = 1 + rng() % 1000;
+    update.priority_ = (update.type_ == Exchange::MarketUpdateType::TRADE ? Priority_INVALID : 1 + rng() % 10);
+    ++order_id;
+  }
+  return updates;
+}
+
+// 按 updates_per_packet 分包编码，返回各包首尾相接的字节流及每个包的长度
+std::vector<char> encode(const std::vector<Exchange::MEMarketUpdate> &updates, size_t updates_per_packet, std::vector<size_t> *packet_sizes) {
+  std::vector<char> data;
+  auto encoder = new Exchange::CompactMarketUpdateEncoder();
+  encoder->reset(1);
+  for (size_t i = 0; i < updates.size(); ++i) {
+    encoder->add(updates[i]);
+    if ((i + 1) % updates_per_packet == 0 || i + 1 == updates.size()) {
+      const auto size = encoder->finish();
+      data.insert(data.end(), encoder->data(), encoder->data() + size);
+      packet_sizes->push_back(size);
+      encoder->reset(i + 2);
+    }
+  }
+  delete encoder;
+  return data;
+}
+
+// 在恰好 len 字节的独立缓冲区上解码，越界读取可被内存检查工具发现；校验每个回调的更新序列号连续且与原始更新一致
+size_t decode(const std::vector<char> &data, size_t len, const std::vector<Exchange::MEMarketUpdate> &updates,
+              size_t *num_decoded, size_t *num_dropped) {
+  const std::vector<char> exact(data.begin(), data.begin() + len);
+  *num_decoded = 0;
+  const auto consumed = Exchange::decodeCompactPackets(exact.data(), exact.size(), [&](const Exchange::MDPMarketUpdate &update) {
+    ASSERT(update.seq_num_ >= 1 && update.seq_num_ <= updates.size(), "序列号超出范围：" + update.toString());
+    ASSERT(sameMarketUpdate(update.me_market_update_, updates[update.seq_num_ - 1]), "往返不一致：" + update.toString());
+    ++*num_decoded;
+  }, num_dropped);
+  ASSERT(consumed <= len, "消费的字节数超过数据长度：" + std::to_string(consumed));
+  return consumed;
+}
+
+int main(int, char **) {
+  std::mt19937_64 rng(1);
+  const auto updates = generateUpdates(rng);
+
+  // 往返：多个包首尾相接，全部消费且精确还原
+  std::vector<size_t> packet_sizes;
+  const auto data = encode(updates, 100, &packet_sizes);
+  size_t num_decoded = 0, num_dropped = 0;
+  ASSERT(decode(data, data.size(), updates, &num_decoded, &num_dropped) == data.size() && num_decoded == updates.size() && !num_dropped,
+         "往返解码数量不一致：" + std::to_string(num_decoded));
+
+  // 截断：任意长度的前缀只解码其中完整的包，不完整的包留待下次解码
+  for (size_t len = 0; len < packet_sizes[0] + packet_sizes[1]; ++len) {
+    num_dropped = 0;
+    const auto consumed = decode(data, len, updates, &num_decoded, &num_dropped);
+    const auto expected = (len >= packet_sizes[0] ? packet_sizes[0] : 0);
+    ASSERT(consumed == expected && num_decoded == (expected ? 100u : 0u) && !num_dropped,
+           "截断到 " + std::to_string(len) + " 字节时消费了 " + std::to_string(consumed) + " 字节");
+  }
+
+  // 不认识的版本：包头不可信，丢弃全部数据
+  {
+    auto corrupt = data;
+    corrupt[0] = static_cast<char>(Exchange::COMPACT_MD_VERSION + 1);
+    num_dropped = 0;
+    ASSERT(decode(corrupt, corrupt.size(), updates, &num_decoded, &num_dropped) == corrupt.size() && !num_decoded && num_dropped == 1,
+           "未丢弃版本错误的数据");
+  }
+
+  // 包长小于包体实际长度：该包整体丢弃，不回调其中任何更新
+  {
+    auto corrupt = data;
+    Exchange::CompactPacketHeader header;
+    memcpy(&header, corrupt.data(), sizeof(header));
+    header.size_ -= 3;
+    memcpy(corrupt.data(), &header, sizeof(header));
+    const std::vector<char> packet(corrupt.begin(), corrupt.begin() + header.size_);
+    num_dropped = 0;
+    ASSERT(decode(packet, packet.size(), updates, &num_decoded, &num_dropped) == packet.size() && !num_decoded && num_dropped == 1,
+           "未丢弃长度不匹配的包");
+  }
+
+  // 随机翻转字节：不越界、不终止进程，消费的字节数不超过数据长度
+  size_t total_dropped = 0;
+  for (size_t i = 0; i < 2000; ++i) {
+    auto corrupt = data;
+    const auto num_flips = 1 + rng() % 4;
+    for (size_t j = 0; j < num_flips; ++j)
+      corrupt[rng() % corrupt.size()] ^= static_cast<char>(1 + rng() % 255);
+
+    const auto exact = std::vector<char>(corrupt.begin(), corrupt.end());
+    num_dropped = 0;
+    const auto consumed = Exchange::decodeCompactPackets(exact.data(), exact.size(), [](const Exchange::MDPMarketUpdate &) {}, &num_dropped);
+    ASSERT(consumed <= exact.size(), "消费的字节数超过数据长度：" + std::to_string(consumed));
+    total_dropped += num_dropped;
+  }
+  ASSERT(total_dropped > 0, "随机损坏的数据没有被丢弃的包");
+
+  std::cout << "COMPACT CODEC CHECKS PASSED, " << total_dropped << " CORRUPT PACKETS DROPPED IN FUZZED DATA." << std::endl;
+
+  exit(EXIT_SUCCESS);
+}
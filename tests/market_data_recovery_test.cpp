@@ -0,0 +1,86 @@
+#include <vector>
+
+#include "trading/market_data/market_data_recovery.h"
+
+// 快照恢复的检查：在快照周期中途加入时，上一个周期残留的后半部分不能与下一个周期拼接成混合的订单簿
+
+using namespace Exchange;
+
+// 一个完整的快照周期：SNAPSHOT_START、CLEAR、每个订单一条 ADD、SNAPSHOT_END，首尾携带构建快照时的最后增量序列号
+std::vector<MDPMarketUpdate> snapshotCycle(size_t last_inc_seq_num, const std::vector<OrderId> &order_ids) {
+  std::vector<MDPMarketUpdate> cycle;
+  cycle.push_back({cycle.size(), {MarketUpdateType::SNAPSHOT_START, last_inc_seq_num}});
+  cycle.push_back({cycle.size(), {MarketUpdateType::CLEAR, OrderId_INVALID, 0, Side::INVALID, Price_INVALID, Qty_INVALID, Priority_INVALID}});
+  for (const auto order_id : order_ids)
+    cycle.push_back({cycle.size(), {MarketUpdateType::ADD, order_id, 0, Side::BUY, 100, 10, 1}});
+  cycle.push_back({cycle.size(), {MarketUpdateType::SNAPSHOT_END, last_inc_seq_num}});
+  return cycle;
+}
+
+MDPMarketUpdate incremental(size_t seq_num) {
+  return {seq_num, {MarketUpdateType::ADD, 1000 + seq_num, 0, Side::SELL, 110, 5, 1}};
+}
+
+// 读出恢复写入无锁队列的全部更新
+std::vector<MEMarketUpdate> drain(MEMarketUpdateLFQueue *queue) {
+  std::vector<MEMarketUpdate> updates;
+  for (auto update = queue->getNextToRead(); queue->size() && update; update = queue->getNextToRead()) {
+    updates.push_back(*update);
+    queue->updateReadIndex();
+  }
+  return updates;
+}
+
+int main(int, char **) {
+  Common::BinLogger logger("market_data_recovery_test.log");
+  auto market_updates = new MEMarketUpdateLFQueue(ME_MAX_MARKET_UPDATES);
+  auto recovery = new Trading::MarketDataRecovery(market_updates, &logger);
+
+  // 增量流从序列号11开始
+  for (size_t seq_num = 11; seq_num <= 15; ++seq_num) {
+    const auto update = incremental(seq_num);
+    ASSERT(!recovery->queueMessage(false, &update), "没有快照时不应完成恢复");
+  }
+
+  // 在旧周期（构建于增量序列号10）中途加入，只收到序列号5及之后的消息
+  const auto old_cycle = snapshotCycle(10, {101, 102, 103, 104, 105, 106, 107, 108});
+  for (size_t i = 5; i < old_cycle.size(); ++i)
+    ASSERT(!recovery->queueMessage(true, &old_cycle[i]), "没有 SNAPSHOT_START 时不应完成恢复");
+
+  // 新周期（构建于增量序列号15）长度与旧周期相同，其前5条消息不能与旧周期残留的消息拼接成完整的快照
+  const auto new_cycle = snapshotCycle(15, {301, 302, 303, 304, 305, 306, 307, 308});
+  for (size_t i = 0; i + 1 < new_cycle.size(); ++i)
+    ASSERT(!recovery->queueMessage(true, &new_cycle[i]), "收到新周期的第 " + std::to_string(i) + " 条消息时与旧周期拼接完成了恢复");
+  ASSERT(recovery->queueMessage(true, &new_cycle.back()), "收到完整的新周期后未完成恢复");
+  ASSERT(recovery->nextExpIncSeqNum() == 16, "下一个期望的增量序列号应来自新周期：" + std::to_string(recovery->nextExpIncSeqNum()));
+
+  // 写出的订单簿只包含新周期的订单，快照已包含的增量更新被丢弃
+  const auto recovered = drain(market_updates);
+  ASSERT(recovered.size() == new_cycle.size() - 2, "恢复的更新数量不一致：" + std::to_string(recovered.size()));
+  for (size_t i = 0; i < recovered.size(); ++i)
+    ASSERT(recovered[i].type_ == new_cycle[i + 1].me_market_update_.type_ && recovered[i].order_id_ == new_cycle[i + 1].me_market_update_.order_id_,
+           "恢复的订单簿混入了其他周期的更新：" + recovered[i].toString());
+
+  // 恢复后在下一个周期中途再次加入，之后到达的增量更新紧接在新周期之后
+  for (size_t i = 3; i < new_cycle.size(); ++i)
+    ASSERT(!recovery->queueMessage(true, &new_cycle[i]), "没有 SNAPSHOT_START 时不应完成恢复");
+  const auto next_cycle = snapshotCycle(17, {401, 402});
+  for (size_t seq_num = 16; seq_num <= 18; ++seq_num) {
+    const auto update = incremental(seq_num);
+    ASSERT(!recovery->queueMessage(false, &update), "没有完整快照时不应完成恢复");
+  }
+  for (size_t i = 0; i + 1 < next_cycle.size(); ++i)
+    ASSERT(!recovery->queueMessage(true, &next_cycle[i]), "快照周期未结束时不应完成恢复");
+  ASSERT(recovery->queueMessage(true, &next_cycle.back()), "收到完整的周期后未完成恢复");
+  ASSERT(recovery->nextExpIncSeqNum() == 19, "下一个期望的增量序列号不正确：" + std::to_string(recovery->nextExpIncSeqNum()));
+  const auto rerecovered = drain(market_updates);
+  ASSERT(rerecovered.size() == next_cycle.size() - 2 + 1 && rerecovered.back().order_id_ == 1018,
+         "再次恢复的更新不正确，数量：" + std::to_string(rerecovered.size()));
+
+  delete recovery;
+  delete market_updates;
+
+  std::cout << "MARKET DATA RECOVERY CHECKS PASSED." << std::endl;
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,23 @@
+#include "common/bin_logging.h"
+
+/// 程序入口：./bin_log_decoder_main 二进制日志文件 [输出文件]
+/// 将 BinLogger 以 BINARY 模式写出的日志展开为与 Logger 相同的文本，未指定输出文件时写到标准输出
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    FATAL("使用方法: bin_log_decoder_main 二进制日志文件 [输出文件]");
+  }
+
+  std::ifstream binary_log(argv[1], std::ios::binary);
+  ASSERT(binary_log.is_open(), "无法打开二进制日志文件：" + std::string(argv[1]));
+
+  std::ofstream output_file;
+  if (argc > 2) {
+    output_file.open(argv[2], std::ios::binary);
+    ASSERT(output_file.is_open(), "无法打开输出文件：" + std::string(argv[2]));
+  }
+
+  const auto num_entries = Common::decodeBinLog(binary_log, (argc > 2 ? static_cast<std::ostream &>(output_file) : std::cout));
+  std::cerr << "解码日志记录数:" << num_entries << std::endl;
+
+  exit(EXIT_SUCCESS);
+}
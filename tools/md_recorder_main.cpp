@@ -0,0 +1,76 @@
+#include <csignal>
+
+#include "trading/market_data/md_channels.h"
+
+#include "common/capture_file.h"
+#include "common/mcast_socket.h"
+#include "common/bin_logging.h"
+
+/// 收到中断信号后停止录制，以便截断并关闭捕获文件
+volatile sig_atomic_t run = true;
+
+void signal_handler(int) {
+  run = false;
+}
+
+/// 程序入口：./md_recorder_main 捕获文件 [录制秒数]
+/// 录制快照流、增量流和BBO流的原始数据报及内核接收时间戳，录制秒数为0（默认）表示直到收到中断信号
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    FATAL("使用方法: md_recorder_main 捕获文件 [录制秒数]");
+  }
+
+  const std::string file_name = argv[1];
+  const Common::Nanos duration = (argc > 2 ? atol(argv[2]) : 0) * Common::NANOS_TO_SECS;
+
+  std::signal(SIGINT, signal_handler);
+
+  Common::BinLogger logger("md_recorder_main.log");
+
+  auto writer = new Common::CaptureWriter(file_name);
+
+  // 每个通道一个监听 socket，并启用内核接收时间戳
+  const std::string iface = "lo";
+  std::vector<Common::McastSocket *> sockets;
+  size_t num_records = 0;
+  for (size_t channel = 0; channel < Trading::MD_CHANNELS.size(); ++channel) {
+    const auto &md_channel = Trading::MD_CHANNELS[channel];
+    auto socket = new Common::McastSocket(logger);
+
+    // 每次读取的是一个完整的数据报，原样写入捕获文件
+    socket->recv_callback_ = [&, channel](Common::McastSocket *s) {
+      if (UNLIKELY(!writer->write(channel, s->last_recv_kernel_time_, Common::getCurrentTscNanos(), s->inbound_data_.data(), s->next_rcv_valid_index_))) {
+        logger.log("%:% %() % 捕获文件已满，停止录制。\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
+        run = false;
+      }
+      s->next_rcv_valid_index_ = 0;
+      ++num_records;
+    };
+
+    ASSERT(socket->init(md_channel.ip_, iface, md_channel.port_, /*is_listening*/ true, /*needs_so_timestamp*/ true) >= 0,
+           "无法创建多播 socket " + std::string(md_channel.name_) + "。错误：" + std::string(std::strerror(errno)));
+    ASSERT(socket->join(md_channel.ip_), "无法加入多播组 " + std::string(md_channel.name_) + "。错误：" + std::string(std::strerror(errno)));
+    sockets.push_back(socket);
+  }
+
+  logger.log("%:% %() % 开始录制到 % 时长:%ns\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), file_name, duration);
+
+  const auto start_time = Common::getCurrentTscNanos();
+  while (run && (!duration || Common::getCurrentTscNanos() - start_time < duration)) {
+    for (auto socket: sockets)
+      socket->sendAndRecv();
+  }
+
+  logger.log("%:% %() % 录制结束，共 % 条记录 % 字节。\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+             num_records, writer->size());
+
+  // 释放资源，析构时将捕获文件截断为实际写入的大小
+  for (auto socket: sockets)
+    delete socket;
+  delete writer;
+
+  using namespace std::literals::chrono_literals;
+  std::this_thread::sleep_for(1s);  // 等待日志写入完成
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,77 @@
+#include "trading/market_data/md_channels.h"
+
+#include "common/capture_file.h"
+#include "common/mcast_socket.h"
+#include "common/bin_logging.h"
+
+/// 程序入口：./md_replayer_main 捕获文件 [回放速度]
+/// 将捕获文件中的数据报按原通道重新发布到回环网卡上的多播流
+/// 回放速度：1（默认）按录制节奏，N 为N倍速（可为小数），0 为最大速度
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    FATAL("使用方法: md_replayer_main 捕获文件 [回放速度]");
+  }
+
+  const std::string file_name = argv[1];
+  const double speed = (argc > 2 ? std::atof(argv[2]) : 1.0);
+
+  Common::BinLogger logger("md_replayer_main.log");
+
+  Common::CaptureReader reader(file_name);
+
+  // 每个通道一个发布 socket
+  const std::string iface = "lo";
+  std::vector<Common::McastSocket *> sockets;
+  for (const auto &md_channel: Trading::MD_CHANNELS) {
+    auto socket = new Common::McastSocket(logger);
+    ASSERT(socket->init(md_channel.ip_, iface, md_channel.port_, /*is_listening*/ false) >= 0,
+           "无法创建多播 socket " + std::string(md_channel.name_) + "。错误：" + std::string(std::strerror(errno)));
+    sockets.push_back(socket);
+  }
+
+  logger.log("%:% %() % 开始回放 % 速度:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), file_name, speed);
+
+  size_t num_records = 0;
+  Common::Nanos first_record_time = 0, last_record_time = 0, start_time = 0;
+  bool use_kernel_time = false;
+  const char *payload = nullptr;
+  for (auto record = reader.next(&payload); record; record = reader.next(&payload)) {
+    ASSERT(record->channel_ < sockets.size(), "未知的通道号：" + std::to_string(record->channel_));
+
+    // 整个文件使用同一个时间基准：第一条记录带有内核接收时间戳时使用内核时间，否则使用用户态读取时间
+    // 两种时间基准不同，不能逐条混用；内核时间基准下个别缺少时间戳的记录紧随前一条记录发送
+    if (UNLIKELY(!num_records)) {
+      use_kernel_time = (record->kernel_time_ != 0);
+      first_record_time = last_record_time = (use_kernel_time ? record->kernel_time_ : record->user_time_);
+      start_time = Common::getCurrentTscNanos();
+    }
+    const auto record_time = std::max(last_record_time, (use_kernel_time ? record->kernel_time_ : record->user_time_));
+    last_record_time = record_time;
+
+    // 等待到该记录按回放速度换算后的发送时刻，较远时休眠，临近时自旋
+    if (speed > 0) {
+      const auto send_time = start_time + static_cast<Common::Nanos>(static_cast<double>(record_time - first_record_time) / speed);
+      for (auto now = Common::getCurrentTscNanos(); now < send_time; now = Common::getCurrentTscNanos()) {
+        if (send_time - now > Common::NANOS_TO_MILLIS)
+          usleep((send_time - now - Common::NANOS_TO_MILLIS) / Common::NANOS_TO_MICROS);
+      }
+    }
+
+    // 每次 sendAndRecv() 发送一个数据报，保持录制时的数据报边界
+    auto socket = sockets[record->channel_];
+    socket->send(payload, record->length_);
+    socket->sendAndRecv();
+    ++num_records;
+  }
+
+  logger.log("%:% %() % 回放结束，共 % 条记录，耗时 %ns\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+             num_records, (num_records ? Common::getCurrentTscNanos() - start_time : 0));
+
+  for (auto socket: sockets)
+    delete socket;
+
+  using namespace std::literals::chrono_literals;
+  std::this_thread::sleep_for(1s);  // 等待日志写入完成
+
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <deque>
+
+#include "common/macros.h"
+#include "common/logging.h"
+#include "common/time_utils.h"
+
+#include "exchange/matcher/matching_engine.h"
+
+#include "strategy/trade_engine.h"
+
+namespace Trading {
+  // 单向链路的延迟模型：固定延迟加上 [0, jitter_) 内的均匀随机抖动
+  // 同一链路上的消息保持先进先出，与 TCP 订单链路和行情多播的顺序一致
+  struct LatencyModel {
+    Nanos latency_ = 0;
+    Nanos jitter_ = 0;
+
+    auto sample() const noexcept {
+      return latency_ + (jitter_ ? static_cast<Nanos>(rand()) % jitter_ : 0);
+    }
+
+    auto toString() const {
+      std::stringstream ss;
+      ss << "LatencyModel{latency:" << latency_ << "ns jitter:" << jitter_ << "ns}";
+      return ss.str();
+    }
+  };
+
+  // 回测中的一条消息链路：带到达时间的先进先出队列
+  template<typename T>
+  class SimChannel {
+  public:
+    explicit SimChannel(const LatencyModel &latency_model)
+        : latency_model_(latency_model) {
+    }
+
+    // 在模拟时间 now 发送消息，到达时间不早于链路上前一条消息的到达时间
+    auto send(Nanos now, const T &msg) noexcept {
+      last_arrival_time_ = std::max(now + latency_model_.sample(), last_arrival_time_);
+      messages_.push_back({last_arrival_time_, msg});
+    }
+
+    // 下一条消息的到达时间，链路为空时为 Nanos 最大值
+    auto nextTime() const noexcept {
+      return (messages_.empty() ? std::numeric_limits<Nanos>::max() : messages_.front().first);
+    }
+
+    auto front() const noexcept -> const T & {
+      return messages_.front().second;
+    }
+
+    auto pop() noexcept {
+      messages_.pop_front();
+    }
+
+    SimChannel() = delete;
+    SimChannel(const SimChannel &) = delete;
+    SimChannel(const SimChannel &&) = delete;
+    SimChannel &operator=(const SimChannel &) = delete;
+    SimChannel &operator=(const SimChannel &&) = delete;
+
+  private:
+    const LatencyModel latency_model_;
+    Nanos last_arrival_time_ = 0;
+    std::deque<std::pair<Nanos, T>> messages_;
+  };
+
+  // 离线事件驱动回测器：在单线程和模拟时钟上运行真实的 MatchingEngine/MEOrderBook 与 TradeEngine
+  // 外部订单流（录制或合成的 MEClientRequest）按其时间戳进入撮合引擎
+  // 撮合引擎产生的市场数据更新和发给本客户端的响应经延迟后进入交易引擎，交易引擎的订单请求经延迟后进入撮合引擎
+  // 撮合引擎和交易引擎的线程都不启动，无锁队列仅在每个事件之后同步排空
+  class Backtester {
+  public:
+    Backtester(ClientId client_id, const std::vector<StrategyCfg> &strategy_cfgs,
+               const LatencyModel &order_latency, const LatencyModel &response_latency, const LatencyModel &md_latency)
+        : client_id_(client_id),
+          me_requests_(ME_MAX_CLIENT_UPDATES), me_responses_(ME_MAX_CLIENT_UPDATES), me_md_updates_(ME_MAX_MARKET_UPDATES),
+          te_requests_(ME_MAX_CLIENT_UPDATES), te_responses_(ME_MAX_CLIENT_UPDATES), te_md_updates_(ME_MAX_MARKET_UPDATES),
+          me_md_reader_(me_md_updates_.addReader()),
+          matching_engine_(&me_requests_, &me_responses_, &me_md_updates_),
+          trade_engine_(client_id, strategy_cfgs, &te_requests_, &te_responses_, &te_md_updates_),
+          order_channel_(order_latency), response_channel_(response_latency), md_channel_(md_latency) {
+      trade_engine_.setClock(&now_);
+    }
+
+    // 加入一条外部订单请求，时间戳必须单调不减
+    auto addRequest(Nanos time, const Exchange::MEClientRequest &request) noexcept {
+      ASSERT(request.client_id_ != client_id_, "外部订单流不能使用回测客户端的ID：" + request.toString());
+      ASSERT(external_requests_.empty() || time >= external_requests_.back().first,
+             "外部订单流的时间戳必须单调不减：" + std::to_string(time));
+      external_requests_.push_back({time, request});
+    }
+
+    // 按模拟时间顺序处理全部事件，直到外部订单流耗尽且所有链路为空
+    // 同一时刻的事件按 外部订单、本客户端订单、客户端响应、市场数据 的顺序处理
+    auto run() noexcept -> void {
+      while (true) {
+        const auto external_time = (external_requests_.empty() ? std::numeric_limits<Nanos>::max() : external_requests_.front().first);
+        const auto next_time = std::min({external_time, order_channel_.nextTime(), response_channel_.nextTime(), md_channel_.nextTime()});
+        if (next_time == std::numeric_limits<Nanos>::max())
+          break;
+
+        now_ = next_time;
+        ++num_events_;
+
+        if (external_time == next_time) {
+          matching_engine_.processClientRequest(&external_requests_.front().second);
+          external_requests_.pop_front();
+          drainMatchingEngine();
+        } else if (order_channel_.nextTime() == next_time) {
+          matching_engine_.processClientRequest(&order_channel_.front());
+          order_channel_.pop();
+          ++num_orders_;
+          drainMatchingEngine();
+        } else if (response_channel_.nextTime() == next_time) {
+          if (response_channel_.front().type_ == Exchange::ClientResponseType::FILLED)
+            ++num_fills_;
+          trade_engine_.processClientResponse(&response_channel_.front());
+          response_channel_.pop();
+          drainTradeEngine();
+        } else {
+          trade_engine_.processMarketUpdate(&md_channel_.front());
+          md_channel_.pop();
+          drainTradeEngine();
+        }
+      }
+    }
+
+    auto tradeEngine() noexcept {
+      return &trade_engine_;
+    }
+
+    // 当前模拟时间
+    auto now() const noexcept {
+      return now_;
+    }
+
+    auto numEvents() const noexcept {
+      return num_events_;
+    }
+
+    // 交易引擎发送到撮合引擎的订单请求数和收到的成交回报数
+    auto numOrders() const noexcept {
+      return num_orders_;
+    }
+
+    auto numFills() const noexcept {
+      return num_fills_;
+    }
+
+    Backtester() = delete;
+    Backtester(const Backtester &) = delete;
+    Backtester(const Backtester &&) = delete;
+    Backtester &operator=(const Backtester &) = delete;
+    Backtester &operator=(const Backtester &&) = delete;
+
+  private:
+    // 将撮合引擎产生的响应和市场数据更新送入发往交易引擎的链路，发给其他客户端的响应丢弃
+    auto drainMatchingEngine() noexcept -> void {
+      for (auto response = me_responses_.getNextToRead(); response; response = me_responses_.getNextToRead()) {
+        if (response->client_id_ == client_id_)
+          response_channel_.send(now_, *response);
+        me_responses_.updateReadIndex();
+      }
+
+      for (auto market_update = me_md_reader_->getNextToRead(); market_update; market_update = me_md_reader_->getNextToRead()) {
+        md_channel_.send(now_, *market_update);
+        me_md_reader_->updateReadIndex();
+      }
+    }
+
+    // 将交易引擎产生的订单请求送入发往撮合引擎的链路
+    auto drainTradeEngine() noexcept -> void {
+      for (auto request = te_requests_.getNextToRead(); request; request = te_requests_.getNextToRead()) {
+        order_channel_.send(now_, *request);
+        te_requests_.updateReadIndex();
+      }
+    }
+
+    const ClientId client_id_;
+
+    Nanos now_ = 0;  // 模拟时钟
+    size_t num_events_ = 0, num_orders_ = 0, num_fills_ = 0;
+
+    // 撮合引擎和交易引擎的无锁队列，每个事件处理完后同步排空
+    Exchange::ClientRequestLFQueue me_requests_;
+    Exchange::ClientResponseLFQueue me_responses_;
+    Exchange::MEMarketUpdateBroadcastQueue me_md_updates_;
+    Exchange::ClientRequestLFQueue te_requests_;
+    Exchange::ClientResponseLFQueue te_responses_;
+    Exchange::MEMarketUpdateLFQueue te_md_updates_;
+
+    // 回测器是撮合引擎市场更新广播队列的唯一读取者
+    Exchange::MEMarketUpdateBroadcastQueue::Reader *me_md_reader_ = nullptr;
+
+    Exchange::MatchingEngine matching_engine_;
+    TradeEngine trade_engine_;
+
+    // 按时间戳排序的外部订单流
+    std::deque<std::pair<Nanos, Exchange::MEClientRequest>> external_requests_;
+
+    // 交易引擎到撮合引擎的订单链路，撮合引擎到交易引擎的响应链路和市场数据链路
+    SimChannel<Exchange::MEClientRequest> order_channel_;
+    SimChannel<Exchange::MEClientResponse> response_channel_;
+    SimChannel<Exchange::MEMarketUpdate> md_channel_;
+  };
+}
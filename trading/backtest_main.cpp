@@ -0,0 +1,127 @@
+#include "backtest/backtester.h"
+
+#include "common/capture_file.h"
+
+// 回测中交易引擎使用的客户端ID，外部订单流使用 1 到 BACKTEST_NUM_EXTERNAL_CLIENTS
+constexpr Common::ClientId BACKTEST_CLIENT_ID = 0;
+constexpr Common::ClientId BACKTEST_NUM_EXTERNAL_CLIENTS = 8;
+
+// 合成订单流的长度和相邻请求的平均间隔
+constexpr size_t BACKTEST_SYNTHETIC_REQUESTS = 1000000;
+constexpr Common::Nanos BACKTEST_SYNTHETIC_INTERVAL = 10 * Common::NANOS_TO_MICROS;
+
+// 解析 "延迟ns[:抖动ns]" 格式的延迟模型
+auto parseLatencyModel(const std::string &str) {
+  Trading::LatencyModel latency_model;
+  const auto sep = str.find(':');
+  latency_model.latency_ = std::atoll(str.substr(0, sep).c_str());
+  if (sep != std::string::npos)
+    latency_model.jitter_ = std::atoll(str.substr(sep + 1).c_str());
+  return latency_model;
+}
+
+// 生成与 trading_main 中随机交易算法相同分布的外部订单流：随机新订单，每个新订单之后随机取消该客户端的一个已发送订单
+// 同时写入捕获文件，便于以相同的订单流重复回测
+auto generateSyntheticRequests(Trading::Backtester *backtester, const std::string &file_name) {
+  Common::CaptureWriter writer(file_name);
+
+  std::array<Price, ME_MAX_TICKERS> ticker_base_price;
+  for (auto &base_price: ticker_base_price)
+    base_price = (rand() % 100) + 100;
+
+  std::array<std::vector<Exchange::MEClientRequest>, BACKTEST_NUM_EXTERNAL_CLIENTS + 1> client_requests_vec;
+  std::array<Common::OrderId, BACKTEST_NUM_EXTERNAL_CLIENTS + 1> next_order_id;
+  next_order_id.fill(1);
+
+  Common::Nanos time = 0;
+  auto add_request = [&](const Exchange::MEClientRequest &request) {
+    time += 1 + rand() % (2 * BACKTEST_SYNTHETIC_INTERVAL);
+    backtester->addRequest(time, request);
+    ASSERT(writer.write(0, 0, time, &request, sizeof(request)), "捕获文件已满：" + file_name);
+  };
+
+  for (size_t i = 0; i < BACKTEST_SYNTHETIC_REQUESTS / 2; ++i) {
+    const Common::ClientId client_id = 1 + rand() % BACKTEST_NUM_EXTERNAL_CLIENTS;
+    const Common::TickerId ticker_id = rand() % Common::ME_MAX_TICKERS;
+    const Price price = ticker_base_price[ticker_id] + (rand() % 10) + 1;
+    const Qty qty = 1 + (rand() % 100) + 1;
+    const Side side = (rand() % 2 ? Common::Side::BUY : Common::Side::SELL);
+
+    const Exchange::MEClientRequest new_request{Exchange::ClientRequestType::NEW, client_id, ticker_id, next_order_id[client_id]++,
+                                                side, price, qty};
+    add_request(new_request);
+    client_requests_vec[client_id].push_back(new_request);
+
+    auto cxl_request = client_requests_vec[client_id][rand() % client_requests_vec[client_id].size()];
+    cxl_request.type_ = Exchange::ClientRequestType::CANCEL;
+    add_request(cxl_request);
+  }
+}
+
+// 从捕获文件读取外部订单流，每条记录的负载为一个 MEClientRequest，时间戳为记录的用户态时间
+auto readRecordedRequests(Trading::Backtester *backtester, const std::string &file_name) {
+  Common::CaptureReader reader(file_name);
+  const char *payload = nullptr;
+  for (auto record = reader.next(&payload); record; record = reader.next(&payload)) {
+    ASSERT(record->length_ == sizeof(Exchange::MEClientRequest), "无效的订单请求记录长度：" + std::to_string(record->length_));
+    backtester->addRequest(record->user_time_, *reinterpret_cast<const Exchange::MEClientRequest *>(payload));
+  }
+}
+
+/// 程序入口：./backtest_main 订单流 订单延迟 回报延迟 行情延迟 算法类型 [股票1参数(5个)] [股票2参数(5个)] ... [算法类型 [股票1参数(5个)] ...] ... [LOG]
+/// 订单流为捕获文件路径，或 SYNTHETIC 表示生成随机订单流（同时写入 backtest_requests.cap）
+/// 延迟格式为 "延迟ns[:抖动ns]"，策略参数与 trading_main 相同
+/// 最后一个可选参数 LOG 表示写出撮合引擎和交易引擎的日志，默认关闭日志以加快回测
+int main(int argc, char **argv) {
+  if (argc < 6) {
+    FATAL("使用方法: backtest_main 订单流文件|SYNTHETIC 订单延迟ns[:抖动ns] 回报延迟ns[:抖动ns] 行情延迟ns[:抖动ns] 算法类型 [股票1的成交量阈值 价格阈值 最大订单量 最大持仓 最大亏损] ... [算法类型 ...] ... [LOG]");
+  }
+
+  srand(1);  // 固定随机数种子，使回测可重复
+
+  // 解析可选的日志开关
+  const auto enable_log = (std::string(argv[argc - 1]) == "LOG");
+  if (enable_log)
+    --argc;
+  Common::BinLogger::setEnabled(enable_log);
+
+  const std::string requests_source = argv[1];
+  const auto order_latency = parseLatencyModel(argv[2]);
+  const auto response_latency = parseLatencyModel(argv[3]);
+  const auto md_latency = parseLatencyModel(argv[4]);
+
+  // 解析策略实例配置，格式与 trading_main 相同
+  const auto strategy_cfgs = Trading::parseStrategyCfgs(5, argc, argv);
+
+  auto backtester = new Trading::Backtester(BACKTEST_CLIENT_ID, strategy_cfgs, order_latency, response_latency, md_latency);
+
+  if (requests_source == "SYNTHETIC")
+    generateSyntheticRequests(backtester, "backtest_requests.cap");
+  else
+    readRecordedRequests(backtester, requests_source);
+
+  std::cout << "订单延迟:" << order_latency.toString() << " 回报延迟:" << response_latency.toString()
+            << " 行情延迟:" << md_latency.toString() << std::endl;
+
+  const auto start = Common::getCurrentNanos();
+  backtester->run();
+  const auto elapsed = Common::getCurrentNanos() - start;
+
+  std::cout << "事件数:" << backtester->numEvents() << " 模拟时长:" << backtester->now() << "ns 耗时:" << elapsed << "ns "
+            << "每秒事件数:" << static_cast<double>(backtester->numEvents()) * Common::NANOS_TO_SECS / std::max<Common::Nanos>(elapsed, 1)
+            << std::endl;
+  std::cout << "订单请求数:" << backtester->numOrders() << " 成交回报数:" << backtester->numFills() << std::endl;
+
+  auto trade_engine = backtester->tradeEngine();
+  for (size_t i = 0; i < trade_engine->numStrategies(); ++i) {
+    std::cout << "策略:" << i << " " << algoTypeToString(trade_engine->strategy(i)->algoType()) << "\n"
+              << trade_engine->strategy(i)->positionKeeper()->toString() << std::endl;
+  }
+
+  // 回测关闭日志时延迟测量仍记入直方图，写出各测量标签的延迟分位数
+  Common::dumpLatencyHistograms("backtest_latency.txt");
+
+  delete backtester;
+
+  exit(EXIT_SUCCESS);
+}
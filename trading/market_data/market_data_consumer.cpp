@@ -4,11 +4,13 @@ namespace Trading {
   MarketDataConsumer::MarketDataConsumer(Common::ClientId client_id, Exchange::MEMarketUpdateLFQueue *market_updates,
                                          const std::string &iface,
                                          const std::string &snapshot_ip, int snapshot_port,
-                                         const std::string &incremental_ip, int incremental_port)
+                                         const std::string &incremental_ip, int incremental_port,
+                                         Exchange::MDWireFormat wire_format)
       : incoming_md_updates_(market_updates), run_(false),
         logger_("trading_market_data_consumer_" + std::to_string(client_id) + ".log"),
         incremental_mcast_socket_(logger_), snapshot_mcast_socket_(logger_),
-        iface_(iface), snapshot_ip_(snapshot_ip), snapshot_port_(snapshot_port) {
+        iface_(iface), snapshot_ip_(snapshot_ip), snapshot_port_(snapshot_port), wire_format_(wire_format),
+        recovery_(market_updates, &logger_) {
     auto recv_callback = [this](auto socket) {
       recvCallback(socket);
     };
@@ -23,9 +25,9 @@ namespace Trading {
     snapshot_mcast_socket_.recv_callback_ = recv_callback;
   }
 
-  // 从多播套接字读取并处理消息 —— 主要工作在 recvCallback () 和 checkSnapshotSync () 方法中。
+  // 从多播套接字读取并处理消息 —— 主要工作在 recvCallback () 和 MarketDataRecovery 中。
   auto MarketDataConsumer::run() noexcept -> void {
-    logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+    logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
     while (run_) {
       incremental_mcast_socket_.sendAndRecv();
       snapshot_mcast_socket_.sendAndRecv();
@@ -34,8 +36,7 @@ namespace Trading {
 
   // 通过订阅快照多播流，启动快照同步过程。
   auto MarketDataConsumer::startSnapshotSync() -> void {
-    snapshot_queued_msgs_.clear();
-    incremental_queued_msgs_.clear();
+    recovery_.reset();
 
     ASSERT(snapshot_mcast_socket_.init(snapshot_ip_, iface_, snapshot_port_, /*is_listening*/ true) >= 0,
            "Unable to create snapshot mcast socket. error:" + std::string(std::strerror(errno)));
@@ -43,125 +44,6 @@ namespace Trading {
            "Join failed on:" + std::to_string(snapshot_mcast_socket_.socket_fd_) + " error:" + std::string(std::strerror(errno)));
   }
 
-  // 检查是否可以通过快照和增量市场数据流中已排队的市场数据更新来进行恢复 / 同步。
-  auto MarketDataConsumer::checkSnapshotSync() -> void {
-    if (snapshot_queued_msgs_.empty()) {
-      return;
-    }
-
-    const auto &first_snapshot_msg = snapshot_queued_msgs_.begin()->second;
-    if (first_snapshot_msg.type_ != Exchange::MarketUpdateType::SNAPSHOT_START) {
-      logger_.log("%:% %() % Returning because have not seen a SNAPSHOT_START yet.\n",
-                  __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
-      snapshot_queued_msgs_.clear();
-      return;
-    }
-
-    std::vector<Exchange::MEMarketUpdate> final_events;
-
-    auto have_complete_snapshot = true;
-    size_t next_snapshot_seq = 0;
-    for (auto &snapshot_itr: snapshot_queued_msgs_) {
-      logger_.log("%:% %() % % => %\n", __FILE__, __LINE__, __FUNCTION__,
-                  Common::getCurrentTimeStr(&time_str_), snapshot_itr.first, snapshot_itr.second.toString());
-      if (snapshot_itr.first != next_snapshot_seq) {
-        have_complete_snapshot = false;
-        logger_.log("%:% %() % Detected gap in snapshot stream expected:% found:% %.\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), next_snapshot_seq, snapshot_itr.first, snapshot_itr.second.toString());
-        break;
-      }
-
-      if (snapshot_itr.second.type_ != Exchange::MarketUpdateType::SNAPSHOT_START &&
-          snapshot_itr.second.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
-        final_events.push_back(snapshot_itr.second);
-
-      ++next_snapshot_seq;
-    }
-
-    if (!have_complete_snapshot) {
-      logger_.log("%:% %() % Returning because found gaps in snapshot stream.\n",
-                  __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
-      snapshot_queued_msgs_.clear();
-      return;
-    }
-
-    const auto &last_snapshot_msg = snapshot_queued_msgs_.rbegin()->second;
-    if (last_snapshot_msg.type_ != Exchange::MarketUpdateType::SNAPSHOT_END) {
-      logger_.log("%:% %() % Returning because have not seen a SNAPSHOT_END yet.\n",
-                  __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
-      return;
-    }
-
-    auto have_complete_incremental = true;
-    size_t num_incrementals = 0;
-    next_exp_inc_seq_num_ = last_snapshot_msg.order_id_ + 1;
-    for (auto inc_itr = incremental_queued_msgs_.begin(); inc_itr != incremental_queued_msgs_.end(); ++inc_itr) {
-      logger_.log("%:% %() % Checking next_exp:% vs. seq:% %.\n", __FILE__, __LINE__, __FUNCTION__,
-                  Common::getCurrentTimeStr(&time_str_), next_exp_inc_seq_num_, inc_itr->first, inc_itr->second.toString());
-
-      if (inc_itr->first < next_exp_inc_seq_num_)
-        continue;
-
-      if (inc_itr->first != next_exp_inc_seq_num_) {
-        logger_.log("%:% %() % Detected gap in incremental stream expected:% found:% %.\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), next_exp_inc_seq_num_, inc_itr->first, inc_itr->second.toString());
-        have_complete_incremental = false;
-        break;
-      }
-
-      logger_.log("%:% %() % % => %\n", __FILE__, __LINE__, __FUNCTION__,
-                  Common::getCurrentTimeStr(&time_str_), inc_itr->first, inc_itr->second.toString());
-
-      if (inc_itr->second.type_ != Exchange::MarketUpdateType::SNAPSHOT_START &&
-          inc_itr->second.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
-        final_events.push_back(inc_itr->second);
-
-      ++next_exp_inc_seq_num_;
-      ++num_incrementals;
-    }
-
-    if (!have_complete_incremental) {
-      logger_.log("%:% %() % Returning because have gaps in queued incrementals.\n",
-                  __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
-      snapshot_queued_msgs_.clear();
-      return;
-    }
-
-    for (const auto &itr: final_events) {
-      auto next_write = incoming_md_updates_->getNextToWriteTo();
-      *next_write = itr;
-      incoming_md_updates_->updateWriteIndex();
-    }
-
-    logger_.log("%:% %() % Recovered % snapshot and % incremental orders.\n", __FILE__, __LINE__, __FUNCTION__,
-                Common::getCurrentTimeStr(&time_str_), snapshot_queued_msgs_.size() - 2, num_incrementals);
-
-    snapshot_queued_msgs_.clear();
-    incremental_queued_msgs_.clear();
-    in_recovery_ = false;
-
-    snapshot_mcast_socket_.leave(snapshot_ip_, snapshot_port_);;
-  }
-
-  // 在 *_queued_msgs_ 容器中排队一条消息，第一个参数指定此更新来自快照流还是增量流。
-  auto MarketDataConsumer::queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate *request) {
-    if (is_snapshot) {
-      if (snapshot_queued_msgs_.find(request->seq_num_) != snapshot_queued_msgs_.end()) {
-        logger_.log("%:% %() % Packet drops on snapshot socket. Received for a 2nd time:%\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), request->toString());
-        snapshot_queued_msgs_.clear();
-      }
-      snapshot_queued_msgs_[request->seq_num_] = request->me_market_update_;
-    } else {
-      incremental_queued_msgs_[request->seq_num_] = request->me_market_update_;
-    }
-
-    logger_.log("%:% %() % size snapshot:% incremental:% % => %\n", __FILE__, __LINE__, __FUNCTION__,
-                Common::getCurrentTimeStr(&time_str_), snapshot_queued_msgs_.size(), incremental_queued_msgs_.size(), request->seq_num_, request->toString());
-
-    checkSnapshotSync();
-  }
-
   // 处理市场数据更新时，消费者需要使用套接字参数来判断该更新来自来自快照流还是增量流。
   auto MarketDataConsumer::recvCallback(McastSocket *socket) noexcept -> void {
     TTT_MEASURE(T7_MarketDataConsumer_UDP_read, logger_);
@@ -172,45 +54,79 @@ namespace Trading {
       socket->next_rcv_valid_index_ = 0;
 
       logger_.log("%:% %() % WARN Not expecting snapshot messages.\n",
-                  __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+                  __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
 
       return;
     }
 
-    if (socket->next_rcv_valid_index_ >= sizeof(Exchange::MDPMarketUpdate)) {
+    if (!is_snapshot && wire_format_ == Exchange::MDWireFormat::COMPACT) { // 增量流为紧凑格式，逐包解码
+      size_t num_dropped = 0;
+      const auto i = Exchange::decodeCompactPackets(socket->inbound_data_.data(), socket->next_rcv_valid_index_,
+                                                    [this](const Exchange::MDPMarketUpdate &request) {
+                                                      onMarketUpdate(false, &request);
+                                                    }, &num_dropped);
+      if (UNLIKELY(num_dropped)) // 损坏的包被整体丢弃，其序列号缺口在收到后续更新时触发快照恢复
+        logger_.log("%:% %() % WARN Dropped % corrupt compact packets.\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentLogTime(), num_dropped);
+      memcpy(socket->inbound_data_.data(), socket->inbound_data_.data() + i, socket->next_rcv_valid_index_ - i);
+      socket->next_rcv_valid_index_ -= i;
+    } else if (socket->next_rcv_valid_index_ >= sizeof(Exchange::MDPMarketUpdate)) {
       size_t i = 0;
       for (; i + sizeof(Exchange::MDPMarketUpdate) <= socket->next_rcv_valid_index_; i += sizeof(Exchange::MDPMarketUpdate)) {
         auto request = reinterpret_cast<const Exchange::MDPMarketUpdate *>(socket->inbound_data_.data() + i);
-        logger_.log("%:% %() % Received % socket len:% %\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_),
-                    (is_snapshot ? "snapshot" : "incremental"), sizeof(Exchange::MDPMarketUpdate), request->toString());
-
-        const bool already_in_recovery = in_recovery_;
-        in_recovery_ = (already_in_recovery || request->seq_num_ != next_exp_inc_seq_num_);
-
-        if (UNLIKELY(in_recovery_)) {
-          if (UNLIKELY(!already_in_recovery)) { // 如果我们刚刚进入恢复状态，请通过订阅快照多播流来启动快照同步过程。
-            logger_.log("%:% %() % Packet drops on % socket. SeqNum expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__,
-                        Common::getCurrentTimeStr(&time_str_), (is_snapshot ? "snapshot" : "incremental"), next_exp_inc_seq_num_, request->seq_num_);
-            startSnapshotSync();
-          }
-
-          queueMessage(is_snapshot, request); // 将市场数据更新消息加入队列，并检查快照恢复 / 同步是否能成功完成。
-        } else if (!is_snapshot) { // 未处于恢复状态，且收到的数据包顺序正确、无缺失，对其进行处理。
-          logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__,
-                      Common::getCurrentTimeStr(&time_str_), request->toString());
-
-          ++next_exp_inc_seq_num_;
-
-          auto next_write = incoming_md_updates_->getNextToWriteTo();
-          *next_write = std::move(request->me_market_update_);
-          incoming_md_updates_->updateWriteIndex();
-          TTT_MEASURE(T8_MarketDataConsumer_LFQueue_write, logger_);
-        }
+        onMarketUpdate(is_snapshot, request);
       }
       memcpy(socket->inbound_data_.data(), socket->inbound_data_.data() + i, socket->next_rcv_valid_index_ - i);
       socket->next_rcv_valid_index_ -= i;
     }
+    publishMarketUpdates();  // 本次读取到的全部市场数据更新一次性发布给交易引擎
     END_MEASURE(Trading_MarketDataConsumer_recvCallback, logger_);
   }
-}
+
+  // 发布本次接收回调中已写入无锁队列的市场数据更新
+  auto MarketDataConsumer::publishMarketUpdates() noexcept -> void {
+    if (pending_md_updates_) {
+      incoming_md_updates_->publishWrite(pending_md_updates_);
+      pending_md_updates_ = 0;
+      TTT_MEASURE(T8_MarketDataConsumer_LFQueue_write, logger_);
+    }
+  }
+
+  // 处理一条来自快照流或增量流的市场数据更新：按序列号检测丢包并在需要时进入快照恢复
+  auto MarketDataConsumer::onMarketUpdate(bool is_snapshot, const Exchange::MDPMarketUpdate *request) noexcept -> void {
+    logger_.log("%:% %() % Received % socket len:% %\n", __FILE__, __LINE__, __FUNCTION__,
+                Common::getCurrentLogTime(),
+                (is_snapshot ? "snapshot" : "incremental"), sizeof(Exchange::MDPMarketUpdate), request);
+
+    const bool already_in_recovery = in_recovery_;
+    in_recovery_ = (already_in_recovery || request->seq_num_ != next_exp_inc_seq_num_);
+
+    if (UNLIKELY(in_recovery_)) {
+      // 恢复完成时快照和增量更新直接写入无锁队列，先发布此前已写入的更新以保持顺序
+      publishMarketUpdates();
+
+      if (UNLIKELY(!already_in_recovery)) { // 如果我们刚刚进入恢复状态，请通过订阅快照多播流来启动快照同步过程。
+        logger_.log("%:% %() % Packet drops on % socket. SeqNum expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentLogTime(), (is_snapshot ? "snapshot" : "incremental"), next_exp_inc_seq_num_, request->seq_num_);
+        startSnapshotSync();
+      }
+
+      // 将市场数据更新消息加入队列，并检查快照恢复 / 同步是否能成功完成。
+      if (recovery_.queueMessage(is_snapshot, request)) {
+        next_exp_inc_seq_num_ = recovery_.nextExpIncSeqNum();
+        in_recovery_ = false;
+
+        snapshot_mcast_socket_.leave(snapshot_ip_, snapshot_port_);
+      }
+    } else if (!is_snapshot) { // 未处于恢复状态，且收到的数据包顺序正确、无缺失，对其进行处理。
+      logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+                  Common::getCurrentLogTime(), request);
+
+      ++next_exp_inc_seq_num_;
+
+      // 写入无锁队列中已申请的下一个槽位，在本次接收回调结束时发布
+      incoming_md_updates_->claimWrite(pending_md_updates_ + 1)[pending_md_updates_] = request->me_market_update_;
+      ++pending_md_updates_;
+    }
+  }
+}
\ No newline at end of file
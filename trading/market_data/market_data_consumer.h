@@ -1,7 +1,6 @@
 #pragma once
 
 #include <functional>
-#include <map>
 
 #include "common/thread_utils.h"
 #include "common/lf_queue.h"
@@ -9,13 +8,17 @@
 #include "common/mcast_socket.h"
 
 #include "exchange/market_data/market_update.h"
+#include "exchange/market_data/compact_market_update.h"
+
+#include "market_data_recovery.h"
 
 namespace Trading {
   class MarketDataConsumer {
   public:
     MarketDataConsumer(Common::ClientId client_id, Exchange::MEMarketUpdateLFQueue *market_updates, const std::string &iface,
                        const std::string &snapshot_ip, int snapshot_port,
-                       const std::string &incremental_ip, int incremental_port);
+                       const std::string &incremental_ip, int incremental_port,
+                       Exchange::MDWireFormat wire_format = Exchange::MDWireFormat::FIXED);
 
     ~MarketDataConsumer() {
       stop();
@@ -45,10 +48,12 @@ namespace Trading {
 
     Exchange::MEMarketUpdateLFQueue *incoming_md_updates_ = nullptr;
 
+    // 本次接收回调中已写入无锁队列但尚未发布的市场数据更新数量
+    size_t pending_md_updates_ = 0;
+
     volatile bool run_ = false;
 
-    std::string time_str_;
-    Logger logger_;
+    BinLogger logger_;
 
     Common::McastSocket incremental_mcast_socket_, snapshot_mcast_socket_;
 
@@ -57,14 +62,17 @@ namespace Trading {
     const std::string iface_, snapshot_ip_;
     const int snapshot_port_;
 
-    typedef std::map<size_t, Exchange::MEMarketUpdate> QueuedMarketUpdates;
-    QueuedMarketUpdates snapshot_queued_msgs_, incremental_queued_msgs_;
+    // 增量流的线路格式，快照流始终为定长格式
+    const Exchange::MDWireFormat wire_format_;
+
+    // 恢复期间按序列号排队快照流和增量流的消息
+    MarketDataRecovery recovery_;
 
   private:
     auto run() noexcept -> void;
     auto recvCallback(McastSocket *socket) noexcept -> void;
-    auto queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate *request);
+    auto onMarketUpdate(bool is_snapshot, const Exchange::MDPMarketUpdate *request) noexcept -> void;
+    auto publishMarketUpdates() noexcept -> void;
     auto startSnapshotSync() -> void;
-    auto checkSnapshotSync() -> void;
   };
 }
@@ -0,0 +1,106 @@
+#include "market_data_recovery.h"
+
+namespace Trading {
+  MarketDataRecovery::MarketDataRecovery(Exchange::MEMarketUpdateLFQueue *market_updates, BinLogger *logger)
+      : incoming_md_updates_(market_updates), logger_(logger),
+        snapshot_queued_msgs_(ME_MAX_ORDER_IDS), incremental_queued_msgs_(ME_MAX_MARKET_UPDATES) {
+  }
+
+  // 开始新的恢复过程，丢弃所有已排队的消息
+  auto MarketDataRecovery::reset() noexcept -> void {
+    snapshot_queued_msgs_.reset(0);
+    incremental_queued_msgs_.reset(0);
+    have_incremental_begin_ = false;
+  }
+
+  // 排队一条市场更新，仅在连续水位线前进时检查恢复是否完成
+  auto MarketDataRecovery::queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate *request) noexcept -> bool {
+    bool advanced = false;
+    if (is_snapshot) {
+      if (request->seq_num_ == 0 && request->me_market_update_.type_ == Exchange::MarketUpdateType::SNAPSHOT_START) {
+        // 新的快照周期开始，丢弃上一个周期的所有消息，避免中途加入时残留的后半个周期与新周期拼接
+        snapshot_queued_msgs_.reset(0);
+      } else if (!snapshot_queued_msgs_.contains(0) || snapshot_queued_msgs_.at(0).type_ != Exchange::MarketUpdateType::SNAPSHOT_START) {
+        // 尚未收到本周期的 SNAPSHOT_START，在周期中途加入，丢弃直到下一个周期开始
+        logger_->log("%:% %() % Discarding snapshot seq:% before SNAPSHOT_START.\n", __FILE__, __LINE__, __FUNCTION__,
+                     Common::getCurrentLogTime(), request->seq_num_);
+        snapshot_queued_msgs_.reset(0);
+        return false;
+      } else if (snapshot_queued_msgs_.contains(request->seq_num_)) {
+        logger_->log("%:% %() % Packet drops on snapshot socket. Received for a 2nd time:%\n", __FILE__, __LINE__, __FUNCTION__,
+                     Common::getCurrentLogTime(), request);
+        snapshot_queued_msgs_.reset(0);
+      }
+      advanced = snapshot_queued_msgs_.insert(request->seq_num_, request->me_market_update_);
+    } else {
+      if (UNLIKELY(!have_incremental_begin_)) {
+        incremental_queued_msgs_.reset(request->seq_num_);
+        have_incremental_begin_ = true;
+      }
+      advanced = incremental_queued_msgs_.insert(request->seq_num_, request->me_market_update_);
+    }
+
+    logger_->log("%:% %() % snapshot watermark:% incremental begin:% watermark:% end:% % => %\n", __FILE__, __LINE__, __FUNCTION__,
+                 Common::getCurrentLogTime(), snapshot_queued_msgs_.watermark(), incremental_queued_msgs_.begin(),
+                 incremental_queued_msgs_.watermark(), incremental_queued_msgs_.end(), request->seq_num_, request);
+
+    return (advanced && checkSnapshotSync());
+  }
+
+  // 检查是否可以通过已排队的快照和增量更新完成恢复：
+  // 快照从 SNAPSHOT_START 到 SNAPSHOT_END 连续无缺失，且增量流从快照对应的序列号之后连续无缺失
+  auto MarketDataRecovery::checkSnapshotSync() noexcept -> bool {
+    const auto snapshot_watermark = snapshot_queued_msgs_.watermark();
+    if (snapshot_watermark == 0)
+      return false;
+
+    if (!snapshot_queued_msgs_.contains(0) || snapshot_queued_msgs_.at(0).type_ != Exchange::MarketUpdateType::SNAPSHOT_START) {
+      logger_->log("%:% %() % Returning because have not seen a SNAPSHOT_START yet.\n",
+                   __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
+      snapshot_queued_msgs_.reset(0);
+      return false;
+    }
+
+    const auto &last_snapshot_msg = snapshot_queued_msgs_.at(snapshot_watermark - 1);
+    if (last_snapshot_msg.type_ != Exchange::MarketUpdateType::SNAPSHOT_END)
+      return false;
+
+    const size_t next_exp_inc_seq_num = last_snapshot_msg.order_id_ + 1;
+    if (have_incremental_begin_ && incremental_queued_msgs_.begin() > next_exp_inc_seq_num) {
+      logger_->log("%:% %() % Detected gap in incremental stream expected:% found:%.\n", __FILE__, __LINE__, __FUNCTION__,
+                   Common::getCurrentLogTime(), next_exp_inc_seq_num, incremental_queued_msgs_.begin());
+      snapshot_queued_msgs_.reset(0);
+      return false;
+    }
+
+    // 丢弃快照已包含的增量更新，其后的增量更新必须连续
+    incremental_queued_msgs_.advanceBegin(next_exp_inc_seq_num);
+    if (incremental_queued_msgs_.watermark() != incremental_queued_msgs_.end()) {
+      logger_->log("%:% %() % Returning because have gaps in queued incrementals watermark:% end:%.\n", __FILE__, __LINE__, __FUNCTION__,
+                   Common::getCurrentLogTime(), incremental_queued_msgs_.watermark(), incremental_queued_msgs_.end());
+      return false;
+    }
+
+    // 依次将快照和增量更新直接写入无锁队列
+    auto publish = [this](const Exchange::MEMarketUpdate &market_update) {
+      if (market_update.type_ != Exchange::MarketUpdateType::SNAPSHOT_START &&
+          market_update.type_ != Exchange::MarketUpdateType::SNAPSHOT_END) {
+        auto next_write = incoming_md_updates_->getNextToWriteTo();
+        *next_write = market_update;
+        incoming_md_updates_->updateWriteIndex();
+      }
+    };
+    for (size_t seq = 0; seq < snapshot_watermark; ++seq)
+      publish(snapshot_queued_msgs_.at(seq));
+    for (auto seq = next_exp_inc_seq_num; seq < incremental_queued_msgs_.watermark(); ++seq)
+      publish(incremental_queued_msgs_.at(seq));
+
+    next_exp_inc_seq_num_ = std::max(next_exp_inc_seq_num, incremental_queued_msgs_.watermark());
+
+    logger_->log("%:% %() % Recovered % snapshot and % incremental orders.\n", __FILE__, __LINE__, __FUNCTION__,
+                 Common::getCurrentLogTime(), snapshot_watermark - 2, next_exp_inc_seq_num_ - next_exp_inc_seq_num);
+
+    reset();
+    return true;
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/seq_ring.h"
+#include "common/bin_logging.h"
+
+#include "exchange/market_data/market_update.h"
+
+namespace Trading {
+  // 快照恢复：按序列号将快照流和增量流的市场更新排队到环形缓冲区中，每条消息O(1)
+  // 仅在某个流的连续水位线前进时，才检查能否用完整快照加其后连续的增量更新重建订单簿
+  class MarketDataRecovery {
+  public:
+    MarketDataRecovery(Exchange::MEMarketUpdateLFQueue *market_updates, BinLogger *logger);
+
+    // 开始新的恢复过程，丢弃所有已排队的消息
+    auto reset() noexcept -> void;
+
+    // 排队一条市场更新，第一个参数指定此更新来自快照流还是增量流
+    // 若恢复完成，快照和增量更新已按顺序写入无锁队列，返回true
+    auto queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate *request) noexcept -> bool;
+
+    // 恢复完成后下一个期望的增量序列号
+    auto nextExpIncSeqNum() const noexcept {
+      return next_exp_inc_seq_num_;
+    }
+
+    MarketDataRecovery() = delete;
+    MarketDataRecovery(const MarketDataRecovery &) = delete;
+    MarketDataRecovery(const MarketDataRecovery &&) = delete;
+    MarketDataRecovery &operator=(const MarketDataRecovery &) = delete;
+    MarketDataRecovery &operator=(const MarketDataRecovery &&) = delete;
+
+  private:
+    // 检查是否可以通过已排队的快照和增量更新完成恢复
+    auto checkSnapshotSync() noexcept -> bool;
+
+    Exchange::MEMarketUpdateLFQueue *incoming_md_updates_ = nullptr;
+
+    BinLogger *logger_ = nullptr;
+
+    size_t next_exp_inc_seq_num_ = 0;
+
+    // 快照序列号每个周期从0（SNAPSHOT_START）开始，增量流的窗口从恢复期间收到的第一条增量更新开始
+    Common::SeqRing<Exchange::MEMarketUpdate> snapshot_queued_msgs_, incremental_queued_msgs_;
+    bool have_incremental_begin_ = false;
+  };
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <array>
+
+namespace Trading {
+  // 市场数据多播通道配置，数组下标即捕获文件中记录的通道号
+  struct MDChannel {
+    const char *name_;
+    const char *ip_;
+    int port_;
+  };
+
+  inline constexpr std::array<MDChannel, 3> MD_CHANNELS = {{
+    {"SNAPSHOT", "233.252.14.1", 20000},
+    {"INCREMENTAL", "233.252.14.3", 20001},
+    {"BBO", "233.252.14.5", 20002}
+  }};
+}
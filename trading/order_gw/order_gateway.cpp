@@ -12,7 +12,7 @@ namespace Trading {
 
   // 向交易所发送客户端请求，并读取和分发传入的客户端响应。
   auto OrderGateway::run() noexcept -> void {
-    logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+    logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
     while (run_) {
       tcp_socket_.sendAndRecv();
 
@@ -20,7 +20,7 @@ namespace Trading {
         TTT_MEASURE(T11_OrderGateway_LFQueue_read, logger_);
 
         logger_.log("%:% %() % Sending cid:% seq:% %\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), client_id_, next_outgoing_seq_num_, client_request->toString());
+                    Common::getCurrentLogTime(), client_id_, next_outgoing_seq_num_, client_request);
         START_MEASURE(Trading_TCPSocket_send);
         tcp_socket_.send(&next_outgoing_seq_num_, sizeof(next_outgoing_seq_num_));
         tcp_socket_.send(client_request, sizeof(Exchange::MEClientRequest));
@@ -38,22 +38,22 @@ namespace Trading {
     TTT_MEASURE(T7t_OrderGateway_TCP_read, logger_);
 
     START_MEASURE(Trading_OrderGateway_recvCallback);
-    logger_.log("%:% %() % Received socket:% len:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), socket->socket_fd_, socket->next_rcv_valid_index_, rx_time);
+    logger_.log("%:% %() % Received socket:% len:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), socket->socket_fd_, socket->next_rcv_valid_index_, rx_time);
 
     if (socket->next_rcv_valid_index_ >= sizeof(Exchange::OMClientResponse)) {
       size_t i = 0;
       for (; i + sizeof(Exchange::OMClientResponse) <= socket->next_rcv_valid_index_; i += sizeof(Exchange::OMClientResponse)) {
         auto response = reinterpret_cast<const Exchange::OMClientResponse *>(socket->inbound_data_.data() + i);
-        logger_.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), response->toString());
+        logger_.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), response);
 
         if(response->me_client_response_.client_id_ != client_id_) { // 这种情况绝不可能发生，除非交易所存在漏洞。
           logger_.log("%:% %() % ERROR Incorrect client id. ClientId expected:% received:%.\n", __FILE__, __LINE__, __FUNCTION__,
-                      Common::getCurrentTimeStr(&time_str_), client_id_, response->me_client_response_.client_id_);
+                      Common::getCurrentLogTime(), client_id_, response->me_client_response_.client_id_);
           continue;
         }
         if(response->seq_num_ != next_exp_seq_num_) { // 这种情况绝不可能发生，因为我们使用的是可靠的 TCP 协议，除非交易所存在漏洞。
           logger_.log("%:% %() % ERROR Incorrect sequence number. ClientId:%. SeqNum expected:% received:%.\n", __FILE__, __LINE__, __FUNCTION__,
-                      Common::getCurrentTimeStr(&time_str_), client_id_, next_exp_seq_num_, response->seq_num_);
+                      Common::getCurrentLogTime(), client_id_, next_exp_seq_num_, response->seq_num_);
           continue;
         }
 
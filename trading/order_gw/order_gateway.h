@@ -54,8 +54,7 @@ namespace Trading {
 
     volatile bool run_ = false;
 
-    std::string time_str_;
-    Logger logger_;
+    BinLogger logger_;
 
     size_t next_outgoing_seq_num_ = 1;
     size_t next_exp_seq_num_ = 1;
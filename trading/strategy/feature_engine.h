@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cmath>
+#include <tuple>
+#include <sstream>
+
 #include "common/macros.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
+
+#include "market_order_book.h"
 
 using namespace Common;
 
@@ -9,56 +15,349 @@ namespace Trading {
   // 用于表示无效/未初始化特征值的标记值
   constexpr auto Feature_INVALID = std::numeric_limits<double>::quiet_NaN();
 
-  class FeatureEngine {
-  public:
-    FeatureEngine(Common::Logger *logger)
-        : logger_(logger) {
+  // 特征参数
+  constexpr double FEATURE_EWMA_MID_ALPHA = 0.1;           // 每次订单簿更新时新中间价的权重
+  constexpr double FEATURE_FLOW_DECAY = 0.9;               // 每个成交/订单事件后累计成交流和订单流的衰减系数
+  constexpr Nanos FEATURE_VWAP_WINDOW = 1 * NANOS_TO_SECS;  // VWAP的时间衰减常数
+  constexpr Nanos FEATURE_VOL_WINDOW = 1 * NANOS_TO_SECS;   // 已实现波动率的时间衰减常数
+
+  // 计算时间衰减特征所用的时钟，仅在特征需要时读取
+  struct FeatureClock {
+    const Nanos *clock_ = nullptr;  // 模拟时钟，为 nullptr 时使用系统时钟
+
+    auto now() const noexcept -> Nanos {
+      return (clock_ ? *clock_ : Common::getCurrentTscNanos());
     }
+  };
 
-    // 处理订单簿变化，计算公允市场价格
-    auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook* book) noexcept -> void {
+  // 每个特征是一个计算器结构体：
+  //   NAME    特征名称
+  //   State   增量计算所需的每个股票的中间状态
+  //   以及以下回调中的任意几个，只在特征被订阅时调用，value 为该股票的特征值
+  //   onMarketUpdate(State &, double &value, const MEMarketUpdate *, const FeatureClock &)          订单簿更新之前的原始市场数据更新
+  //   onOrderBookUpdate(State &, double &value, const MarketOrderBook *, const FeatureClock &)      订单簿变化
+  //   onTradeUpdate(State &, double &value, const MEMarketUpdate *, const MarketOrderBook *, const FeatureClock &)  成交
+  // 新增特征只需实现一个计算器并加入下方的 Features 列表
+
+  // 按BBO数量加权的公允市场价格
+  struct MktPriceFeature {
+    static constexpr const char *NAME = "MKT_PRICE";
+    struct State {
+    };
+
+    static auto onOrderBookUpdate(State &, double &value, const MarketOrderBook *book, const FeatureClock &) noexcept {
+      const auto bbo = book->getBBO();
+      if (LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID))
+        value = (bbo->bid_price_ * bbo->ask_qty_ + bbo->ask_price_ * bbo->bid_qty_) / static_cast<double>(bbo->bid_qty_ + bbo->ask_qty_);
+    }
+  };
+
+  // 激进交易数量与对手方BBO数量之比
+  struct AggTradeQtyRatioFeature {
+    static constexpr const char *NAME = "AGG_TRADE_QTY_RATIO";
+    struct State {
+    };
+
+    static auto onTradeUpdate(State &, double &value, const Exchange::MEMarketUpdate *market_update, const MarketOrderBook *book,
+                              const FeatureClock &) noexcept {
+      const auto bbo = book->getBBO();
+      if (LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID))
+        value = static_cast<double>(market_update->qty_) / (market_update->side_ == Side::BUY ? bbo->ask_qty_ : bbo->bid_qty_);
+    }
+  };
+
+  // 前 MKT_DEPTH_LEVELS 档的买卖数量不平衡度，取值范围[-1, 1]
+  struct BookImbalanceFeature {
+    static constexpr const char *NAME = "BOOK_IMBALANCE";
+    struct State {
+    };
+
+    static auto onOrderBookUpdate(State &, double &value, const MarketOrderBook *book, const FeatureClock &) noexcept {
+      const auto depth = book->getDepth();
+      const auto bid_qty = static_cast<double>(depth->bids_.totalQty()), ask_qty = static_cast<double>(depth->asks_.totalQty());
+      if (LIKELY(bid_qty + ask_qty > 0))
+        value = (bid_qty - ask_qty) / (bid_qty + ask_qty);
+    }
+  };
+
+  // 中间价的指数加权移动平均
+  struct EwmaMidFeature {
+    static constexpr const char *NAME = "EWMA_MID";
+    struct State {
+    };
+
+    static auto onOrderBookUpdate(State &, double &value, const MarketOrderBook *book, const FeatureClock &) noexcept {
       const auto bbo = book->getBBO();
-      if(LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID)) {
-        mkt_price_ = (bbo->bid_price_ * bbo->ask_qty_ + bbo->ask_price_ * bbo->bid_qty_) / static_cast<double>(bbo->bid_qty_ + bbo->ask_qty_);
+      if (LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID)) {
+        const auto mid = (bbo->bid_price_ + bbo->ask_price_) * 0.5;
+        value = (std::isnan(value) ? mid : FEATURE_EWMA_MID_ALPHA * mid + (1 - FEATURE_EWMA_MID_ALPHA) * value);
       }
+    }
+  };
+
+  // 按事件衰减的主动买入与主动卖出成交量不平衡度，取值范围[-1, 1]
+  struct TradeFlowImbalanceFeature {
+    static constexpr const char *NAME = "TRADE_FLOW_IMBALANCE";
+    struct State {
+      double net_trade_flow_ = 0, gross_trade_flow_ = 0;  // 衰减后的主动买卖净成交量和总成交量
+    };
 
-      logger_->log("%:% %() % ticker:% price:% side:% mkt-price:% agg-trade-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
-                   Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
-                   Common::sideToString(side).c_str(), mkt_price_, agg_trade_qty_ratio_);
+    static auto onTradeUpdate(State &state, double &value, const Exchange::MEMarketUpdate *market_update, const MarketOrderBook *,
+                              const FeatureClock &) noexcept {
+      const auto qty = static_cast<double>(market_update->qty_);
+      state.net_trade_flow_ = state.net_trade_flow_ * FEATURE_FLOW_DECAY + (market_update->side_ == Side::BUY ? qty : -qty);
+      state.gross_trade_flow_ = state.gross_trade_flow_ * FEATURE_FLOW_DECAY + qty;
+      if (LIKELY(state.gross_trade_flow_ > 0))
+        value = state.net_trade_flow_ / state.gross_trade_flow_;
     }
+  };
 
-    // 处理交易事件，计算用于捕捉相对于BBO数量的激进交易数量比率的特征
-    auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook* book) noexcept -> void {
+  // 按时间衰减的成交量加权平均价
+  struct VwapFeature {
+    static constexpr const char *NAME = "VWAP";
+    struct State {
+      double vwap_price_qty_ = 0, vwap_qty_ = 0;  // 衰减后的成交额和成交量
+      Nanos last_trade_time_ = 0;
+    };
+
+    static auto onTradeUpdate(State &state, double &value, const Exchange::MEMarketUpdate *market_update, const MarketOrderBook *,
+                              const FeatureClock &clock) noexcept {
+      const auto qty = static_cast<double>(market_update->qty_);
+      const auto now = clock.now();
+      const auto decay = std::exp(-static_cast<double>(now - state.last_trade_time_) / FEATURE_VWAP_WINDOW);
+      state.vwap_price_qty_ = state.vwap_price_qty_ * decay + static_cast<double>(market_update->price_) * qty;
+      state.vwap_qty_ = state.vwap_qty_ * decay + qty;
+      state.last_trade_time_ = now;
+      if (LIKELY(state.vwap_qty_ > 0))
+        value = state.vwap_price_qty_ / state.vwap_qty_;
+    }
+  };
+
+  // 按时间衰减的中间价对数收益率已实现波动率
+  struct RealizedVolFeature {
+    static constexpr const char *NAME = "REALIZED_VOL";
+    struct State {
+      double last_mid_ = 0, realized_variance_ = 0;  // 上一个中间价和衰减后的对数收益率平方和
+      Nanos last_mid_time_ = 0;
+    };
+
+    // 中间价变化时累加对数收益率的平方，累计值随时间按指数衰减
+    static auto onOrderBookUpdate(State &state, double &value, const MarketOrderBook *book, const FeatureClock &clock) noexcept {
       const auto bbo = book->getBBO();
-      if(LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID)) {
-        agg_trade_qty_ratio_ = static_cast<double>(market_update->qty_) / (market_update->side_ == Side::BUY ? bbo->ask_qty_ : bbo->bid_qty_);
+      if (UNLIKELY(bbo->bid_price_ == Price_INVALID || bbo->ask_price_ == Price_INVALID))
+        return;
+
+      const auto mid = (bbo->bid_price_ + bbo->ask_price_) * 0.5;
+      if (mid == state.last_mid_)
+        return;
+
+      const auto now = clock.now();
+      if (LIKELY(state.last_mid_ > 0)) {
+        const auto log_return = std::log(mid / state.last_mid_);
+        state.realized_variance_ = state.realized_variance_ * std::exp(-static_cast<double>(now - state.last_mid_time_) / FEATURE_VOL_WINDOW) +
+                                   log_return * log_return;
+        value = std::sqrt(state.realized_variance_);
       }
+      state.last_mid_ = mid;
+      state.last_mid_time_ = now;
+    }
+  };
+
+  // 按事件衰减的 ADD/CANCEL 订单流不平衡度，取值范围[-1, 1]
+  // 买方新增和卖方撤单视为买压，卖方新增和买方撤单视为卖压，CANCEL 的数量为撤单时的剩余数量
+  struct OrderFlowImbalanceFeature {
+    static constexpr const char *NAME = "ORDER_FLOW_IMBALANCE";
+    struct State {
+      double net_order_flow_ = 0, gross_order_flow_ = 0;  // 衰减后的订单流净数量和总数量
+    };
+
+    static auto onMarketUpdate(State &state, double &value, const Exchange::MEMarketUpdate *market_update, const FeatureClock &) noexcept {
+      if (market_update->type_ != Exchange::MarketUpdateType::ADD && market_update->type_ != Exchange::MarketUpdateType::CANCEL)
+        return;
+
+      const auto qty = static_cast<double>(market_update->qty_);
+      const auto is_buy_pressure = ((market_update->type_ == Exchange::MarketUpdateType::ADD) == (market_update->side_ == Side::BUY));
+      state.net_order_flow_ = state.net_order_flow_ * FEATURE_FLOW_DECAY + (is_buy_pressure ? qty : -qty);
+      state.gross_order_flow_ = state.gross_order_flow_ * FEATURE_FLOW_DECAY + qty;
+      if (LIKELY(state.gross_order_flow_ > 0))
+        value = state.net_order_flow_ / state.gross_order_flow_;
+    }
+  };
+
+  // 特征注册表：特征编号为计算器在列表中的位置，每个股票的特征值按此顺序连续存放
+  template<typename... F>
+  struct FeatureList {
+    static constexpr size_t COUNT = sizeof...(F);
+
+    static constexpr std::array<const char *, COUNT> NAMES = {F::NAME...};
+
+    template<typename T>
+    static consteval auto indexOf() noexcept -> size_t {
+      static_assert((std::is_same_v<T, F> || ...), "Feature is not registered in the FeatureList.");
+      constexpr bool matches[] = {std::is_same_v<T, F>...};
+      size_t index = 0;
+      while (!matches[index])
+        ++index;
+      return index;
+    }
+  };
 
-      logger_->log("%:% %() % % mkt-price:% agg-trade-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
-                   Common::getCurrentTimeStr(&time_str_),
-                   market_update->toString().c_str(), mkt_price_, agg_trade_qty_ratio_);
+  // 特征引擎计算的全部特征
+  using Features = FeatureList<MktPriceFeature, AggTradeQtyRatioFeature, BookImbalanceFeature, EwmaMidFeature,
+                               TradeFlowImbalanceFeature, VwapFeature, RealizedVolFeature, OrderFlowImbalanceFeature>;
+
+  // 特征订阅掩码，每个特征占一位
+  typedef uint32_t FeatureMask;
+  static_assert(Features::COUNT <= sizeof(FeatureMask) * 8, "Too many features for FeatureMask.");
+
+  template<typename T>
+  constexpr auto featureMask() noexcept -> FeatureMask {
+    return (1u << Features::indexOf<T>());
+  }
+
+  // 单个股票的全部特征值，按缓存行对齐
+  struct alignas(64) FeatureVector {
+    std::array<double, Features::COUNT> values_;
+
+    auto toString() const {
+      std::stringstream ss;
+      for (size_t i = 0; i < values_.size(); ++i)
+        ss << (i ? " " : "") << Features::NAMES[i] << ":" << values_[i];
+      return ss.str();
+    }
+  };
+
+  template<typename Registry>
+  class BasicFeatureEngine;
+
+  // 按特征注册表分发市场事件到各特征计算器，未被任何算法订阅的特征不计算
+  template<typename... F>
+  class BasicFeatureEngine<FeatureList<F...>> {
+  public:
+    using Registry = FeatureList<F...>;
+
+    BasicFeatureEngine(Common::BinLogger *logger)
+        : logger_(logger) {
+      for (auto &features: ticker_features_)
+        features.values_.fill(Feature_INVALID);
+    }
+
+    // 订阅交易算法使用的特征
+    auto subscribe(FeatureMask features) noexcept {
+      subscribed_ |= features;
+    }
+
+    template<typename T>
+    auto isSubscribed() const noexcept {
+      return (subscribed_ & featureMask<T>()) != 0;
+    }
+
+    // 设置计算时间衰减特征所用的时钟，为 nullptr 时使用系统时钟，回测时指向模拟时钟
+    auto setClock(const Nanos *clock) noexcept {
+      clock_.clock_ = clock;
+    }
+
+    // 处理订单簿更新之前的原始市场数据更新
+    auto onMarketUpdate(const Exchange::MEMarketUpdate *market_update) noexcept -> void {
+      auto &features = ticker_features_.at(market_update->ticker_id_).values_;
+      (dispatchMarketUpdate<F>(features, market_update), ...);
+    }
+
+    // 处理订单簿变化
+    auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook* book) noexcept -> void {
+      auto &features = ticker_features_.at(ticker_id);
+      (dispatchOrderBookUpdate<F>(ticker_id, features.values_, book), ...);
+
+      logger_->log("%:% %() % ticker:% price:% side:% %\n", __FILE__, __LINE__, __FUNCTION__,
+                   Common::getCurrentLogTime(), ticker_id, Common::priceToString(price).c_str(),
+                   Common::sideToString(side).c_str(), features);
+    }
+
+    // 处理交易事件
+    auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook* book) noexcept -> void {
+      auto &features = ticker_features_.at(market_update->ticker_id_);
+      (dispatchTradeUpdate<F>(features.values_, market_update, book), ...);
+
+      logger_->log("%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), market_update, features);
+    }
+
+    // 获取指定股票的全部特征值
+    auto getFeatures(TickerId ticker_id) const noexcept -> const FeatureVector & {
+      return ticker_features_.at(ticker_id);
+    }
+
+    // 获取指定股票的单个特征值
+    template<typename T>
+    auto getFeature(TickerId ticker_id) const noexcept {
+      return ticker_features_.at(ticker_id).values_[Registry::template indexOf<T>()];
     }
 
     // 获取市场价格
-    auto getMktPrice() const noexcept {
-      return mkt_price_;
+    auto getMktPrice(TickerId ticker_id) const noexcept {
+      return getFeature<MktPriceFeature>(ticker_id);
     }
 
     // 获取激进交易数量比率
-    auto getAggTradeQtyRatio() const noexcept {
-      return agg_trade_qty_ratio_;
+    auto getAggTradeQtyRatio(TickerId ticker_id) const noexcept {
+      return getFeature<AggTradeQtyRatioFeature>(ticker_id);
+    }
+
+    // 获取多档订单簿数量不平衡度
+    auto getBookImbalance(TickerId ticker_id) const noexcept {
+      return getFeature<BookImbalanceFeature>(ticker_id);
     }
 
-    FeatureEngine() = delete;
-    FeatureEngine(const FeatureEngine &) = delete;
-    FeatureEngine(const FeatureEngine &&) = delete;
-    FeatureEngine &operator=(const FeatureEngine &) = delete;
-    FeatureEngine &operator=(const FeatureEngine &&) = delete;
+    BasicFeatureEngine() = delete;
+    BasicFeatureEngine(const BasicFeatureEngine &) = delete;
+    BasicFeatureEngine(const BasicFeatureEngine &&) = delete;
+    BasicFeatureEngine &operator=(const BasicFeatureEngine &) = delete;
+    BasicFeatureEngine &operator=(const BasicFeatureEngine &&) = delete;
 
   private:
-    std::string time_str_;
-    Common::Logger *logger_ = nullptr;
+    // 指定特征在指定股票上的中间状态
+    template<typename T>
+    auto state(TickerId ticker_id) noexcept -> typename T::State & {
+      return std::get<Registry::template indexOf<T>()>(ticker_state_).at(ticker_id);
+    }
+
+    // 以下分发函数在编译期跳过未实现对应回调的特征，运行期跳过未被订阅的特征
+    template<typename T, typename Values>
+    auto dispatchMarketUpdate(Values &features, const Exchange::MEMarketUpdate *market_update) noexcept {
+      if constexpr (requires(typename T::State &s, double &v) { T::onMarketUpdate(s, v, market_update, clock_); }) {
+        if (isSubscribed<T>())
+          T::onMarketUpdate(state<T>(market_update->ticker_id_), features[Registry::template indexOf<T>()], market_update, clock_);
+      }
+    }
+
+    template<typename T, typename Values>
+    auto dispatchOrderBookUpdate(TickerId ticker_id, Values &features, const MarketOrderBook *book) noexcept {
+      if constexpr (requires(typename T::State &s, double &v) { T::onOrderBookUpdate(s, v, book, clock_); }) {
+        if (isSubscribed<T>())
+          T::onOrderBookUpdate(state<T>(ticker_id), features[Registry::template indexOf<T>()], book, clock_);
+      }
+    }
+
+    template<typename T, typename Values>
+    auto dispatchTradeUpdate(Values &features, const Exchange::MEMarketUpdate *market_update, const MarketOrderBook *book) noexcept {
+      if constexpr (requires(typename T::State &s, double &v) { T::onTradeUpdate(s, v, market_update, book, clock_); }) {
+        if (isSubscribed<T>())
+          T::onTradeUpdate(state<T>(market_update->ticker_id_), features[Registry::template indexOf<T>()], market_update, book, clock_);
+      }
+    }
+
+    Common::BinLogger *logger_ = nullptr;
+
+    // 已被交易算法订阅的特征
+    FeatureMask subscribed_ = 0;
 
-    double mkt_price_ = Feature_INVALID, agg_trade_qty_ratio_ = Feature_INVALID;
+    FeatureClock clock_;
+
+    // 从股票代码到特征值的哈希映射
+    std::array<FeatureVector, ME_MAX_TICKERS> ticker_features_;
+
+    // 每个特征一个按股票代码索引的中间状态数组
+    std::tuple<std::array<typename F::State, ME_MAX_TICKERS>...> ticker_state_;
   };
+
+  typedef BasicFeatureEngine<Features> FeatureEngine;
 }
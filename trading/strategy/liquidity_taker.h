@@ -1,7 +1,7 @@
 #pragma once
 
 #include "common/macros.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
 
 #include "order_manager.h"
 #include "feature_engine.h"
@@ -9,31 +9,36 @@
 using namespace Common;
 
 namespace Trading {
+  class Strategy;
+
   class LiquidityTaker {
   public:
-    LiquidityTaker(Common::Logger *logger, TradeEngine *trade_engine, const FeatureEngine *feature_engine,
+    // 流动性获取算法从特征引擎订阅的特征
+    static constexpr FeatureMask FEATURES = featureMask<AggTradeQtyRatioFeature>();
+
+    LiquidityTaker(Common::BinLogger *logger, Strategy *strategy, const FeatureEngine *feature_engine,
                    OrderManager *order_manager,
                    const TradeEngineCfgHashMap &ticker_cfg);
 
     // 处理订单簿更新，对于流动性获取算法而言无实际操作
     auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *) noexcept -> void {
       logger_->log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
-                   Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
+                   Common::getCurrentLogTime(), ticker_id, Common::priceToString(price).c_str(),
                    Common::sideToString(side).c_str());
     }
 
     // 处理交易事件，从特征引擎获取激进交易比率，检查交易阈值并发送主动订单
     auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void {
-      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                   market_update->toString().c_str());
+      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                   market_update);
 
       const auto bbo = book->getBBO();
-      const auto agg_qty_ratio = feature_engine_->getAggTradeQtyRatio();
+      const auto agg_qty_ratio = feature_engine_->getAggTradeQtyRatio(market_update->ticker_id_);
 
       if (LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID && agg_qty_ratio != Feature_INVALID)) {
         logger_->log("%:% %() % % agg-qty-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
-                     Common::getCurrentTimeStr(&time_str_),
-                     bbo->toString().c_str(), agg_qty_ratio);
+                     Common::getCurrentLogTime(),
+                     bbo, agg_qty_ratio);
 
         const auto clip = ticker_cfg_.at(market_update->ticker_id_).clip_;
         const auto threshold = ticker_cfg_.at(market_update->ticker_id_).threshold_;
@@ -51,8 +56,8 @@ namespace Trading {
 
     // 处理策略订单的客户端响应
     auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                   client_response->toString().c_str());
+      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                   client_response);
       START_MEASURE(Trading_OrderManager_onOrderUpdate);
       order_manager_->onOrderUpdate(client_response);
       END_MEASURE(Trading_OrderManager_onOrderUpdate, (*logger_));
@@ -71,8 +76,7 @@ namespace Trading {
     // 流动性获取算法用于发送主动订单的订单管理器
     OrderManager *order_manager_ = nullptr;
 
-    std::string time_str_;
-    Common::Logger *logger_ = nullptr;
+    Common::BinLogger *logger_ = nullptr;
 
     // 存储流动性获取算法的交易配置
     const TradeEngineCfgHashMap ticker_cfg_;
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "common/macros.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
 
 #include "order_manager.h"
 #include "feature_engine.h"
@@ -9,25 +9,30 @@
 using namespace Common;
 
 namespace Trading {
+  class Strategy;
+
   class MarketMaker {
   public:
-    MarketMaker(Common::Logger *logger, TradeEngine *trade_engine, const FeatureEngine *feature_engine,
+    // 做市算法从特征引擎订阅的特征
+    static constexpr FeatureMask FEATURES = featureMask<MktPriceFeature>();
+
+    MarketMaker(Common::BinLogger *logger, Strategy *strategy, const FeatureEngine *feature_engine,
                 OrderManager *order_manager,
                 const TradeEngineCfgHashMap &ticker_cfg);
 
     // 处理订单簿更新，从特征引擎获取公允市场价格，检查交易阈值并修改被动订单
     auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, const MarketOrderBook *book) noexcept -> void {
       logger_->log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
-                   Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
+                   Common::getCurrentLogTime(), ticker_id, Common::priceToString(price).c_str(),
                    Common::sideToString(side).c_str());
 
       const auto bbo = book->getBBO();
-      const auto fair_price = feature_engine_->getMktPrice();
+      const auto fair_price = feature_engine_->getMktPrice(ticker_id);
 
       if (LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID && fair_price != Feature_INVALID)) {
         logger_->log("%:% %() % % fair-price:%\n", __FILE__, __LINE__, __FUNCTION__,
-                     Common::getCurrentTimeStr(&time_str_),
-                     bbo->toString().c_str(), fair_price);
+                     Common::getCurrentLogTime(),
+                     bbo, fair_price);
 
         const auto clip = ticker_cfg_.at(ticker_id).clip_;
         const auto threshold = ticker_cfg_.at(ticker_id).threshold_;
@@ -43,14 +48,14 @@ namespace Trading {
 
     // 处理交易事件，对于做市算法而言无实际操作
     auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook * /* book */) noexcept -> void {
-      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                   market_update->toString().c_str());
+      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                   market_update);
     }
 
     // 处理策略订单的客户端响应
     auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                   client_response->toString().c_str());
+      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                   client_response);
 
       START_MEASURE(Trading_OrderManager_onOrderUpdate);
       order_manager_->onOrderUpdate(client_response);
@@ -70,8 +75,7 @@ namespace Trading {
     // 做市算法用于管理其被动订单的订单管理器
     OrderManager *order_manager_ = nullptr;
 
-    std::string time_str_;
-    Common::Logger *logger_ = nullptr;
+    Common::BinLogger *logger_ = nullptr;
 
     // 存储做市算法的交易配置
     const TradeEngineCfgHashMap ticker_cfg_;
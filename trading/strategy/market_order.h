@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <sstream>
 #include "common/types.h"
@@ -19,6 +20,9 @@ namespace Trading {
     MarketOrder *prev_order_ = nullptr;  // 前一个订单指针
     MarketOrder *next_order_ = nullptr;  // 后一个订单指针
 
+    // toString() 经由指针读取相邻的订单，BinLogger 在记录日志的线程上转换为字符串而不是按值拷贝
+    static constexpr bool BIN_LOG_AS_STRING = true;
+
     // 仅用于内存池（MemPool）
     MarketOrder() = default;
 
@@ -39,10 +43,21 @@ namespace Trading {
 
     MarketOrder *first_mkt_order_ = nullptr;  // 该价格层级的首个订单（FIFO队列的头部）
 
+    // 该价格层级的总数量和订单数，随订单增删改以O(1)增量维护，读取时无需遍历订单链表
+    // L2快照的聚合剩余订单按其代表的 num_snapshot_orders_ 个订单计数
+    Qty total_qty_ = 0;
+    size_t num_orders_ = 0;
+
+    // L2快照中按档位聚合的订单数，这些订单合并为队首一个 order_id_ 为 OrderId_INVALID 的剩余订单
+    Priority num_snapshot_orders_ = 0;
+
     // MarketOrdersAtPrice同时作为价格层级双向链表的节点（按价格从最优到最差排序）
     MarketOrdersAtPrice *prev_entry_ = nullptr;  // 前一个价格层级指针
     MarketOrdersAtPrice *next_entry_ = nullptr;  // 后一个价格层级指针
 
+    // toString() 经由指针读取相邻的订单和价格层级，BinLogger 在记录日志的线程上转换为字符串而不是按值拷贝
+    static constexpr bool BIN_LOG_AS_STRING = true;
+
     // 仅用于内存池（MemPool）
     MarketOrdersAtPrice() = default;
 
@@ -55,6 +70,9 @@ namespace Trading {
          << "side:" << sideToString(side_) << " "
          << "price:" << priceToString(price_) << " "
          << "first_mkt_order:" << (first_mkt_order_ ? first_mkt_order_->toString() : "null") << " "
+         << "total_qty:" << qtyToString(total_qty_) << " "
+         << "num_orders:" << num_orders_ << " "
+         << "num_snapshot_orders:" << num_snapshot_orders_ << " "
          << "prev:" << priceToString(prev_entry_ ? prev_entry_->price_ : Price_INVALID) << " "
          << "next:" << priceToString(next_entry_ ? next_entry_->price_ : Price_INVALID) << "]";
 
@@ -81,4 +99,52 @@ namespace Trading {
       return ss.str();
     };
   };
-}
\ No newline at end of file
+
+  // 深度视图中每个方向维护的最优价格层级数
+  constexpr size_t MKT_DEPTH_LEVELS = 5;
+
+  // 单个方向前 MKT_DEPTH_LEVELS 档的价格、总数量和订单数，以结构数组（SoA）形式连续存放
+  // 下标0为最优档位，仅前 num_levels_ 个档位有效
+  struct MarketDepthSide {
+    std::array<Price, MKT_DEPTH_LEVELS> prices_;
+    std::array<Qty, MKT_DEPTH_LEVELS> qtys_;
+    std::array<uint32_t, MKT_DEPTH_LEVELS> num_orders_;
+    size_t num_levels_ = 0;
+
+    MarketDepthSide() {
+      prices_.fill(Price_INVALID);
+      qtys_.fill(0);
+      num_orders_.fill(0);
+    }
+
+    // 前 num_levels 档的总数量
+    auto totalQty(size_t num_levels = MKT_DEPTH_LEVELS) const noexcept {
+      Qty qty = 0;
+      for (size_t i = 0; i < std::min(num_levels, num_levels_); ++i)
+        qty += qtys_[i];
+      return qty;
+    }
+
+    auto toString() const {
+      std::stringstream ss;
+      for (size_t i = 0; i < num_levels_; ++i)
+        ss << qtyToString(qtys_[i]) << "@" << priceToString(prices_[i]) << "(" << num_orders_[i] << ") ";
+
+      return ss.str();
+    }
+  };
+
+  // 由订单簿增量维护的深度视图，供交易算法和特征引擎在不遍历价格层级链表的情况下读取多档行情
+  struct MarketDepth {
+    MarketDepthSide bids_, asks_;
+
+    auto toString() const {
+      std::stringstream ss;
+      ss << "MarketDepth{"
+         << "bids:[" << bids_.toString() << "] "
+         << "asks:[" << asks_.toString() << "]}";
+
+      return ss.str();
+    }
+  };
+}
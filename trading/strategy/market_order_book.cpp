@@ -3,105 +3,27 @@
 #include "trade_engine.h"
 
 namespace Trading {
-  MarketOrderBook::MarketOrderBook(TickerId ticker_id, Logger *logger)
+  MarketOrderBook::MarketOrderBook(TickerId ticker_id, BinLogger *logger)
       : ticker_id_(ticker_id), orders_at_price_pool_(ME_MAX_PRICE_LEVELS), order_pool_(ME_MAX_ORDER_IDS), logger_(logger) {
   }
 
   MarketOrderBook::~MarketOrderBook() {
     logger_->log("%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__,
-                 Common::getCurrentTimeStr(&time_str_), toString(false, true));
+                 Common::getCurrentLogTime(), toString(false, true));
 
     trade_engine_ = nullptr;
     bids_by_price_ = asks_by_price_ = nullptr;
     oid_to_order_.fill(nullptr);
   }
 
-  // 处理市场数据更新并更新限价订单簿
+  // 处理市场数据更新并更新限价订单簿，通过函数包装器通知交易引擎设置的交易算法
   auto MarketOrderBook::onMarketUpdate(const Exchange::MEMarketUpdate *market_update) noexcept -> void {
-    // 判断买卖盘最优报价是否更新
-    const auto bid_updated = (bids_by_price_ && market_update->side_ == Side::BUY && market_update->price_ >= bids_by_price_->price_);
-    const auto ask_updated = (asks_by_price_ && market_update->side_ == Side::SELL && market_update->price_ <= asks_by_price_->price_);
-
-    // 根据市场更新类型进行不同处理
-    switch (market_update->type_) {
-      case Exchange::MarketUpdateType::ADD: {
-        // 分配新订单并添加到订单簿
-        auto order = order_pool_.allocate(market_update->order_id_, market_update->side_, market_update->price_,
-                                          market_update->qty_, market_update->priority_, nullptr, nullptr);
-        START_MEASURE(Trading_MarketOrderBook_addOrder);
-        addOrder(order);
-        END_MEASURE(Trading_MarketOrderBook_addOrder, (*logger_));
-      }
-        break;
-      case Exchange::MarketUpdateType::MODIFY: {
-        // 修改现有订单的数量
-        auto order = oid_to_order_.at(market_update->order_id_);
-        order->qty_ = market_update->qty_;
-      }
-        break;
-      case Exchange::MarketUpdateType::CANCEL: {
-        // 从订单簿中移除订单
-        auto order = oid_to_order_.at(market_update->order_id_);
-        START_MEASURE(Trading_MarketOrderBook_removeOrder);
-        removeOrder(order);
-        END_MEASURE(Trading_MarketOrderBook_removeOrder, (*logger_));
-      }
-        break;
-      case Exchange::MarketUpdateType::TRADE: {
-        // 处理交易事件并通知交易引擎
-        trade_engine_->onTradeUpdate(market_update, this);
-        return;
-      }
-        break;
-      case Exchange::MarketUpdateType::CLEAR: { // 清空整个限价订单簿并释放相关对象
-        // 释放所有订单
-        for (auto &order: oid_to_order_) {
-          if (order)
-            order_pool_.deallocate(order);
-        }
-        oid_to_order_.fill(nullptr);
-
-        // 释放所有买单价格层级
-        if(bids_by_price_) {
-          for(auto bid = bids_by_price_->next_entry_; bid != bids_by_price_; bid = bid->next_entry_)
-            orders_at_price_pool_.deallocate(bid);
-          orders_at_price_pool_.deallocate(bids_by_price_);
-        }
-
-        // 释放所有卖单价格层级
-        if(asks_by_price_) {
-          for(auto ask = asks_by_price_->next_entry_; ask != asks_by_price_; ask = ask->next_entry_)
-            orders_at_price_pool_.deallocate(ask);
-          orders_at_price_pool_.deallocate(asks_by_price_);
-        }
-
-        bids_by_price_ = asks_by_price_ = nullptr;
-      }
-        break;
-      case Exchange::MarketUpdateType::INVALID:
-      case Exchange::MarketUpdateType::SNAPSHOT_START:
-      case Exchange::MarketUpdateType::SNAPSHOT_END:
-        // 不处理无效更新和快照开始/结束事件
-        break;
-    }
-
-    // 更新最优买卖报价
-    START_MEASURE(Trading_MarketOrderBook_updateBBO);
-    updateBBO(bid_updated, ask_updated);
-    END_MEASURE(Trading_MarketOrderBook_updateBBO, (*logger_));
-
-    // 记录订单簿更新日志
-    logger_->log("%:% %() % % %", __FILE__, __LINE__, __FUNCTION__,
-                 Common::getCurrentTimeStr(&time_str_), market_update->toString(), bbo_.toString());
-
-    // 通知交易引擎订单簿已更新
-    trade_engine_->onOrderBookUpdate(market_update->ticker_id_, market_update->price_, market_update->side_, this);
+    onMarketUpdate(market_update, trade_engine_);
   }
 
   // 将订单簿信息转换为字符串（支持详细模式和有效性检查）
   auto MarketOrderBook::toString(bool detailed, bool validity_check) const -> std::string {
     std::stringstream ss;
-    std::string time_str;
 
     // 用于打印价格层级及其包含订单的 lambda 函数
     auto printer = [&](std::stringstream &ss, MarketOrdersAtPrice *itr, Side side, Price &last_price,
@@ -138,8 +60,14 @@ namespace Trading {
 
       ss << std::endl;
 
-      // 有效性检查：确保买卖盘价格排序正确
+      // 有效性检查：确保增量维护的总数量和订单数与遍历结果一致，且买卖盘价格排序正确
       if (sanity_check) {
+        const auto expected_num_orders = num_orders + (itr->num_snapshot_orders_ ? itr->num_snapshot_orders_ - 1 : 0);
+        if (qty != itr->total_qty_ || expected_num_orders != itr->num_orders_) {
+          FATAL("Level aggregates out of sync qty:" + qtyToString(qty) + " orders:" + std::to_string(expected_num_orders) + " itr:" +
+                itr->toString());
+        }
+
         if ((side == Side::SELL && last_price >= itr->price_) || (side == Side::BUY && last_price <= itr->price_)) {
           FATAL("Bids/Asks not sorted by ascending/descending prices last:" + priceToString(last_price) + " itr:" +
                 itr->toString());
@@ -176,6 +104,24 @@ namespace Trading {
       }
     }
 
+    // 有效性检查：确保深度视图与价格层级链表的前 MKT_DEPTH_LEVELS 档一致
+    if (validity_check) {
+      for (auto side : {Side::BUY, Side::SELL}) {
+        const auto &depth_side = (side == Side::BUY ? depth_.bids_ : depth_.asks_);
+        const auto best_orders_by_price = (side == Side::BUY ? bids_by_price_ : asks_by_price_);
+        size_t num_levels = 0;
+        for (auto itr = best_orders_by_price; itr && num_levels < MKT_DEPTH_LEVELS; ++num_levels) {
+          if (depth_side.prices_[num_levels] != itr->price_ || depth_side.qtys_[num_levels] != itr->total_qty_ ||
+              depth_side.num_orders_[num_levels] != itr->num_orders_) {
+            FATAL("Depth out of sync level:" + std::to_string(num_levels) + " depth:" + depth_.toString() + " itr:" + itr->toString());
+          }
+          itr = (itr->next_entry_ == best_orders_by_price ? nullptr : itr->next_entry_);
+        }
+        if (num_levels != depth_side.num_levels_)
+          FATAL("Depth out of sync num_levels:" + std::to_string(num_levels) + " depth:" + depth_.toString());
+      }
+    }
+
     return ss.str();
   }
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
+
 #include "common/types.h"
 #include "common/mem_pool.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
 
 #include "market_order.h"
 #include "exchange/market_data/market_update.h"
@@ -13,26 +15,153 @@ namespace Trading {
   // 市场订单簿类，用于维护和管理特定股票的限价订单
   class MarketOrderBook final {
   public:
-    MarketOrderBook(TickerId ticker_id, Logger *logger);
+    MarketOrderBook(TickerId ticker_id, BinLogger *logger);
     ~MarketOrderBook();
 
-    // 处理市场数据更新并更新限价订单簿
+    // 处理市场数据更新并更新限价订单簿，通过函数包装器通知交易引擎设置的交易算法
     auto onMarketUpdate(const Exchange::MEMarketUpdate *market_update) noexcept -> void;
 
+    // 处理市场数据更新并更新限价订单簿，订单簿变化和交易事件通知到 listener
+    // listener 需提供 onOrderBookUpdate(ticker_id, price, side, book) 和 onTradeUpdate(market_update, book)，
+    // 在编译期确定其类型，交易引擎可将回调静态分发到具体的交易算法
+    template<typename Listener>
+    auto onMarketUpdate(const Exchange::MEMarketUpdate *market_update, Listener *listener) noexcept -> void {
+      // 判断买卖盘最优报价是否更新（该方向为空时的新订单也会成为最优报价）
+      const auto bid_updated = (market_update->side_ == Side::BUY && (!bids_by_price_ || market_update->price_ >= bids_by_price_->price_));
+      const auto ask_updated = (market_update->side_ == Side::SELL && (!asks_by_price_ || market_update->price_ <= asks_by_price_->price_));
+
+      // 根据市场更新类型进行不同处理
+      switch (market_update->type_) {
+        case Exchange::MarketUpdateType::ADD: {
+          // 分配新订单并添加到订单簿
+          auto order = order_pool_.allocate(market_update->order_id_, market_update->side_, market_update->price_,
+                                            market_update->qty_, market_update->priority_, nullptr, nullptr);
+          START_MEASURE(Trading_MarketOrderBook_addOrder);
+          addOrder(order);
+          END_MEASURE(Trading_MarketOrderBook_addOrder, (*logger_));
+        }
+          break;
+        case Exchange::MarketUpdateType::MODIFY: {
+          // 修改现有订单的数量
+          // 未知订单来自L2快照的聚合档位，其成交数量已在 TRADE 时从剩余订单中扣除
+          auto order = oid_to_order_.at(market_update->order_id_);
+          if (LIKELY(order)) {
+            getOrdersAtPrice(order->price_)->total_qty_ += market_update->qty_ - order->qty_;
+            order->qty_ = market_update->qty_;
+          }
+        }
+          break;
+        case Exchange::MarketUpdateType::CANCEL: {
+          // 从订单簿中移除订单
+          auto order = oid_to_order_.at(market_update->order_id_);
+          if (UNLIKELY(!order)) {
+            // 未知订单来自L2快照的聚合档位，从剩余订单中扣除其剩余数量
+            removeSnapshotOrder(market_update->price_, market_update->qty_);
+            break;
+          }
+          START_MEASURE(Trading_MarketOrderBook_removeOrder);
+          removeOrder(order);
+          END_MEASURE(Trading_MarketOrderBook_removeOrder, (*logger_));
+        }
+          break;
+        case Exchange::MarketUpdateType::LEVEL: {
+          // L2快照档位：以 order_id_ 为 OrderId_INVALID 的单个剩余订单表示该档位的全部数量
+          auto order = order_pool_.allocate(OrderId_INVALID, market_update->side_, market_update->price_,
+                                            market_update->qty_, Priority_INVALID, nullptr, nullptr);
+          addOrder(order);
+          auto orders_at_price = getOrdersAtPrice(market_update->price_);
+          orders_at_price->num_snapshot_orders_ = market_update->priority_;
+          orders_at_price->num_orders_ += market_update->priority_ - 1;  // 剩余订单代表该档位的全部订单
+        }
+          break;
+        case Exchange::MarketUpdateType::TRADE: {
+          // 按FIFO顺序，被动方档位的成交优先消耗L2快照的聚合剩余订单
+          const auto passive_orders_at_price = getOrdersAtPrice(market_update->price_);
+          if (UNLIKELY(passive_orders_at_price && passive_orders_at_price->price_ == market_update->price_ &&
+                       passive_orders_at_price->num_snapshot_orders_ &&
+                       passive_orders_at_price->side_ != market_update->side_)) {
+            auto residual = passive_orders_at_price->first_mkt_order_;
+            const auto traded_qty = std::min(residual->qty_, market_update->qty_);
+            residual->qty_ -= traded_qty;
+            passive_orders_at_price->total_qty_ -= traded_qty;
+
+            // 剩余订单的数量变化不会有后续的 MODIFY，需在此刷新BBO和深度视图
+            const auto passive_side = passive_orders_at_price->side_;
+            updateBBO(passive_side == Side::BUY && passive_orders_at_price == bids_by_price_,
+                      passive_side == Side::SELL && passive_orders_at_price == asks_by_price_);
+            updateDepth(passive_side, market_update->price_);
+          }
+
+          // 处理交易事件并通知监听者
+          listener->onTradeUpdate(market_update, this);
+          return;
+        }
+          break;
+        case Exchange::MarketUpdateType::CLEAR: { // 清空整个限价订单簿并释放相关对象
+          // 释放所有价格层级及其订单（包括不在订单ID映射中的L2快照剩余订单）
+          for (auto best_orders_by_price : {bids_by_price_, asks_by_price_}) {
+            if (!best_orders_by_price)
+              continue;
+            auto orders_at_price = best_orders_by_price;
+            do {
+              const auto next_orders_at_price = orders_at_price->next_entry_;
+              auto order = orders_at_price->first_mkt_order_;
+              do {
+                const auto next_order = order->next_order_;
+                order_pool_.deallocate(order);
+                order = next_order;
+              } while (order != orders_at_price->first_mkt_order_);
+              orders_at_price_pool_.deallocate(orders_at_price);
+              orders_at_price = next_orders_at_price;
+            } while (orders_at_price != best_orders_by_price);
+          }
+
+          oid_to_order_.fill(nullptr);
+          price_orders_at_price_.fill(nullptr);
+          bids_by_price_ = asks_by_price_ = nullptr;
+          bbo_ = BBO();
+          depth_ = MarketDepth();
+        }
+          break;
+        case Exchange::MarketUpdateType::INVALID:
+        case Exchange::MarketUpdateType::SNAPSHOT_START:
+        case Exchange::MarketUpdateType::SNAPSHOT_END:
+          // 不处理无效更新和快照开始/结束事件
+          break;
+      }
+
+      // 更新最优买卖报价
+      START_MEASURE(Trading_MarketOrderBook_updateBBO);
+      updateBBO(bid_updated, ask_updated);
+      END_MEASURE(Trading_MarketOrderBook_updateBBO, (*logger_));
+
+      // 更新深度视图（CLEAR 和快照开始/结束事件不带买卖方向）
+      if (market_update->side_ == Side::BUY || market_update->side_ == Side::SELL) {
+        START_MEASURE(Trading_MarketOrderBook_updateDepth);
+        updateDepth(market_update->side_, market_update->price_);
+        END_MEASURE(Trading_MarketOrderBook_updateDepth, (*logger_));
+      }
+
+      // 记录订单簿更新日志
+      logger_->log("%:% %() % % %", __FILE__, __LINE__, __FUNCTION__,
+                   Common::getCurrentLogTime(), market_update, bbo_);
+
+      // 通知监听者订单簿已更新
+      listener->onOrderBookUpdate(market_update->ticker_id_, market_update->price_, market_update->side_, this);
+    }
+
     // 设置交易引擎（父对象）
     auto setTradeEngine(TradeEngine *trade_engine) {
       trade_engine_ = trade_engine;
     }
 
     // 更新最优买卖报价（BBO），两个布尔参数分别表示买卖双方是否需要更新
+    // 直接读取最优价格层级维护的总数量，无需遍历该层级的订单链表
     auto updateBBO(bool update_bid, bool update_ask) noexcept {
       if(update_bid) {
         if(bids_by_price_) {
           bbo_.bid_price_ = bids_by_price_->price_;
-          bbo_.bid_qty_ = bids_by_price_->first_mkt_order_->qty_;
-          // 累加该价格层级的所有订单数量
-          for(auto order = bids_by_price_->first_mkt_order_->next_order_; order != bids_by_price_->first_mkt_order_; order = order->next_order_)
-            bbo_.bid_qty_ += order->qty_;
+          bbo_.bid_qty_ = bids_by_price_->total_qty_;
         }
         else {
           bbo_.bid_price_ = Price_INVALID;
@@ -43,10 +172,7 @@ namespace Trading {
       if(update_ask) {
         if(asks_by_price_) {
           bbo_.ask_price_ = asks_by_price_->price_;
-          bbo_.ask_qty_ = asks_by_price_->first_mkt_order_->qty_;
-          // 累加该价格层级的所有订单数量
-          for(auto order = asks_by_price_->first_mkt_order_->next_order_; order != asks_by_price_->first_mkt_order_; order = order->next_order_)
-            bbo_.ask_qty_ += order->qty_;
+          bbo_.ask_qty_ = asks_by_price_->total_qty_;
         }
         else {
           bbo_.ask_price_ = Price_INVALID;
@@ -60,6 +186,48 @@ namespace Trading {
       return &bbo_;
     }
 
+    // 更新深度视图中指定方向的前 MKT_DEPTH_LEVELS 档，变化不在前N档内时直接返回
+    // 已在视图中的档位只更新数量和订单数，档位新增或移除时从最优价格层级起重建该方向（最多N次指针跳转）
+    auto updateDepth(Side side, Price price) noexcept {
+      auto &depth_side = (side == Side::BUY ? depth_.bids_ : depth_.asks_);
+      if (depth_side.num_levels_ == MKT_DEPTH_LEVELS &&
+          (side == Side::BUY ? price < depth_side.prices_.back() : price > depth_side.prices_.back()))
+        return;
+
+      const auto orders_at_price = getOrdersAtPrice(price);
+      const auto level_exists = (orders_at_price && orders_at_price->price_ == price);
+      for (size_t i = 0; i < depth_side.num_levels_; ++i) {
+        if (depth_side.prices_[i] == price) {
+          if (LIKELY(level_exists)) {
+            depth_side.qtys_[i] = orders_at_price->total_qty_;
+            depth_side.num_orders_[i] = orders_at_price->num_orders_;
+            return;
+          }
+          break;
+        }
+      }
+
+      const auto best_orders_by_price = (side == Side::BUY ? bids_by_price_ : asks_by_price_);
+      depth_side.num_levels_ = 0;
+      for (auto itr = best_orders_by_price; itr && depth_side.num_levels_ < MKT_DEPTH_LEVELS; ) {
+        depth_side.prices_[depth_side.num_levels_] = itr->price_;
+        depth_side.qtys_[depth_side.num_levels_] = itr->total_qty_;
+        depth_side.num_orders_[depth_side.num_levels_] = itr->num_orders_;
+        ++depth_side.num_levels_;
+        itr = (itr->next_entry_ == best_orders_by_price ? nullptr : itr->next_entry_);
+      }
+      for (size_t i = depth_side.num_levels_; i < MKT_DEPTH_LEVELS; ++i) {
+        depth_side.prices_[i] = Price_INVALID;
+        depth_side.qtys_[i] = 0;
+        depth_side.num_orders_[i] = 0;
+      }
+    }
+
+    // 获取买卖双方前 MKT_DEPTH_LEVELS 档的深度视图
+    auto getDepth() const noexcept -> const MarketDepth* {
+      return &depth_;
+    }
+
     // 将订单簿信息转换为字符串（支持详细模式和有效性检查）
     auto toString(bool detailed, bool validity_check) const -> std::string;
 
@@ -96,9 +264,9 @@ namespace Trading {
     MemPool<MarketOrder> order_pool_;
 
     BBO bbo_;  // 最优买卖报价
+    MarketDepth depth_;  // 买卖双方前 MKT_DEPTH_LEVELS 档的深度视图
 
-    std::string time_str_;
-    Logger *logger_ = nullptr;  // 日志器
+    BinLogger *logger_ = nullptr;  // 日志器
 
   private:
     // 将价格转换为索引（用于哈希映射）
@@ -207,13 +375,36 @@ namespace Trading {
         }
 
         order->prev_order_ = order->next_order_ = nullptr;
+
+        // 从价格层级的总数量和订单数中扣除该订单
+        orders_at_price->total_qty_ -= order->qty_;
+        --orders_at_price->num_orders_;
       }
 
-      // 从订单ID映射中移除并释放订单
-      oid_to_order_.at(order->order_id_) = nullptr;
+      // 从订单ID映射中移除并释放订单（L2快照的聚合剩余订单不在映射中）
+      if (LIKELY(order->order_id_ != OrderId_INVALID))
+        oid_to_order_.at(order->order_id_) = nullptr;
       order_pool_.deallocate(order);
     }
 
+    // 从L2快照的聚合剩余订单中移除一个订单，qty 为该订单被移除时的剩余数量
+    auto removeSnapshotOrder(Price price, Qty qty) noexcept -> void {
+      const auto orders_at_price = getOrdersAtPrice(price);
+      if (UNLIKELY(!orders_at_price || !orders_at_price->num_snapshot_orders_))
+        return;
+
+      auto residual = orders_at_price->first_mkt_order_;
+      const auto removed_qty = std::min(residual->qty_, qty);
+      residual->qty_ -= removed_qty;
+      orders_at_price->total_qty_ -= removed_qty;
+
+      // 移除最后一个聚合订单时连同剩余订单一起移除，由 removeOrder() 扣除其计数
+      if (!--orders_at_price->num_snapshot_orders_)
+        removeOrder(residual);
+      else
+        --orders_at_price->num_orders_;
+    }
+
     // 在订单所属的价格层级的FIFO队列末尾添加单个订单
     auto addOrder(MarketOrder *order) noexcept -> void {
       const auto orders_at_price = getOrdersAtPrice(order->price_);
@@ -222,6 +413,8 @@ namespace Trading {
         // 该价格层级不存在，创建新的价格层级
         order->next_order_ = order->prev_order_ = order;
         auto new_orders_at_price = orders_at_price_pool_.allocate(order->side_, order->price_, order, nullptr, nullptr);
+        new_orders_at_price->total_qty_ = order->qty_;
+        new_orders_at_price->num_orders_ = 1;
         addOrdersAtPrice(new_orders_at_price);
       } else {
         // 该价格层级已存在，添加到队列末尾
@@ -231,10 +424,14 @@ namespace Trading {
         order->prev_order_ = first_order->prev_order_;
         order->next_order_ = first_order;
         first_order->prev_order_ = order;
+
+        orders_at_price->total_qty_ += order->qty_;
+        ++orders_at_price->num_orders_;
       }
 
-      // 将订单添加到订单ID映射中
-      oid_to_order_.at(order->order_id_) = order;
+      // 将订单添加到订单ID映射中（L2快照的聚合剩余订单不在映射中）
+      if (LIKELY(order->order_id_ != OrderId_INVALID))
+        oid_to_order_.at(order->order_id_) = order;
     }
   };
 
@@ -42,6 +42,17 @@ namespace Trading {
     Qty qty_ = Qty_INVALID;                  // 订单数量
     OMOrderState order_state_ = OMOrderState::INVALID;  // 订单状态
 
+    // 同一股票同一方向上的订单按发送顺序组成双向循环链表
+    OMOrder *prev_order_ = nullptr;
+    OMOrder *next_order_ = nullptr;
+
+    OMOrder() = default;
+
+    OMOrder(TickerId ticker_id, OrderId order_id, Side side, Price price, Qty qty, OMOrderState order_state,
+            OMOrder *prev_order, OMOrder *next_order) noexcept
+        : ticker_id_(ticker_id), order_id_(order_id), side_(side), price_(price), qty_(qty), order_state_(order_state),
+          prev_order_(prev_order), next_order_(next_order) {}
+
     auto toString() const {
       std::stringstream ss;
       ss << "OMOrder" << "["
@@ -56,9 +67,15 @@ namespace Trading {
     }
   };
 
-  // 从买卖方向（Side）到OMOrder的哈希映射
-  typedef std::array<OMOrder, sideToIndex(Side::MAX) + 1> OMOrderSideHashMap;
+  // 每个订单管理器同时管理的最大订单数（含待新建、活跃和待取消的订单）
+  constexpr size_t OM_MAX_ORDERS = 1024;
+
+  // 从订单ID到OMOrder的哈希映射，订单ID按策略实例的订单ID分区大小取模
+  typedef std::array<OMOrder *, TE_STRATEGY_ORDER_IDS> OMOrderHashMap;
+
+  // 从买卖方向（Side）到该方向订单链表中第一个OMOrder的哈希映射
+  typedef std::array<OMOrder *, sideToIndex(Side::MAX) + 1> OMOrderSideHashMap;
 
-  // 从股票代码（TickerId）到买卖方向（Side）再到OMOrder的哈希映射
+  // 从股票代码（TickerId）到买卖方向（Side）再到OMOrder链表的哈希映射
   typedef std::array<OMOrderSideHashMap, ME_MAX_TICKERS> OMOrderTickerSideHashMap;
 }
\ No newline at end of file
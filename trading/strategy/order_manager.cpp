@@ -2,22 +2,43 @@
 #include "trade_engine.h"
 
 namespace Trading {
-  // 发送具有指定属性的新订单，并更新传入的OMOrder对象
-  auto OrderManager::newOrder(OMOrder *order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> void {
+  // 发送具有指定属性的新订单，返回从内存池分配并加入订单链表的OMOrder对象
+  auto OrderManager::newOrder(TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> OMOrder * {
+    // 跳过仍被未终止订单使用的订单ID
+    while (UNLIKELY(order_id_to_order_.at(next_order_id_ % TE_STRATEGY_ORDER_IDS) != nullptr))
+      advanceOrderId();
+
     // 构造新订单请求
     const Exchange::MEClientRequest new_request{Exchange::ClientRequestType::NEW, trade_engine_->clientId(), ticker_id,
                                                 next_order_id_, side, price, qty};
     // 通过交易引擎发送客户端请求
     trade_engine_->sendClientRequest(&new_request);
 
-    // 更新订单对象信息（设置股票代码、订单ID、方向、价格、数量及待新建状态）
-    *order = {ticker_id, next_order_id_, side, price, qty, OMOrderState::PENDING_NEW};
+    // 分配订单对象（设置股票代码、订单ID、方向、价格、数量及待新建状态），加入该方向订单链表的末尾
+    auto &first_order = ticker_side_order_.at(ticker_id).at(sideToIndex(side));
+    auto order = order_pool_.allocate(ticker_id, next_order_id_, side, price, qty, OMOrderState::PENDING_NEW,
+                                      (first_order ? first_order->prev_order_ : nullptr), first_order);
+    if (first_order) {
+      first_order->prev_order_->next_order_ = order;
+      first_order->prev_order_ = order;
+    } else {
+      order->prev_order_ = order->next_order_ = order;
+      first_order = order;
+    }
+
+    order_id_to_order_.at(next_order_id_ % TE_STRATEGY_ORDER_IDS) = order;
+
+    // 新订单在成交或终止之前计入风险管理器的在途敞口
+    risk_manager_.addWorkingQty(ticker_id, side, price, qty);
+
     // 递增下一个订单ID（用于下一次新订单）
-    ++next_order_id_;
+    advanceOrderId();
 
     logger_->log("%:% %() % Sent new order % for %\n", __FILE__, __LINE__, __FUNCTION__,
-                 Common::getCurrentTimeStr(&time_str_),
-                 new_request.toString().c_str(), order->toString().c_str());
+                 Common::getCurrentLogTime(),
+                 new_request, order);
+
+    return order;
   }
 
   // 发送指定订单的取消请求，并更新传入的OMOrder对象
@@ -33,7 +54,7 @@ namespace Trading {
     order->order_state_ = OMOrderState::PENDING_CANCEL;
 
     logger_->log("%:% %() % Sent cancel % for %\n", __FILE__, __LINE__, __FUNCTION__,
-                 Common::getCurrentTimeStr(&time_str_),
-                 cancel_request.toString().c_str(), order->toString().c_str());
+                 Common::getCurrentLogTime(),
+                 cancel_request, order);
   }
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
+
 #include "common/macros.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
+#include "common/mem_pool.h"
 
 #include "exchange/order_server/client_response.h"
 
@@ -14,20 +17,32 @@ namespace Trading {
   class TradeEngine;
 
   // 为交易算法管理订单，隐藏订单管理的复杂性以简化交易策略
+  // 每个股票每个方向可以同时有多个不同价格的订单，支持多档报价
   class OrderManager {
   public:
-    OrderManager(Common::Logger *logger, TradeEngine *trade_engine, RiskManager& risk_manager)
-        : trade_engine_(trade_engine), risk_manager_(risk_manager), logger_(logger) {
+    // first_order_id 为该订单管理器所属策略实例的订单ID分区的起始值
+    OrderManager(Common::BinLogger *logger, TradeEngine *trade_engine, RiskManager& risk_manager, OrderId first_order_id = 1)
+        : trade_engine_(trade_engine), risk_manager_(risk_manager), logger_(logger), order_pool_(OM_MAX_ORDERS),
+          first_order_id_(first_order_id), end_order_id_((first_order_id / TE_STRATEGY_ORDER_IDS + 1) * TE_STRATEGY_ORDER_IDS),
+          next_order_id_(first_order_id) {
+      for (auto &side_orders: ticker_side_order_)
+        side_orders.fill(nullptr);
+      order_id_to_order_.fill(nullptr);
     }
 
-    // 处理来自客户端响应的订单更新，并更新所管理订单的状态
+    // 处理来自客户端响应的订单更新，并更新所管理订单的状态，已终止的订单被移除并归还内存池
     auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                   client_response->toString().c_str());
-      // 获取对应的订单对象
-      auto order = &(ticker_side_order_.at(client_response->ticker_id_).at(sideToIndex(client_response->side_)));
-      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                   order->toString().c_str());
+      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                   client_response);
+      // 按订单ID获取对应的订单对象
+      auto order = order_id_to_order_.at(client_response->client_order_id_ % TE_STRATEGY_ORDER_IDS);
+      if (UNLIKELY(!order || order->order_id_ != client_response->client_order_id_)) {
+        logger_->log("%:% %() % Unknown order:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                     orderIdToString(client_response->client_order_id_));
+        return;
+      }
+      logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                   order);
 
       // 根据响应类型更新订单状态
       switch (client_response->type_) {
@@ -36,93 +51,108 @@ namespace Trading {
         }
           break;
         case Exchange::ClientResponseType::CANCELED: {
-          order->order_state_ = OMOrderState::DEAD;  // 订单已被取消，状态变为终止
+          removeOrder(order);  // 订单已被取消，状态变为终止
         }
           break;
         case Exchange::ClientResponseType::FILLED: {
+          // 成交部分不再是在途敞口，其持仓名义金额由风险管理器在成交时更新
+          risk_manager_.removeWorkingQty(order->ticker_id_, order->side_, order->price_, order->qty_ - client_response->leaves_qty_);
           order->qty_ = client_response->leaves_qty_;  // 更新剩余数量
           if(!order->qty_)  // 若剩余数量为0，订单状态变为终止
-            order->order_state_ = OMOrderState::DEAD;
+            removeOrder(order);
+        }
+          break;
+        case Exchange::ClientResponseType::CANCEL_REJECTED: {
+          // 交易所中已没有该订单（其成交回报先于取消拒绝到达），订单状态变为终止
+          removeOrder(order);
         }
           break;
-        case Exchange::ClientResponseType::CANCEL_REJECTED:
         case Exchange::ClientResponseType::INVALID: {
-          // 取消被拒绝或无效响应，不更新状态
+          // 无效响应，不更新状态
         }
           break;
       }
     }
 
-    // 发送具有指定属性的新订单，并更新传入的OMOrder对象
-    auto newOrder(OMOrder *order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> void;
+    // 发送具有指定属性的新订单，返回从内存池分配并加入订单链表的OMOrder对象
+    auto newOrder(TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> OMOrder *;
 
     // 发送指定订单的取消请求，并更新传入的OMOrder对象
     auto cancelOrder(OMOrder *order) noexcept -> void;
 
-    // 调整指定方向的单个订单，使其具有指定的价格和数量
-    // 发送订单前会执行风险检查，并更新传入的OMOrder对象
-    auto moveOrder(OMOrder *order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept {
-      switch (order->order_state_) {
-        case OMOrderState::LIVE: {
-          // 若订单处于活跃状态且价格发生变化，则取消当前订单
-          if(order->price_ != price) {
-            START_MEASURE(Trading_OrderManager_cancelOrder);
-            cancelOrder(order);
-            END_MEASURE(Trading_OrderManager_cancelOrder, (*logger_));
-          }
-        }
-          break;
-        case OMOrderState::INVALID:
-        case OMOrderState::DEAD: {
-          // 若订单无效或已终止，且价格有效，则尝试新建订单
-          if(LIKELY(price != Price_INVALID)) {
-            START_MEASURE(Trading_RiskManager_checkPreTradeRisk);
-            const auto risk_result = risk_manager_.checkPreTradeRisk(ticker_id, side, qty);
-            END_MEASURE(Trading_RiskManager_checkPreTradeRisk, (*logger_));
-            if(LIKELY(risk_result == RiskCheckResult::ALLOWED)) {
-              // 风险检查通过，发送新订单
-              START_MEASURE(Trading_OrderManager_newOrder);
-              newOrder(order, ticker_id, price, side, qty);
-              END_MEASURE(Trading_OrderManager_newOrder, (*logger_));
-            } else
-              // 风险检查未通过，记录日志
-              logger_->log("%:% %() % Ticker:% Side:% Qty:% RiskCheckResult:%\n", __FILE__, __LINE__, __FUNCTION__,
-                           Common::getCurrentTimeStr(&time_str_),
-                           tickerIdToString(ticker_id), sideToString(side), qtyToString(qty),
-                           riskCheckResultToString(risk_result));
-          }
+    // 获取指定股票指定方向上价格为 price 的待新建或活跃订单，不存在时返回 nullptr
+    auto getWorkingOrder(TickerId ticker_id, Side side, Price price) const noexcept -> OMOrder * {
+      const auto first_order = ticker_side_order_.at(ticker_id).at(sideToIndex(side));
+      auto order = first_order;
+      while (order) {
+        if (order->price_ == price &&
+            (order->order_state_ == OMOrderState::PENDING_NEW || order->order_state_ == OMOrderState::LIVE))
+          return order;
+        order = (order->next_order_ == first_order ? nullptr : order->next_order_);
+      }
+      return nullptr;
+    }
+
+    // 调整指定方向的订单，使该方向在 prices 中的每个价格上各有一个数量为 clip 的订单
+    // 先对缺少订单的价格执行风险检查并发送新订单，再取消价格不在 prices 中的活跃订单，
+    // 因此报价移动时新订单无需等待旧订单的取消确认，市场中不会出现没有报价的空档
+    // 价格为 Price_INVALID 的项被忽略，prices 为空表示该方向不需要订单，clip 为0时不发送新订单
+    auto moveOrders(TickerId ticker_id, Side side, const Price *prices, size_t num_prices, Qty clip) noexcept {
+      for (size_t i = 0; i < num_prices; ++i) {
+        const auto price = prices[i];
+        if (UNLIKELY(price == Price_INVALID || !clip) || getWorkingOrder(ticker_id, side, price))
+          continue;
+
+        START_MEASURE(Trading_RiskManager_checkPreTradeRisk);
+        const auto risk_result = risk_manager_.checkPreTradeRisk(ticker_id, side, price, clip);
+        END_MEASURE(Trading_RiskManager_checkPreTradeRisk, (*logger_));
+        if(LIKELY(risk_result == RiskCheckResult::ALLOWED)) {
+          // 风险检查通过，发送新订单
+          START_MEASURE(Trading_OrderManager_newOrder);
+          newOrder(ticker_id, price, side, clip);
+          END_MEASURE(Trading_OrderManager_newOrder, (*logger_));
+        } else
+          // 风险检查未通过，记录日志
+          logger_->log("%:% %() % Ticker:% Side:% Qty:% RiskCheckResult:%\n", __FILE__, __LINE__, __FUNCTION__,
+                       Common::getCurrentLogTime(),
+                       tickerIdToString(ticker_id), sideToString(side), qtyToString(clip),
+                       riskCheckResultToString(risk_result));
+      }
+
+      // 取消价格不再需要的活跃订单，待新建的订单在被接受后再取消
+      const auto first_order = ticker_side_order_.at(ticker_id).at(sideToIndex(side));
+      auto order = first_order;
+      while (order) {
+        if (order->order_state_ == OMOrderState::LIVE && std::find(prices, prices + num_prices, order->price_) == prices + num_prices) {
+          START_MEASURE(Trading_OrderManager_cancelOrder);
+          cancelOrder(order);
+          END_MEASURE(Trading_OrderManager_cancelOrder, (*logger_));
         }
-          break;
-        case OMOrderState::PENDING_NEW:
-        case OMOrderState::PENDING_CANCEL:
-          // 订单处于待新建或待取消状态，不执行操作
-          break;
+        order = (order->next_order_ == first_order ? nullptr : order->next_order_);
       }
     }
 
-    // 按指定的买卖价格放置指定数量(clip)的订单
-    // 若当前无订单，可能会发送新订单
-    // 若现有订单价格或数量不符，可能会取消现有订单
+    // 按指定的买卖价格放置指定数量(clip)的订单，每个方向一个价格
+    // 若当前无该价格的订单，可能会发送新订单
+    // 若现有订单价格不符，可能会取消现有订单
     // 若买卖价格指定为Price_INVALID，表示该方向不需要订单
     auto moveOrders(TickerId ticker_id, Price bid_price, Price ask_price, Qty clip) noexcept {
       {
         // 处理买单
-        auto bid_order = &(ticker_side_order_.at(ticker_id).at(sideToIndex(Side::BUY)));
         START_MEASURE(Trading_OrderManager_moveOrder);
-        moveOrder(bid_order, ticker_id, bid_price, Side::BUY, clip);
+        moveOrders(ticker_id, Side::BUY, &bid_price, (bid_price != Price_INVALID), clip);
         END_MEASURE(Trading_OrderManager_moveOrder, (*logger_));
       }
 
       {
         // 处理卖单
-        auto ask_order = &(ticker_side_order_.at(ticker_id).at(sideToIndex(Side::SELL)));
         START_MEASURE(Trading_OrderManager_moveOrder);
-        moveOrder(ask_order, ticker_id, ask_price, Side::SELL, clip);
+        moveOrders(ticker_id, Side::SELL, &ask_price, (ask_price != Price_INVALID), clip);
         END_MEASURE(Trading_OrderManager_moveOrder, (*logger_));
       }
     }
 
-    // 辅助方法：获取指定股票代码的买卖方向OMOrder哈希映射
+    // 辅助方法：获取指定股票代码的买卖方向OMOrder链表哈希映射
     auto getOMOrderSideHashMap(TickerId ticker_id) const {
       return &(ticker_side_order_.at(ticker_id));
     }
@@ -134,19 +164,53 @@ namespace Trading {
     OrderManager &operator=(const OrderManager &&) = delete;
 
   private:
+    // 递增下一个订单ID，到达分区末尾后从分区起始值重新开始
+    auto advanceOrderId() noexcept -> void {
+      if (UNLIKELY(++next_order_id_ == end_order_id_))
+        next_order_id_ = first_order_id_;
+    }
+
+    // 将已终止的订单从风险管理器的在途敞口、订单链表和订单ID哈希映射中移除，并归还内存池
+    auto removeOrder(OMOrder *order) noexcept -> void {
+      order->order_state_ = OMOrderState::DEAD;
+      risk_manager_.removeWorkingQty(order->ticker_id_, order->side_, order->price_, order->qty_);
+
+      auto &first_order = ticker_side_order_.at(order->ticker_id_).at(sideToIndex(order->side_));
+      if (order->next_order_ == order) {
+        first_order = nullptr;
+      } else {
+        order->prev_order_->next_order_ = order->next_order_;
+        order->next_order_->prev_order_ = order->prev_order_;
+        if (first_order == order)
+          first_order = order->next_order_;
+      }
+      order->prev_order_ = order->next_order_ = nullptr;
+
+      order_id_to_order_.at(order->order_id_ % TE_STRATEGY_ORDER_IDS) = nullptr;
+      order_pool_.deallocate(order);
+    }
+
     // 父交易引擎对象，用于发送客户端请求
     TradeEngine *trade_engine_ = nullptr;
 
-    // 风险管理器，用于执行交易前的风险检查
-    const RiskManager& risk_manager_;
+    // 风险管理器，用于执行交易前的风险检查，并跟踪本订单管理器的在途订单敞口
+    RiskManager& risk_manager_;
 
-    std::string time_str_;
-    Common::Logger *logger_ = nullptr;
+    Common::BinLogger *logger_ = nullptr;
 
-    // 从股票代码(TickerId)到买卖方向(Side)再到OMOrder的哈希映射容器
+    // OMOrder对象的内存池
+    MemPool<OMOrder> order_pool_;
+
+    // 从股票代码(TickerId)到买卖方向(Side)再到OMOrder链表的哈希映射容器
     OMOrderTickerSideHashMap ticker_side_order_;
 
-    // 用于为发出的新订单请求设置订单ID
+    // 从订单ID到OMOrder的哈希映射容器，用于按客户端响应的订单ID查找订单
+    OMOrderHashMap order_id_to_order_;
+
+    // 本订单管理器的订单ID分区 [first_order_id_, end_order_id_)，用于为发出的新订单请求设置订单ID
+    // 订单ID用尽后从分区起始值重新开始，跳过仍被未终止订单使用的订单ID
+    const OrderId first_order_id_ = 1;
+    const OrderId end_order_id_ = TE_STRATEGY_ORDER_IDS;
     OrderId next_order_id_ = 1;
   };
-}
\ No newline at end of file
+}
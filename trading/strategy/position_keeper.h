@@ -2,7 +2,7 @@
 
 #include "common/macros.h"
 #include "common/types.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
 
 #include "exchange/order_server/client_response.h"
 
@@ -11,107 +11,129 @@
 using namespace Common;
 
 namespace Trading {
+  // 盈亏和开仓成本的定点数比例：以 1/PNL_SCALE 个价格单位为最小单位的 int64 整数
+  // 价格为整数，中间价为两个价格的平均，因此成交价和中间价在此精度下都可以精确表示
+  constexpr int64_t PNL_SCALE = 10000;
+
   // PositionInfo用于跟踪单个交易工具的持仓、盈亏（已实现和未实现）以及成交量
+  // 开仓成本和盈亏以定点整数累计，成交和盘口变化时只做整数乘加，不会累积舍入误差，读取时才转换为 double
+  // 未实现盈亏和总盈亏延迟计算：成交和标记价格变化只记录标记价格并标记为过期，由风险管理器或报告读取时才重新计算
   struct PositionInfo {
     int32_t position_ = 0;  // 持仓量（正数表示多头，负数表示空头）
-    double real_pnl_ = 0, unreal_pnl_ = 0, total_pnl_ = 0;  // 已实现盈亏、未实现盈亏、总盈亏
-    std::array<double, sideToIndex(Side::MAX) + 1> open_vwap_;  // 开仓均价（按买卖方向区分）
+    int64_t open_cost_ = 0;  // 当前持仓的开仓成本（开仓价格×数量，定点数，始终非负）
+    int64_t real_pnl_ = 0;  // 已实现盈亏（定点数）
+    int64_t mark_ = 0;  // 计算未实现盈亏的标记价格（最近一次成交价或有持仓时的中间价，定点数）
     Qty volume_ = 0;  // 总成交量
     const BBO *bbo_ = nullptr;  // 当前最优买卖报价
 
+    // toString() 经由指针读取相邻的最优买卖报价，BinLogger 在记录日志的线程上转换为字符串而不是按值拷贝
+    static constexpr bool BIN_LOG_AS_STRING = true;
+
+    // 读取定点数的总盈亏，若已过期则先按标记价格重新计算，因此读取到的始终是精确值
+    auto fixedTotalPnl() const noexcept {
+      refreshPnl();
+      return total_pnl_;
+    }
+
+    // 读取盈亏和开仓均价，此时才从定点数转换为 double
+    auto realPnl() const noexcept {
+      return static_cast<double>(real_pnl_) / PNL_SCALE;
+    }
+
+    auto unrealPnl() const noexcept {
+      refreshPnl();
+      return static_cast<double>(unreal_pnl_) / PNL_SCALE;
+    }
+
+    auto totalPnl() const noexcept {
+      return static_cast<double>(fixedTotalPnl()) / PNL_SCALE;
+    }
+
+    auto openVwap() const noexcept {
+      return (position_ ? static_cast<double>(open_cost_) / PNL_SCALE / std::abs(position_) : 0);
+    }
+
     auto toString() const {
       std::stringstream ss;
       ss << "Position{"
          << "pos:" << position_
-         << " u-pnl:" << unreal_pnl_
-         << " r-pnl:" << real_pnl_
-         << " t-pnl:" << total_pnl_
+         << " u-pnl:" << unrealPnl()
+         << " r-pnl:" << realPnl()
+         << " t-pnl:" << totalPnl()
          << " vol:" << qtyToString(volume_)
-         << " vwaps:[" << (position_ ? open_vwap_.at(sideToIndex(Side::BUY)) / std::abs(position_) : 0)
-         << "X" << (position_ ? open_vwap_.at(sideToIndex(Side::SELL)) / std::abs(position_) : 0)
+         << " vwaps:[" << (position_ > 0 ? openVwap() : 0)
+         << "X" << (position_ < 0 ? openVwap() : 0)
          << "] "
          << (bbo_ ? bbo_->toString() : "") << "}";
 
       return ss.str();
     }
 
+    // 设置定点数标记价格，标记价格变化时未实现盈亏和总盈亏过期
+    auto markToPrice(int64_t mark) noexcept {
+      pnl_dirty_ |= (mark != mark_);
+      mark_ = mark;
+    }
+
     // 处理成交并更新持仓、盈亏和成交量
-    auto addFill(const Exchange::MEClientResponse *client_response, Logger *logger) noexcept {
+    auto addFill(const Exchange::MEClientResponse *client_response, BinLogger *logger) noexcept {
       const auto old_position = position_;  // 记录成交前的持仓
-      const auto side_index = sideToIndex(client_response->side_);  // 成交方向索引
-      const auto opp_side_index = sideToIndex(client_response->side_ == Side::BUY ? Side::SELL : Side::BUY);  // 相反方向索引
       const auto side_value = sideToValue(client_response->side_);  // 方向值（买为1，卖为-1）
+      const auto fill_price = client_response->price_ * PNL_SCALE;  // 定点数成交价
       position_ += client_response->exec_qty_ * side_value;  // 更新持仓
       volume_ += client_response->exec_qty_;  // 更新成交量
 
-      if (old_position * sideToValue(client_response->side_) >= 0) {  // 开仓或加仓
-        open_vwap_[side_index] += (client_response->price_ * client_response->exec_qty_);  // 累加开仓金额
+      if (old_position * side_value >= 0) {  // 开仓或加仓
+        open_cost_ += fill_price * client_response->exec_qty_;  // 累加开仓成本
       } else {  // 减仓
-        const auto opp_side_vwap = open_vwap_[opp_side_index] / std::abs(old_position);  // 反向持仓均价
-        open_vwap_[opp_side_index] = opp_side_vwap * std::abs(position_);  // 更新剩余反向持仓金额
+        // 平仓部分按开仓均价分摊开仓成本，仅此处需要一次整数除法，剩余成本为两者之差，因此成本总和不会漂移
+        const int64_t closed_qty = std::min(static_cast<int32_t>(client_response->exec_qty_), std::abs(old_position));
+        const auto closed_cost = open_cost_ * closed_qty / std::abs(old_position);
+        open_cost_ -= closed_cost;
         // 计算已实现盈亏（平仓部分）
-        real_pnl_ += std::min(static_cast<int32_t>(client_response->exec_qty_), std::abs(old_position)) *
-                     (opp_side_vwap - client_response->price_) * sideToValue(client_response->side_);
-        if (position_ * old_position < 0) {  // 持仓方向反转
-          open_vwap_[side_index] = (client_response->price_ * std::abs(position_));  // 新方向持仓金额
-          open_vwap_[opp_side_index] = 0;  // 清空原方向持仓金额
-        }
-      }
-
-      if (!position_) {  // 平仓（持仓为0）
-        open_vwap_[sideToIndex(Side::BUY)] = open_vwap_[sideToIndex(Side::SELL)] = 0;  // 清空均价
-        unreal_pnl_ = 0;  // 未实现盈亏为0
-      } else {
-        // 根据当前持仓方向计算未实现盈亏
-        if (position_ > 0)
-          unreal_pnl_ =
-              (client_response->price_ - open_vwap_[sideToIndex(Side::BUY)] / std::abs(position_)) *
-              std::abs(position_);
-        else
-          unreal_pnl_ =
-              (open_vwap_[sideToIndex(Side::SELL)] / std::abs(position_) - client_response->price_) *
-              std::abs(position_);
+        real_pnl_ += (closed_cost - fill_price * closed_qty) * side_value;
+        if (static_cast<int64_t>(position_) * old_position < 0)  // 持仓方向反转（以 int64 相乘，大持仓时不会溢出）
+          open_cost_ = fill_price * std::abs(position_);  // 新方向的开仓成本
       }
 
-      total_pnl_ = unreal_pnl_ + real_pnl_;  // 更新总盈亏
+      if (!position_)  // 平仓（持仓为0），未实现盈亏为0
+        open_cost_ = 0;
+      mark_ = fill_price;  // 按成交价计算未实现盈亏
+      pnl_dirty_ = true;  // 持仓和开仓成本已变化
 
-      std::string time_str;
-      logger->log("%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str),
-                  toString(), client_response->toString().c_str());
+      logger->log("%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                  this, client_response);
     }
 
-    // 处理盘口价格（BBO）变化，若有持仓则更新未实现盈亏
-    auto updateBBO(const BBO *bbo, Logger *logger) noexcept {
-      std::string time_str;
+    // 处理盘口价格（BBO）变化，若有持仓则以中间价为标记价格，盈亏在下次读取时才重新计算
+    // 没有持仓时未实现盈亏始终为0，中间价未变化时盈亏不会过期
+    auto updateBBO(const BBO *bbo) noexcept {
       bbo_ = bbo;  // 更新当前最优买卖报价
 
-      if (position_ && bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID) {
-        const auto mid_price = (bbo->bid_price_ + bbo->ask_price_) * 0.5;  // 计算中间价
-        // 根据持仓方向计算未实现盈亏（基于中间价）
-        if (position_ > 0)
-          unreal_pnl_ =
-              (mid_price - open_vwap_[sideToIndex(Side::BUY)] / std::abs(position_)) *
-              std::abs(position_);
-        else
-          unreal_pnl_ =
-              (open_vwap_[sideToIndex(Side::SELL)] / std::abs(position_) - mid_price) *
-              std::abs(position_);
-
-        const auto old_total_pnl = total_pnl_;
-        total_pnl_ = unreal_pnl_ + real_pnl_;  // 更新总盈亏
-
-        // 若总盈亏变化，记录日志
-        if (total_pnl_ != old_total_pnl)
-          logger->log("%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str),
-                      toString(), bbo_->toString());
+      if (position_ && bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID)
+        markToPrice((bbo->bid_price_ + bbo->ask_price_) * (PNL_SCALE / 2));  // PNL_SCALE 为偶数，定点数中间价是精确的
+    }
+
+  private:
+    // 若盈亏已过期，按标记价格重新计算未实现盈亏和总盈亏
+    // 多头的未实现盈亏为 持仓×标记价格 - 开仓成本，空头为 开仓成本 - |持仓|×标记价格，没有持仓时为0
+    auto refreshPnl() const noexcept -> void {
+      if (UNLIKELY(pnl_dirty_)) {
+        unreal_pnl_ = position_ * mark_ - (position_ > 0 ? open_cost_ : -open_cost_);
+        total_pnl_ = unreal_pnl_ + real_pnl_;
+        pnl_dirty_ = false;
       }
     }
+
+    // 延迟计算的未实现盈亏和总盈亏（定点数），仅在 pnl_dirty_ 为 false 时有效
+    mutable int64_t unreal_pnl_ = 0, total_pnl_ = 0;
+    mutable bool pnl_dirty_ = false;
   };
 
   // 顶级持仓管理类，用于计算所有交易工具的持仓、盈亏和成交量
   class PositionKeeper {
   public:
-    PositionKeeper(Common::Logger *logger)
+    PositionKeeper(Common::BinLogger *logger)
         : logger_(logger) {
     }
 
@@ -122,8 +144,7 @@ namespace Trading {
     PositionKeeper &operator=(const PositionKeeper &&) = delete;
 
   private:
-    std::string time_str_;
-    Common::Logger *logger_ = nullptr;
+    Common::BinLogger *logger_ = nullptr;
 
     // 从股票代码（TickerId）到PositionInfo的哈希映射容器
     std::array<PositionInfo, ME_MAX_TICKERS> ticker_position_;
@@ -134,9 +155,9 @@ namespace Trading {
       ticker_position_.at(client_response->ticker_id_).addFill(client_response, logger_);
     }
 
-    // 更新指定股票的最优买卖报价（BBO）并调整未实现盈亏
+    // 更新指定股票的最优买卖报价（BBO），未实现盈亏在读取时才重新计算
     auto updateBBO(TickerId ticker_id, const BBO *bbo) noexcept {
-      ticker_position_.at(ticker_id).updateBBO(bbo, logger_);
+      ticker_position_.at(ticker_id).updateBBO(bbo);
     }
 
     // 获取指定股票的持仓信息
@@ -152,7 +173,7 @@ namespace Trading {
       for(TickerId i = 0; i < ticker_position_.size(); ++i) {
         ss << "TickerId:" << tickerIdToString(i) << " " << ticker_position_.at(i).toString() << "\n";
 
-        total_pnl += ticker_position_.at(i).total_pnl_;
+        total_pnl += ticker_position_.at(i).totalPnl();
         total_vol += ticker_position_.at(i).volume_;
       }
       ss << "Total PnL:" << total_pnl << " Vol:" << total_vol << "\n";
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "common/macros.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
 
 #include "position_keeper.h"
 #include "om_order.h"
@@ -17,7 +17,9 @@ namespace Trading {
     ORDER_TOO_LARGE = 1,     // 订单规模过大
     POSITION_TOO_LARGE = 2,  // 持仓规模过大
     LOSS_TOO_LARGE = 3,      // 亏损过大
-    ALLOWED = 4              // 允许交易（通过所有检查）
+    GROSS_NOTIONAL_TOO_LARGE = 4,  // 组合总名义金额过大
+    NET_NOTIONAL_TOO_LARGE = 5,    // 组合净名义金额过大
+    ALLOWED = 6              // 允许交易（通过所有检查）
   };
 
   inline auto riskCheckResultToString(RiskCheckResult result) {
@@ -30,6 +32,10 @@ namespace Trading {
         return "POSITION_TOO_LARGE";
       case RiskCheckResult::LOSS_TOO_LARGE:
         return "LOSS_TOO_LARGE";
+      case RiskCheckResult::GROSS_NOTIONAL_TOO_LARGE:
+        return "GROSS_NOTIONAL_TOO_LARGE";
+      case RiskCheckResult::NET_NOTIONAL_TOO_LARGE:
+        return "NET_NOTIONAL_TOO_LARGE";
       case RiskCheckResult::ALLOWED:
         return "ALLOWED";
     }
@@ -41,28 +47,52 @@ namespace Trading {
   struct RiskInfo {
     const PositionInfo *position_info_ = nullptr;  // 关联的持仓信息
 
+    // toString() 经由指针读取相邻的持仓信息，BinLogger 在记录日志的线程上转换为字符串而不是按值拷贝
+    static constexpr bool BIN_LOG_AS_STRING = true;
+
     RiskCfg risk_cfg_;  // 风险配置参数
 
-    // 检查风险以确定是否允许发送指定方向和数量的订单
+    // 已发送但尚未成交或终止的订单（待新建、活跃和待取消）的剩余数量和名义金额，按买卖方向区分
+    std::array<Qty, sideToIndex(Side::MAX) + 1> working_qty_ = {};
+    std::array<double, sideToIndex(Side::MAX) + 1> working_notional_ = {};
+
+    // 持仓的名义金额（带方向，按最近一次成交价计算）
+    double position_notional_ = 0;
+
+    // 检查风险以确定是否允许以指定价格发送指定方向和数量的订单
+    // 持仓检查假设同方向的在途订单和新订单全部成交，名义金额检查使用所属风险管理器汇总的组合总名义金额和净名义金额
+    // 各项检查都只读取增量维护的数据，先计算全部检查结果再合并为一次分支，只有检查失败时才确定失败原因
     // 返回RiskCheckResult值以传达风险检查的结果
-    auto checkPreTradeRisk(Side side, Qty qty) const noexcept {
-      // 检查订单规模
-      if (UNLIKELY(qty > risk_cfg_.max_order_size_))
-        return RiskCheckResult::ORDER_TOO_LARGE;
-      // 检查持仓规模（下单后）
-      if (UNLIKELY(std::abs(position_info_->position_ + sideToValue(side) * static_cast<int32_t>(qty)) > static_cast<int32_t>(risk_cfg_.max_position_)))
-        return RiskCheckResult::POSITION_TOO_LARGE;
-      // 检查总亏损
-      if (UNLIKELY(position_info_->total_pnl_ < risk_cfg_.max_loss_))
-        return RiskCheckResult::LOSS_TOO_LARGE;
-
-      return RiskCheckResult::ALLOWED;  // 所有风险检查通过
+    auto checkPreTradeRisk(Side side, Price price, Qty qty, double gross_notional, double net_notional,
+                           const PortfolioRiskCfg &portfolio_risk_cfg) const noexcept {
+      const auto side_value = sideToValue(side);
+      const auto notional = static_cast<double>(price) * qty;
+      const auto worst_position = static_cast<int64_t>(position_info_->position_) +
+                                  side_value * (static_cast<int64_t>(working_qty_[sideToIndex(side)]) + qty);
+
+      const bool order_too_large = (qty > risk_cfg_.max_order_size_);  // 订单规模
+      const bool position_too_large = (std::abs(worst_position) > static_cast<int64_t>(risk_cfg_.max_position_));  // 最坏情况下的持仓规模
+      const bool loss_too_large = (position_info_->fixedTotalPnl() < risk_cfg_.max_loss_ * PNL_SCALE);  // 总亏损（定点数比较，过期时先按标记价格重新计算）
+      const bool gross_too_large = (gross_notional + notional > portfolio_risk_cfg.max_gross_notional_);  // 下单后的组合总名义金额
+      const bool net_too_large = (std::abs(net_notional + side_value * notional) > portfolio_risk_cfg.max_net_notional_);  // 下单后的组合净名义金额
+
+      if (LIKELY(!(order_too_large | position_too_large | loss_too_large | gross_too_large | net_too_large)))
+        return RiskCheckResult::ALLOWED;  // 所有风险检查通过
+
+      return order_too_large ? RiskCheckResult::ORDER_TOO_LARGE :
+             position_too_large ? RiskCheckResult::POSITION_TOO_LARGE :
+             loss_too_large ? RiskCheckResult::LOSS_TOO_LARGE :
+             gross_too_large ? RiskCheckResult::GROSS_NOTIONAL_TOO_LARGE :
+             RiskCheckResult::NET_NOTIONAL_TOO_LARGE;
     }
 
     auto toString() const {
       std::stringstream ss;
       ss << "RiskInfo" << "["
          << "pos:" << position_info_->toString() << " "
+         << "pos-notional:" << position_notional_ << " "
+         << "working:[" << qtyToString(working_qty_[sideToIndex(Side::BUY)]) << "@" << working_notional_[sideToIndex(Side::BUY)]
+         << "X" << qtyToString(working_qty_[sideToIndex(Side::SELL)]) << "@" << working_notional_[sideToIndex(Side::SELL)] << "] "
          << risk_cfg_.toString()
          << "]";
 
@@ -76,11 +106,56 @@ namespace Trading {
   // 风险管理器类，用于计算和检查所有交易工具的风险
   class RiskManager {
   public:
-    RiskManager(Common::Logger *logger, const PositionKeeper *position_keeper, const TradeEngineCfgHashMap &ticker_cfg);
+    RiskManager(Common::BinLogger *logger, const PositionKeeper *position_keeper, const TradeEngineCfgHashMap &ticker_cfg,
+                const PortfolioRiskCfg &portfolio_risk_cfg = PortfolioRiskCfg());
+
+    // 检查交易前风险（指定股票、方向、价格和数量）
+    auto checkPreTradeRisk(TickerId ticker_id, Side side, Price price, Qty qty) const noexcept {
+      return ticker_risk_.at(ticker_id).checkPreTradeRisk(side, price, qty, gross_notional_, net_notional_, portfolio_risk_cfg_);
+    }
+
+    // 以下方法由订单管理器和持仓管理器的事件调用，增量维护每个股票的在途敞口和组合名义金额
+    // 组合总名义金额 = 各股票 |持仓名义金额| + 买卖两个方向的在途名义金额，组合净名义金额 = 各股票 持仓名义金额 + 买方在途名义金额 - 卖方在途名义金额
+
+    // 新订单发送后，将其数量和名义金额计入在途敞口
+    auto addWorkingQty(TickerId ticker_id, Side side, Price price, Qty qty) noexcept {
+      const auto notional = static_cast<double>(price) * qty;
+      auto &risk_info = ticker_risk_.at(ticker_id);
+      risk_info.working_qty_[sideToIndex(side)] += qty;
+      risk_info.working_notional_[sideToIndex(side)] += notional;
+      gross_notional_ += notional;
+      net_notional_ += sideToValue(side) * notional;
+    }
+
+    // 在途订单部分或全部成交、被取消或终止后，将相应的数量和名义金额（按订单价格）从在途敞口中移除
+    auto removeWorkingQty(TickerId ticker_id, Side side, Price price, Qty qty) noexcept {
+      const auto notional = static_cast<double>(price) * qty;
+      auto &risk_info = ticker_risk_.at(ticker_id);
+      risk_info.working_qty_[sideToIndex(side)] -= qty;
+      risk_info.working_notional_[sideToIndex(side)] -= notional;
+      gross_notional_ -= notional;
+      net_notional_ -= sideToValue(side) * notional;
+    }
+
+    // 持仓管理器处理成交后，按成交价重新计算该股票的持仓名义金额
+    auto onFill(TickerId ticker_id, Price price) noexcept {
+      auto &risk_info = ticker_risk_.at(ticker_id);
+      const auto old_notional = risk_info.position_notional_;
+      risk_info.position_notional_ = static_cast<double>(risk_info.position_info_->position_) * price;
+      gross_notional_ += std::abs(risk_info.position_notional_) - std::abs(old_notional);
+      net_notional_ += risk_info.position_notional_ - old_notional;
+    }
+
+    auto getRiskInfo(TickerId ticker_id) const noexcept {
+      return &(ticker_risk_.at(ticker_id));
+    }
+
+    auto grossNotional() const noexcept {
+      return gross_notional_;
+    }
 
-    // 检查交易前风险（指定股票、方向和数量）
-    auto checkPreTradeRisk(TickerId ticker_id, Side side, Qty qty) const noexcept {
-      return ticker_risk_.at(ticker_id).checkPreTradeRisk(side, qty);
+    auto netNotional() const noexcept {
+      return net_notional_;
     }
 
     RiskManager() = delete;
@@ -90,10 +165,14 @@ namespace Trading {
     RiskManager &operator=(const RiskManager &&) = delete;
 
   private:
-    std::string time_str_;
-    Common::Logger *logger_ = nullptr;
+    Common::BinLogger *logger_ = nullptr;
 
     // 从股票代码（TickerId）到RiskInfo的哈希映射容器
     TickerRiskInfoHashMap ticker_risk_;
+
+    // 组合层面的风险限制，以及跨全部股票汇总的总名义金额和净名义金额
+    const PortfolioRiskCfg portfolio_risk_cfg_;
+    double gross_notional_ = 0;
+    double net_notional_ = 0;
   };
 }
\ No newline at end of file
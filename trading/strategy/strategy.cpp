@@ -0,0 +1,72 @@
+#include "strategy.h"
+
+#include "trade_engine.h"
+
+namespace Trading {
+  Strategy::Strategy(size_t index, const StrategyCfg &cfg, Common::BinLogger *logger, TradeEngine *trade_engine, const FeatureEngine *feature_engine)
+      : index_(index), algo_type_(cfg.algo_type_), logger_(logger),
+        position_keeper_(logger),
+        risk_manager_(logger, &position_keeper_, cfg.ticker_cfg_, cfg.portfolio_risk_cfg_),
+        order_manager_(logger, trade_engine, risk_manager_, std::max<OrderId>(index * TE_STRATEGY_ORDER_IDS, 1)),
+        dynamic_algo_(this) {
+    ASSERT(index < TE_MAX_STRATEGIES, "Strategy index out of range:" + std::to_string(index));
+
+    // 初始化订单簿变化、交易事件和客户端响应的回调函数包装器（默认实现仅记录日志）
+    algoOnOrderBookUpdate_ = [this](auto ticker_id, auto price, auto side, auto) {
+      logger_->log("%:% %() % strategy:% ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
+                   Common::getCurrentLogTime(), index_, ticker_id, Common::priceToString(price).c_str(),
+                   Common::sideToString(side).c_str());
+    };
+    algoOnTradeUpdate_ = [this](auto market_update, auto) {
+      logger_->log("%:% %() % strategy:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                   index_, market_update);
+    };
+    algoOnOrderUpdate_ = [this](auto client_response) {
+      logger_->log("%:% %() % strategy:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                   index_, client_response);
+    };
+
+    // 根据指定的算法类型创建交易算法实例，构造函数会覆盖上述回调函数
+    if (algo_type_ == AlgoType::MAKER) {
+      mm_algo_ = new MarketMaker(logger_, this, feature_engine, &order_manager_, cfg.ticker_cfg_);
+    } else if (algo_type_ == AlgoType::TAKER) {
+      taker_algo_ = new LiquidityTaker(logger_, this, feature_engine, &order_manager_, cfg.ticker_cfg_);
+    }
+
+    logger_->log("%:% %() % Initialized strategy:% %\n", __FILE__, __LINE__, __FUNCTION__,
+                 Common::getCurrentLogTime(), index_, cfg);
+  }
+
+  Strategy::~Strategy() {
+    delete mm_algo_; mm_algo_ = nullptr;
+    delete taker_algo_; taker_algo_ = nullptr;
+  }
+
+  auto parseStrategyCfgs(int first_arg, int argc, char **argv) -> std::vector<StrategyCfg> {
+    std::vector<StrategyCfg> strategy_cfgs;
+    size_t next_ticker_id = 0;
+    for (int i = first_arg; i < argc;) {
+      const auto algo_type = stringToAlgoType(argv[i]);  // 转换算法类型字符串为枚举值
+      if (algo_type != AlgoType::INVALID) {
+        strategy_cfgs.push_back(StrategyCfg{algo_type, {}, {}});
+        next_ticker_id = 0;
+        ++i;
+        continue;
+      }
+
+      ASSERT(!strategy_cfgs.empty() && i + 5 <= argc, "Invalid strategy parameters at:" + std::string(argv[i]));
+      strategy_cfgs.back().ticker_cfg_.at(next_ticker_id++) = {
+        static_cast<Qty>(std::atoi(argv[i])),          // 成交量阈值
+        std::atof(argv[i + 1]),                        // 价格阈值
+        {
+          static_cast<Qty>(std::atoi(argv[i + 2])),    // 最大订单量
+          static_cast<Qty>(std::atoi(argv[i + 3])),    // 最大持仓
+          std::atof(argv[i + 4])                       // 最大亏损
+        }
+      };
+      i += 5;
+    }
+
+    return strategy_cfgs;
+  }
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/bin_logging.h"
+
+#include "exchange/order_server/client_response.h"
+#include "exchange/market_data/market_update.h"
+
+#include "market_order_book.h"
+
+#include "feature_engine.h"
+#include "position_keeper.h"
+#include "order_manager.h"
+#include "risk_manager.h"
+
+#include "market_maker.h"
+#include "liquidity_taker.h"
+
+namespace Trading {
+  class TradeEngine;
+  class Strategy;
+
+  // 经由策略实例的函数包装器调用交易算法的适配器
+  // 作为策略实例回调的 AlgoT 模板参数时表示运行期动态分发，适用于任何算法类型
+  class DynamicAlgo {
+  public:
+    explicit DynamicAlgo(Strategy *strategy)
+        : strategy_(strategy) {
+    }
+
+    auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept -> void;
+    auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void;
+    auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void;
+
+    DynamicAlgo() = delete;
+    DynamicAlgo(const DynamicAlgo &) = delete;
+    DynamicAlgo(const DynamicAlgo &&) = delete;
+    DynamicAlgo &operator=(const DynamicAlgo &) = delete;
+    DynamicAlgo &operator=(const DynamicAlgo &&) = delete;
+
+  private:
+    Strategy *strategy_ = nullptr;
+  };
+
+  // 交易引擎中的单个策略实例
+  // 拥有独立的订单管理器、风险管理器和持仓管理器，与同一交易引擎中的其他策略实例共享订单簿和特征引擎
+  class Strategy {
+  public:
+    Strategy(size_t index, const StrategyCfg &cfg, Common::BinLogger *logger, TradeEngine *trade_engine, const FeatureEngine *feature_engine);
+
+    ~Strategy();
+
+    // 以下回调的 AlgoT 模板参数决定如何调用交易算法：
+    // MarketMaker 或 LiquidityTaker 时在编译期绑定到该算法的回调并可被内联，要求本策略实例正是该算法类型；
+    // DynamicAlgo 时经由函数包装器；void（默认）时按本策略实例的算法类型在运行期选择前两者之一
+
+    // 处理订单簿变化：更新持仓管理器，并通知交易算法
+    template<typename AlgoT = void>
+    auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept -> void {
+      START_MEASURE(Trading_PositionKeeper_updateBBO);
+      position_keeper_.updateBBO(ticker_id, book->getBBO());
+      END_MEASURE(Trading_PositionKeeper_updateBBO, (*logger_));
+
+      withAlgo<AlgoT>([&](auto algo) { algo->onOrderBookUpdate(ticker_id, price, side, book); });
+    }
+
+    // 处理交易事件：通知交易算法
+    template<typename AlgoT = void>
+    auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void {
+      withAlgo<AlgoT>([&](auto algo) { algo->onTradeUpdate(market_update, book); });
+    }
+
+    // 处理属于本策略实例订单的客户端响应：更新持仓管理器，并通知交易算法
+    template<typename AlgoT = void>
+    auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
+      if (UNLIKELY(client_response->type_ == Exchange::ClientResponseType::FILLED)) {
+        START_MEASURE(Trading_PositionKeeper_addFill);
+        position_keeper_.addFill(client_response);
+        END_MEASURE(Trading_PositionKeeper_addFill, (*logger_));
+        risk_manager_.onFill(client_response->ticker_id_, client_response->price_);
+      }
+
+      withAlgo<AlgoT>([&](auto algo) { algo->onOrderUpdate(client_response); });
+    }
+
+    // 函数包装器，用于将订单簿更新、交易事件和客户端响应分发到做市和流动性获取以外的交易算法
+    std::function<void(TickerId ticker_id, Price price, Side side, MarketOrderBook *book)> algoOnOrderBookUpdate_;
+    std::function<void(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book)> algoOnTradeUpdate_;
+    std::function<void(const Exchange::MEClientResponse *client_response)> algoOnOrderUpdate_;
+
+    auto index() const noexcept {
+      return index_;
+    }
+
+    auto algoType() const noexcept {
+      return algo_type_;
+    }
+
+    // 获取做市或流动性获取算法实例，未创建时为 nullptr
+    auto marketMaker() noexcept {
+      return mm_algo_;
+    }
+
+    auto liquidityTaker() noexcept {
+      return taker_algo_;
+    }
+
+    auto positionKeeper() const noexcept -> const PositionKeeper * {
+      return &position_keeper_;
+    }
+
+    auto riskManager() const noexcept -> const RiskManager * {
+      return &risk_manager_;
+    }
+
+    Strategy() = delete;
+    Strategy(const Strategy &) = delete;
+    Strategy(const Strategy &&) = delete;
+    Strategy &operator=(const Strategy &) = delete;
+    Strategy &operator=(const Strategy &&) = delete;
+
+  private:
+    // 以 AlgoT 指定的方式获取交易算法并调用 f
+    template<typename AlgoT, typename F>
+    auto withAlgo(F &&f) noexcept {
+      if constexpr (std::is_same_v<AlgoT, MarketMaker>) {
+        f(mm_algo_);
+      } else if constexpr (std::is_same_v<AlgoT, LiquidityTaker>) {
+        f(taker_algo_);
+      } else if constexpr (std::is_same_v<AlgoT, DynamicAlgo>) {
+        f(&dynamic_algo_);
+      } else {
+        static_assert(std::is_void_v<AlgoT>, "Unsupported AlgoT.");
+        if (mm_algo_)
+          f(mm_algo_);
+        else if (taker_algo_)
+          f(taker_algo_);
+        else
+          f(&dynamic_algo_);
+      }
+    }
+
+    const size_t index_;  // 策略实例在交易引擎中的序号，决定其订单ID分区
+    const AlgoType algo_type_;
+
+    Common::BinLogger *logger_ = nullptr;
+
+    // 用于跟踪本策略实例持仓、盈亏和成交量的持仓管理器
+    PositionKeeper position_keeper_;
+
+    // 用于跟踪和执行本策略实例交易前风险检查的风险管理器
+    RiskManager risk_manager_;
+
+    // 管理本策略实例订单的订单管理器
+    OrderManager order_manager_;
+
+    // 做市或流动性获取算法实例（每个策略实例中只创建其中一个）
+    MarketMaker *mm_algo_ = nullptr;
+    LiquidityTaker *taker_algo_ = nullptr;
+
+    // 经由上述函数包装器调用交易算法
+    DynamicAlgo dynamic_algo_;
+  };
+
+  inline auto DynamicAlgo::onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept -> void {
+    strategy_->algoOnOrderBookUpdate_(ticker_id, price, side, book);
+  }
+
+  inline auto DynamicAlgo::onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void {
+    strategy_->algoOnTradeUpdate_(market_update, book);
+  }
+
+  inline auto DynamicAlgo::onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
+    strategy_->algoOnOrderUpdate_(client_response);
+  }
+
+  // 从命令行参数 argv[first_arg, argc) 解析策略实例配置，trading_main 和 backtest_main 使用相同的格式：
+  // 算法类型 [股票1的成交量阈值 价格阈值 最大订单量 最大持仓 最大亏损] [股票2的...参数] ... [算法类型 ...] ...
+  // 每个算法类型开始一个新的策略实例，其后每5个参数依次配置股票0、1、...
+  auto parseStrategyCfgs(int first_arg, int argc, char **argv) -> std::vector<StrategyCfg>;
+
+  // 将市场事件在一次遍历中分发到交易引擎中的全部策略实例，并按订单ID分区将客户端响应路由到所属的策略实例
+  class StrategyDispatcher {
+  public:
+    auto addStrategy(Strategy *strategy) {
+      ASSERT(strategies_.size() < TE_MAX_STRATEGIES, "Too many strategies:" + std::to_string(strategies_.size()));
+      strategies_.push_back(strategy);
+    }
+
+    // AlgoT 的含义与策略实例回调相同，非 void 时须与全部策略实例的算法类型一致
+    template<typename AlgoT = void>
+    auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept {
+      for (auto strategy: strategies_)
+        strategy->template onOrderBookUpdate<AlgoT>(ticker_id, price, side, book);
+    }
+
+    template<typename AlgoT = void>
+    auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept {
+      for (auto strategy: strategies_)
+        strategy->template onTradeUpdate<AlgoT>(market_update, book);
+    }
+
+    template<typename AlgoT = void>
+    auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept {
+      strategyForOrder(client_response->client_order_id_)->template onOrderUpdate<AlgoT>(client_response);
+    }
+
+    // 全部策略实例是否都使用指定的算法类型
+    auto allOf(AlgoType algo_type) const noexcept {
+      return std::all_of(strategies_.begin(), strategies_.end(), [algo_type](auto strategy) { return strategy->algoType() == algo_type; });
+    }
+
+    // 获取订单ID所属的策略实例，不属于任何分区的订单（如随机交易算法直接发送的订单）归属第一个策略实例
+    auto strategyForOrder(OrderId order_id) const noexcept -> Strategy * {
+      const auto index = order_id / TE_STRATEGY_ORDER_IDS;
+      return strategies_[index < strategies_.size() ? index : 0];
+    }
+
+    auto strategies() const noexcept -> const std::vector<Strategy *> & {
+      return strategies_;
+    }
+
+  private:
+    std::vector<Strategy *> strategies_;
+  };
+}
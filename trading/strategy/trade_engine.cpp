@@ -2,53 +2,62 @@
 
 namespace Trading {
   TradeEngine::TradeEngine(Common::ClientId client_id,
-                           AlgoType algo_type,
-                           const TradeEngineCfgHashMap &ticker_cfg,
+                           const std::vector<StrategyCfg> &strategy_cfgs,
                            Exchange::ClientRequestLFQueue *client_requests,
                            Exchange::ClientResponseLFQueue *client_responses,
                            Exchange::MEMarketUpdateLFQueue *market_updates)
       : client_id_(client_id), outgoing_ogw_requests_(client_requests), incoming_ogw_responses_(client_responses),
         incoming_md_updates_(market_updates), logger_("trading_engine_" + std::to_string(client_id) + ".log"),
-        feature_engine_(&logger_),
-        position_keeper_(&logger_),
-        order_manager_(&logger_, this, risk_manager_),
-        risk_manager_(&logger_, &position_keeper_, ticker_cfg) {
+        feature_engine_(&logger_) {
+    ASSERT(!strategy_cfgs.empty(), "TradeEngine needs at least one strategy.");
+
+    // 订单簿和策略实例的内存池在主线程上构造，绑定到交易引擎线程所在核心的NUMA节点
+    Common::HugePageNumaScope numa_scope(Common::numaNodeOfCore(TE_CORE_ID));
+
     // 初始化每个股票的订单簿并关联交易引擎
     for (size_t i = 0; i < ticker_order_book_.size(); ++i) {
       ticker_order_book_[i] = new MarketOrderBook(i, &logger_);
       ticker_order_book_[i]->setTradeEngine(this);
     }
 
-    // 初始化订单簿变化、交易事件和客户端响应的回调函数包装器（默认实现）
-    algoOnOrderBookUpdate_ = [this](auto ticker_id, auto price, auto side, auto book) {
-      defaultAlgoOnOrderBookUpdate(ticker_id, price, side, book);
-    };
-    algoOnTradeUpdate_ = [this](auto market_update, auto book) { defaultAlgoOnTradeUpdate(market_update, book); };
-    algoOnOrderUpdate_ = [this](auto client_response) { defaultAlgoOnOrderUpdate(client_response); };
-
-    // 根据指定的算法类型创建交易算法实例，构造函数会覆盖上述回调函数
-    if (algo_type == AlgoType::MAKER) {
-      mm_algo_ = new MarketMaker(&logger_, this, &feature_engine_, &order_manager_, ticker_cfg);
-    } else if (algo_type == AlgoType::TAKER) {
-      taker_algo_ = new LiquidityTaker(&logger_, this, &feature_engine_, &order_manager_, ticker_cfg);
-    }
+    // 创建策略实例，每个策略实例使用独立的订单ID分区
+    // 特征引擎只计算所创建的交易算法订阅的特征
+    for (const auto &strategy_cfg: strategy_cfgs) {
+      strategies_.addStrategy(new Strategy(strategies_.strategies().size(), strategy_cfg, &logger_, this, &feature_engine_));
+
+      if (strategy_cfg.algo_type_ == AlgoType::MAKER) {
+        feature_engine_.subscribe(MarketMaker::FEATURES);
+      } else if (strategy_cfg.algo_type_ == AlgoType::TAKER) {
+        feature_engine_.subscribe(LiquidityTaker::FEATURES);
+      }
 
-    for (TickerId i = 0; i < ticker_cfg.size(); ++i) {
-      logger_.log("%:% %() % Initialized % Ticker:% %.\n", __FILE__, __LINE__, __FUNCTION__,
-                  Common::getCurrentTimeStr(&time_str_),
-                  algoTypeToString(algo_type), i,
-                  ticker_cfg.at(i).toString());
+      for (TickerId i = 0; i < strategy_cfg.ticker_cfg_.size(); ++i) {
+        logger_.log("%:% %() % Initialized % Ticker:% %.\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentLogTime(),
+                    algoTypeToString(strategy_cfg.algo_type_), i,
+                    strategy_cfg.ticker_cfg_.at(i));
+      }
     }
   }
 
+  TradeEngine::TradeEngine(Common::ClientId client_id,
+                           AlgoType algo_type,
+                           const TradeEngineCfgHashMap &ticker_cfg,
+                           Exchange::ClientRequestLFQueue *client_requests,
+                           Exchange::ClientResponseLFQueue *client_responses,
+                           Exchange::MEMarketUpdateLFQueue *market_updates)
+      : TradeEngine(client_id, std::vector<StrategyCfg>{StrategyCfg{algo_type, ticker_cfg, {}}},
+                    client_requests, client_responses, market_updates) {
+  }
+
   TradeEngine::~TradeEngine() {
     run_ = false;
 
     using namespace std::literals::chrono_literals;
     std::this_thread::sleep_for(1s);
 
-    delete mm_algo_; mm_algo_ = nullptr;
-    delete taker_algo_; taker_algo_ = nullptr;
+    for (auto strategy: strategies_.strategies())
+      delete strategy;
 
     for (auto &order_book: ticker_order_book_) {
       delete order_book;
@@ -62,8 +71,8 @@ namespace Trading {
 
   // 发送客户端请求（订单）到外部网关队列
   auto TradeEngine::sendClientRequest(const Exchange::MEClientRequest *client_request) noexcept -> void {
-    logger_.log("%:% %() % Sending %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-              client_request->toString().c_str());
+    logger_.log("%:% %() % Sending %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+              client_request);
     // 将请求写入无锁队列
     auto next_write = outgoing_ogw_requests_->getNextToWriteTo();
     *next_write = std::move(*client_request);
@@ -74,92 +83,38 @@ namespace Trading {
   }
 
   // 处理传入的客户端响应和市场数据更新，可能生成新的客户端请求
-  auto TradeEngine::run() noexcept -> void {
-    logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+  // 市场事件在一次遍历中分发到全部策略实例，策略实例更新持仓和风险管理器后按 AlgoT 调用交易算法的回调
+  template<typename AlgoT>
+  auto TradeEngine::runLoop() noexcept -> void {
     while (run_) {
-      // 处理客户端响应（如订单确认、成交回报等）
-      for (auto client_response = incoming_ogw_responses_->getNextToRead(); client_response; client_response = incoming_ogw_responses_->getNextToRead()) {
-        TTT_MEASURE(T9t_TradeEngine_LFQueue_read, logger_);  // 测量队列读取时间
-
-        logger_.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                    client_response->toString().c_str());
-        onOrderUpdate(client_response);  // 处理订单更新
-        incoming_ogw_responses_->updateReadIndex();  // 更新队列读取索引
-        last_event_time_ = Common::getCurrentNanos();  // 更新最后事件时间
+      // 处理全部已发布的客户端响应（如订单确认、成交回报等），处理完后一次性归还队列槽位
+      const auto client_responses = incoming_ogw_responses_->getReadable();
+      if (!client_responses.empty()) {
+        for (size_t i = 0; i < client_responses.size(); ++i)
+          processClientResponse<AlgoT>(&client_responses[i]);
+        incoming_ogw_responses_->commitRead(client_responses.size());  // 更新队列读取索引
+        last_event_time_ = Common::getCurrentTscNanos();  // 更新最后事件时间
       }
 
-      // 处理市场数据更新（如订单簿变化、成交等）
-      for (auto market_update = incoming_md_updates_->getNextToRead(); market_update; market_update = incoming_md_updates_->getNextToRead()) {
-        TTT_MEASURE(T9_TradeEngine_LFQueue_read, logger_);  // 测量队列读取时间
-
-        logger_.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-              market_update->toString().c_str());
-        // 记录市场数据更新（tick）开始处理的时间戳
-        TTT_MEASURE(Tick_Received, logger_);  // 标记tick起点
-        ASSERT(market_update->ticker_id_ < ticker_order_book_.size(),
-            "Unknown ticker-id on update:" + market_update->toString());  // 断言股票代码有效
-        ticker_order_book_[market_update->ticker_id_]->onMarketUpdate(market_update);  // 处理市场更新（更新订单簿）
-        incoming_md_updates_->updateReadIndex();  // 更新队列读取索引
-        last_event_time_ = Common::getCurrentNanos();  // 更新最后事件时间
+      // 处理全部已发布的市场数据更新（如订单簿变化、成交等），处理完后一次性归还队列槽位
+      const auto market_updates = incoming_md_updates_->getReadable();
+      if (!market_updates.empty()) {
+        for (size_t i = 0; i < market_updates.size(); ++i)
+          processMarketUpdate<AlgoT>(&market_updates[i]);
+        incoming_md_updates_->commitRead(market_updates.size());  // 更新队列读取索引
+        last_event_time_ = Common::getCurrentTscNanos();  // 更新最后事件时间
       }
     }
   }
 
-  // 处理订单簿变化：更新持仓管理器、特征引擎，并通知交易算法
-  auto TradeEngine::onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept -> void {
-    logger_.log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
-                Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
-                Common::sideToString(side).c_str());
-
-    auto bbo = book->getBBO();  // 获取最优买卖报价
-
-    // 更新持仓管理器的BBO信息
-    START_MEASURE(Trading_PositionKeeper_updateBBO);
-    position_keeper_.updateBBO(ticker_id, bbo);
-    END_MEASURE(Trading_PositionKeeper_updateBBO, logger_);
-
-    // 通知特征引擎处理订单簿更新
-    START_MEASURE(Trading_FeatureEngine_onOrderBookUpdate);
-    feature_engine_.onOrderBookUpdate(ticker_id, price, side, book);
-    END_MEASURE(Trading_FeatureEngine_onOrderBookUpdate, logger_);
-
-    // 通知交易算法处理订单簿更新
-    START_MEASURE(Trading_TradeEngine_algoOnOrderBookUpdate_);
-    algoOnOrderBookUpdate_(ticker_id, price, side, book);
-    END_MEASURE(Trading_TradeEngine_algoOnOrderBookUpdate_, logger_);
-  }
-
-  // 处理交易事件：更新特征引擎，并通知交易算法
-  auto TradeEngine::onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void {
-    logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                market_update->toString().c_str());
-
-    // 通知特征引擎处理交易事件
-    START_MEASURE(Trading_FeatureEngine_onTradeUpdate);
-    feature_engine_.onTradeUpdate(market_update, book);
-    END_MEASURE(Trading_FeatureEngine_onTradeUpdate, logger_);
-
-    // 通知交易算法处理交易事件
-    START_MEASURE(Trading_TradeEngine_algoOnTradeUpdate_);
-    algoOnTradeUpdate_(market_update, book);
-    END_MEASURE(Trading_TradeEngine_algoOnTradeUpdate_, logger_);
-  }
-
-  // 处理客户端响应：更新持仓管理器，并通知交易算法
-  auto TradeEngine::onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-    logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                client_response->toString().c_str());
-
-    // 若为成交响应，更新持仓管理器
-    if (UNLIKELY(client_response->type_ == Exchange::ClientResponseType::FILLED)) {
-      START_MEASURE(Trading_PositionKeeper_addFill);
-      position_keeper_.addFill(client_response);
-      END_MEASURE(Trading_PositionKeeper_addFill, logger_);
-    }
-
-    // 通知交易算法处理客户端响应
-    START_MEASURE(Trading_TradeEngine_algoOnOrderUpdate_);
-    algoOnOrderUpdate_(client_response);
-    END_MEASURE(Trading_TradeEngine_algoOnOrderUpdate_, logger_);
+  // 全部策略实例都是做市或都是流动性获取算法时，使用编译期绑定该算法回调的主循环，否则每个策略实例在运行期选择
+  auto TradeEngine::run() noexcept -> void {
+    logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
+    if (strategies_.allOf(AlgoType::MAKER))
+      runLoop<MarketMaker>();
+    else if (strategies_.allOf(AlgoType::TAKER))
+      runLoop<LiquidityTaker>();
+    else
+      runLoop<void>();
   }
-}
\ No newline at end of file
+}
@@ -6,7 +6,7 @@
 #include "common/time_utils.h"
 #include "common/lf_queue.h"
 #include "common/macros.h"
-#include "common/logging.h"
+#include "common/bin_logging.h"
 
 #include "exchange/order_server/client_request.h"
 #include "exchange/order_server/client_response.h"
@@ -22,10 +22,20 @@
 #include "market_maker.h"
 #include "liquidity_taker.h"
 
+#include "strategy.h"
+
 namespace Trading {
   // 交易引擎类，负责协调交易算法、订单管理、风险控制和市场数据处理
+  // 一个交易引擎可以运行多个策略实例，它们共享订单簿和特征引擎
   class TradeEngine {
   public:
+    TradeEngine(Common::ClientId client_id,
+                const std::vector<StrategyCfg> &strategy_cfgs,
+                Exchange::ClientRequestLFQueue *client_requests,
+                Exchange::ClientResponseLFQueue *client_responses,
+                Exchange::MEMarketUpdateLFQueue *market_updates);
+
+    // 只运行单个策略实例的交易引擎
     TradeEngine(Common::ClientId client_id,
                 AlgoType algo_type,
                 const TradeEngineCfgHashMap &ticker_cfg,
@@ -38,53 +48,125 @@ namespace Trading {
     // 启动和停止交易引擎主线程
     auto start() -> void {
       run_ = true;
-      ASSERT(Common::createAndStartThread(6, "Trading/TradeEngine", [this] { run(); }) != nullptr, "Failed to start TradeEngine thread.");
+      ASSERT(Common::createAndStartThread(TE_CORE_ID, "Trading/TradeEngine", [this] { run(); }) != nullptr, "Failed to start TradeEngine thread.");
     }
 
     auto stop() -> void {
       // 等待所有更新处理完成
       while(incoming_ogw_responses_->size() || incoming_md_updates_->size()) {
         logger_.log("%:% %() % Sleeping till all updates are consumed ogw-size:% md-size:%\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), incoming_ogw_responses_->size(), incoming_md_updates_->size());
+                    Common::getCurrentLogTime(), incoming_ogw_responses_->size(), incoming_md_updates_->size());
 
         using namespace std::literals::chrono_literals;
         std::this_thread::sleep_for(10ms);
       }
 
-      // 记录最终持仓信息
-      logger_.log("%:% %() % POSITIONS\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                  position_keeper_.toString());
+      // 记录每个策略实例的最终持仓信息
+      for (auto strategy: strategies_.strategies())
+        logger_.log("%:% %() % POSITIONS strategy:%\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                    strategy->index(), strategy->positionKeeper());
 
       run_ = false;
     }
 
     auto run() noexcept -> void;
 
+    // 以下处理函数和回调的 AlgoT 模板参数决定策略实例如何调用交易算法，含义见 Strategy：
+    // void（默认）时每个策略实例在运行期选择，MarketMaker 或 LiquidityTaker 时编译期绑定（要求全部策略实例都是该算法），
+    // DynamicAlgo 时经由函数包装器
+
+    // 处理单个客户端响应，通知订单所属的策略实例
+    // 也用于在交易引擎线程之外驱动交易引擎，如回测
+    template<typename AlgoT = void>
+    auto processClientResponse(const Exchange::MEClientResponse *client_response) noexcept -> void {
+      TTT_MEASURE(T9t_TradeEngine_LFQueue_read, logger_);  // 测量队列读取时间
+
+      logger_.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                  client_response);
+      onOrderUpdate<AlgoT>(client_response);  // 处理订单更新
+    }
+
+    // 处理单个市场数据更新，订单簿变化和交易事件经本交易引擎分发到全部策略实例
+    // 也用于在交易引擎线程之外驱动交易引擎，如回测
+    template<typename AlgoT = void>
+    auto processMarketUpdate(const Exchange::MEMarketUpdate *market_update) noexcept -> void {
+      TTT_MEASURE(T9_TradeEngine_LFQueue_read, logger_);  // 测量队列读取时间
+
+      logger_.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+            market_update);
+      // 记录市场数据更新（tick）开始处理的时间戳
+      TTT_MEASURE(Tick_Received, logger_);  // 标记tick起点
+      if (UNLIKELY(market_update->ticker_id_ >= ticker_order_book_.size()))  // 断言股票代码有效
+        FATAL("Unknown ticker-id on update:" + market_update->toString());
+      feature_engine_.onMarketUpdate(market_update);  // 更新基于原始订单事件的特征
+      AlgoListener<AlgoT> listener{this};  // 订单簿变化和交易事件以 AlgoT 通知回本交易引擎
+      ticker_order_book_[market_update->ticker_id_]->onMarketUpdate(market_update, &listener);  // 处理市场更新（更新订单簿）
+    }
+
+    // 使特征引擎使用模拟时钟而非系统时钟
+    auto setClock(const Nanos *clock) noexcept {
+      feature_engine_.setClock(clock);
+    }
+
     // 将客户端请求写入无锁队列，供订单网关消费并发送到交易所
     auto sendClientRequest(const Exchange::MEClientRequest *client_request) noexcept -> void;
 
-    // 处理订单簿变化：更新持仓管理器、特征引擎，并通知交易算法
-    auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept -> void;
+    // 处理订单簿变化：更新特征引擎，并通知全部策略实例
+    // 定义在头文件中，使订单簿的回调经由策略实例静态分发到交易算法并可被内联
+    template<typename AlgoT = void>
+    auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept -> void {
+      logger_.log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
+                  Common::getCurrentLogTime(), ticker_id, Common::priceToString(price).c_str(),
+                  Common::sideToString(side).c_str());
+
+      // 通知特征引擎处理订单簿更新
+      START_MEASURE(Trading_FeatureEngine_onOrderBookUpdate);
+      feature_engine_.onOrderBookUpdate(ticker_id, price, side, book);
+      END_MEASURE(Trading_FeatureEngine_onOrderBookUpdate, logger_);
 
-    // 处理交易事件：更新特征引擎，并通知交易算法
-    auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void;
+      // 通知策略实例处理订单簿更新
+      START_MEASURE(Trading_TradeEngine_algoOnOrderBookUpdate_);
+      strategies_.onOrderBookUpdate<AlgoT>(ticker_id, price, side, book);
+      END_MEASURE(Trading_TradeEngine_algoOnOrderBookUpdate_, logger_);
+    }
 
-    // 处理客户端响应：更新持仓管理器，并通知交易算法
-    auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void;
+    // 处理交易事件：更新特征引擎，并通知全部策略实例
+    template<typename AlgoT = void>
+    auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void {
+      logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                  market_update);
+
+      // 通知特征引擎处理交易事件
+      START_MEASURE(Trading_FeatureEngine_onTradeUpdate);
+      feature_engine_.onTradeUpdate(market_update, book);
+      END_MEASURE(Trading_FeatureEngine_onTradeUpdate, logger_);
+
+      // 通知策略实例处理交易事件
+      START_MEASURE(Trading_TradeEngine_algoOnTradeUpdate_);
+      strategies_.onTradeUpdate<AlgoT>(market_update, book);
+      END_MEASURE(Trading_TradeEngine_algoOnTradeUpdate_, logger_);
+    }
 
-    // 函数包装器，用于将订单簿更新、交易事件和客户端响应分发到交易算法
-    std::function<void(TickerId ticker_id, Price price, Side side, MarketOrderBook *book)> algoOnOrderBookUpdate_;
-    std::function<void(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book)> algoOnTradeUpdate_;
-    std::function<void(const Exchange::MEClientResponse *client_response)> algoOnOrderUpdate_;
+    // 处理客户端响应：通知订单所属的策略实例，由其更新持仓和风险管理器后通知交易算法
+    template<typename AlgoT = void>
+    auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
+      logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+                  client_response);
+
+      // 通知策略实例处理客户端响应
+      START_MEASURE(Trading_TradeEngine_algoOnOrderUpdate_);
+      strategies_.onOrderUpdate<AlgoT>(client_response);
+      END_MEASURE(Trading_TradeEngine_algoOnOrderUpdate_, logger_);
+    }
 
     // 初始化最后事件时间
     auto initLastEventTime() {
-      last_event_time_ = Common::getCurrentNanos();
+      last_event_time_ = Common::getCurrentTscNanos();
     }
 
     // 计算静默时间（自最后一个事件以来的秒数）
     auto silentSeconds() {
-      return (Common::getCurrentNanos() - last_event_time_) / NANOS_TO_SECS;
+      return (Common::getCurrentTscNanos() - last_event_time_) / NANOS_TO_SECS;
     }
 
     // 获取客户端ID
@@ -98,7 +180,34 @@ namespace Trading {
     TradeEngine &operator=(const TradeEngine &) = delete;
     TradeEngine &operator=(const TradeEngine &&) = delete;
 
+    // 获取第 index 个策略实例
+    auto strategy(size_t index) noexcept {
+      return strategies_.strategies().at(index);
+    }
+
+    auto numStrategies() const noexcept {
+      return strategies_.strategies().size();
+    }
+
   private:
+    // 将订单簿的回调以 AlgoT 转发到交易引擎
+    template<typename AlgoT>
+    struct AlgoListener {
+      TradeEngine *trade_engine_ = nullptr;
+
+      auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept {
+        trade_engine_->onOrderBookUpdate<AlgoT>(ticker_id, price, side, book);
+      }
+
+      auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept {
+        trade_engine_->onTradeUpdate<AlgoT>(market_update, book);
+      }
+    };
+
+    // 交易引擎线程的主循环，AlgoT 在 run() 中根据策略实例的算法类型选择一次
+    template<typename AlgoT>
+    auto runLoop() noexcept -> void;
+
     const ClientId client_id_;  // 本交易引擎的客户端ID
 
     // 从股票代码（TickerId）到MarketOrderBook的哈希映射容器
@@ -115,40 +224,12 @@ namespace Trading {
     Nanos last_event_time_ = 0;  // 最后一个事件的时间戳
     volatile bool run_ = false;   // 运行状态标志
 
-    std::string time_str_;
-    Logger logger_;
+    BinLogger logger_;
 
     // 交易算法的特征引擎
     FeatureEngine feature_engine_;
 
-    // 用于跟踪持仓、盈亏和成交量的持仓管理器
-    PositionKeeper position_keeper_;
-
-    // 为交易算法简化订单管理任务的订单管理器
-    OrderManager order_manager_;
-
-    // 用于跟踪和执行交易前风险检查的风险管理器
-    RiskManager risk_manager_;
-
-    // 做市或流动性获取算法实例（单个交易引擎实例中只创建其中一个）
-    MarketMaker *mm_algo_ = nullptr;
-    LiquidityTaker *taker_algo_ = nullptr;
-
-    // 用于初始化函数包装器的默认方法
-    auto defaultAlgoOnOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *) noexcept -> void {
-      logger_.log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
-                  Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
-                  Common::sideToString(side).c_str());
-    }
-
-    auto defaultAlgoOnTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *) noexcept -> void {
-      logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                  market_update->toString().c_str());
-    }
-
-    auto defaultAlgoOnOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-      logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                  client_response->toString().c_str());
-    }
+    // 本交易引擎运行的策略实例，持有其所有权
+    StrategyDispatcher strategies_;
   };
-}
\ No newline at end of file
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <csignal>
 
 #include "strategy/trade_engine.h"
@@ -7,59 +8,60 @@
 #include "common/logging.h"
 
 /// 主要组件
-Common::Logger *logger = nullptr;
+Common::BinLogger *logger = nullptr;
 Trading::TradeEngine *trade_engine = nullptr;
 Trading::MarketDataConsumer *market_data_consumer = nullptr;
 Trading::OrderGateway *order_gateway = nullptr;
 
-/// 程序入口：./trading_main 客户端ID 算法类型 [股票1参数(5个)] [股票2参数(5个)] ...
+/// 程序入口：./trading_main 客户端ID 算法类型 [股票1参数(5个)] [股票2参数(5个)] ... [算法类型 [股票1参数(5个)] ...] ... [FIXED|COMPACT]
+/// 每个算法类型开始一个新的策略实例，同一交易引擎中的策略实例共享订单簿和特征引擎
+/// 最后一个可选参数指定增量市场数据流的线路格式，需与交易所一致，默认为 FIXED
 int main(int argc, char **argv) {
   if(argc < 3) {
-    FATAL("使用方法: trading_main 客户端ID 算法类型 [股票1的成交量阈值 价格阈值 最大订单量 最大持仓 最大亏损] [股票2的...参数] ...");
+    FATAL("使用方法: trading_main 客户端ID 算法类型 [股票1的成交量阈值 价格阈值 最大订单量 最大持仓 最大亏损] [股票2的...参数] ... [算法类型 [股票1的...参数] ...] ... [FIXED|COMPACT]");
+  }
+
+  // 解析可选的增量市场数据线路格式
+  auto wire_format = Exchange::MDWireFormat::FIXED;
+  if (argc > 3 && (std::string(argv[argc - 1]) == "FIXED" || std::string(argv[argc - 1]) == "COMPACT")) {
+    wire_format = Exchange::stringToMDWireFormat(argv[argc - 1]);
+    --argc;
   }
 
   const Common::ClientId client_id = atoi(argv[1]);
   srand(client_id);  // 以客户端ID为随机数种子
 
-  const auto algo_type = stringToAlgoType(argv[2]);  // 转换算法类型字符串为枚举值
+  logger = new Common::BinLogger("trading_main_" + std::to_string(client_id) + ".log");  // 创建日志器
 
-  logger = new Common::Logger("trading_main_" + std::to_string(client_id) + ".log");  // 创建日志器
+  // 每60秒及收到SIGUSR1时将各测量标签的延迟分位数追加写入文件
+  const auto latency_file = "trading_main_" + std::to_string(client_id) + "_latency.txt";
+  Common::startLatencyHistogramDumper(latency_file, 60);
 
   const int sleep_time = 20 * 1000;  // 操作间隔时间（微秒）
 
   // 无锁队列，用于订单网关与交易引擎、市场数据消费者与交易引擎之间的通信
-  Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
-  Exchange::ClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
-  Exchange::MEMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
-
-  std::string time_str;
-
-  TradeEngineCfgHashMap ticker_cfg;  // 股票配置哈希映射
-
-  // 从命令行参数解析并初始化股票配置
-  // 参数格式：[股票1的成交量阈值 价格阈值 最大订单量 最大持仓 最大亏损] [股票2的...参数] ...
-  size_t next_ticker_id = 0;
-  for (int i = 3; i < argc; i += 5, ++next_ticker_id) {
-    ticker_cfg.at(next_ticker_id) = {
-      static_cast<Qty>(std::atoi(argv[i])),          // 成交量阈值
-      std::atof(argv[i + 1]),                        // 价格阈值
-      {
-        static_cast<Qty>(std::atoi(argv[i + 2])),    // 最大订单量
-        static_cast<Qty>(std::atoi(argv[i + 3])),    // 最大持仓
-        std::atof(argv[i + 4])                       // 最大亏损
-      }
-    };
+  // 队列的存储绑定到交易引擎线程所在核心的NUMA节点，交易引擎是每个队列的一端
+  Exchange::ClientRequestLFQueue *client_requests = nullptr;
+  Exchange::ClientResponseLFQueue *client_responses = nullptr;
+  Exchange::MEMarketUpdateLFQueue *market_updates = nullptr;
+  {
+    Common::HugePageNumaScope numa_scope(Common::numaNodeOfCore(Common::TE_CORE_ID));
+    client_requests = new Exchange::ClientRequestLFQueue(ME_MAX_CLIENT_UPDATES);
+    client_responses = new Exchange::ClientResponseLFQueue(ME_MAX_CLIENT_UPDATES);
+    market_updates = new Exchange::MEMarketUpdateLFQueue(ME_MAX_MARKET_UPDATES);
   }
 
+  // 从命令行参数解析并初始化每个策略实例的算法类型和股票配置
+  const auto strategy_cfgs = Trading::parseStrategyCfgs(2, argc, argv);
+
   // 启动交易引擎
-  logger->log("%:% %() % 启动交易引擎...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+  logger->log("%:% %() % 启动交易引擎...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
   trade_engine = new Trading::TradeEngine(
     client_id, 
-    algo_type,
-    ticker_cfg,
-    &client_requests,
-    &client_responses,
-    &market_updates
+    strategy_cfgs,
+    client_requests,
+    client_responses,
+    market_updates
   );
   trade_engine->start();
 
@@ -69,11 +71,11 @@ int main(int argc, char **argv) {
   const int order_gw_port = 12345;
 
   // 启动订单网关
-  logger->log("%:% %() % 启动订单网关...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+  logger->log("%:% %() % 启动订单网关...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime());
   order_gateway = new Trading::OrderGateway(
     client_id, 
-    &client_requests, 
-    &client_responses, 
+    client_requests, 
+    client_responses, 
     order_gw_ip, 
     order_gw_iface, 
     order_gw_port
@@ -88,25 +90,30 @@ int main(int argc, char **argv) {
   const int incremental_port = 20001;
 
   // 启动市场数据消费者
-  logger->log("%:% %() % 启动市场数据消费者...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+  logger->log("%:% %() % 启动市场数据消费者 增量格式:%...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(),
+              Exchange::mdWireFormatToString(wire_format));
   market_data_consumer = new Trading::MarketDataConsumer(
     client_id, 
-    &market_updates, 
+    market_updates, 
     mkt_data_iface, 
     snapshot_ip, 
     snapshot_port, 
     incremental_ip, 
-    incremental_port
+    incremental_port,
+    wire_format
   );
   market_data_consumer->start();
 
+  logger->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentLogTime(), Common::hugePageSummary().c_str());
+
   // 初始化等待时间（10秒）
   usleep(10 * 1000 * 1000);
 
   trade_engine->initLastEventTime();  // 初始化最后事件时间
 
   // 随机交易算法实现：生成随机订单并随机取消部分订单
-  if (algo_type == AlgoType::RANDOM) {
+  if (std::any_of(strategy_cfgs.begin(), strategy_cfgs.end(),
+                  [](const auto &strategy_cfg) { return strategy_cfg.algo_type_ == AlgoType::RANDOM; })) {
     Common::OrderId order_id = client_id * 1000;  // 基础订单ID
     std::vector<Exchange::MEClientRequest> client_requests_vec;  // 存储已发送的订单请求
     std::array<Price, ME_MAX_TICKERS> ticker_base_price;  // 各股票基准价格
@@ -146,8 +153,8 @@ int main(int argc, char **argv) {
 
       // 如果60秒内无事件，提前停止
       if (trade_engine->silentSeconds() >= 60) {
-        logger->log("%:% %() % 因60秒无活动，提前停止...\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str), trade_engine->silentSeconds());
+        logger->log("%:% %() % 已静默%秒，因60秒无活动提前停止...\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getCurrentLogTime(), trade_engine->silentSeconds());
 
         break;
       }
@@ -157,7 +164,7 @@ int main(int argc, char **argv) {
   // 等待60秒无活动后停止
   while (trade_engine->silentSeconds() < 60) {
     logger->log("%:% %() % 等待无活动状态，已静默%秒...\n", __FILE__, __LINE__, __FUNCTION__,
-                Common::getCurrentTimeStr(&time_str), trade_engine->silentSeconds());
+                Common::getCurrentLogTime(), trade_engine->silentSeconds());
 
     using namespace std::literals::chrono_literals;
     std::this_thread::sleep_for(30s);  // 每30秒检查一次
@@ -183,5 +190,7 @@ int main(int argc, char **argv) {
 
   std::this_thread::sleep_for(10s);  // 等待资源释放完成
 
+  Common::dumpLatencyHistograms(latency_file);  // 退出前写出最终的延迟直方图
+
   exit(EXIT_SUCCESS);
 }
\ No newline at end of file